@@ -0,0 +1,207 @@
+// Copyright (c) 2026 SoapySDR contributors
+// SPDX-License-Identifier: BSL-1.0
+
+#include "SoapyRateAlloc.hpp"
+#include <atomic>
+#include <mutex>
+#include <new>
+#include <algorithm>
+#include <cstdlib>
+
+/***********************************************************************
+ * Per thread counters behind the replaced operator new
+ **********************************************************************/
+static std::atomic<bool> countAllocations(false);
+
+struct ThreadAllocations
+{
+    uint64_t allocations;
+    uint64_t bytes;
+};
+
+//constant initialized, so reaching it never allocates or runs a constructor
+static thread_local ThreadAllocations threadAllocations = {0, 0};
+
+static inline void countAllocation(const std::size_t size)
+{
+    if (not countAllocations.load(std::memory_order_relaxed)) return;
+    threadAllocations.allocations++;
+    threadAllocations.bytes += size;
+}
+
+static void *allocate(std::size_t size)
+{
+    countAllocation(size);
+    if (size == 0) size = 1;
+    while (true)
+    {
+        void *p = std::malloc(size);
+        if (p != nullptr) return p;
+        auto handler = std::get_new_handler();
+        if (handler == nullptr) throw std::bad_alloc();
+        handler();
+    }
+}
+
+static void *allocateAligned(std::size_t size, const std::align_val_t align)
+{
+    countAllocation(size);
+    const std::size_t alignment = std::max(sizeof(void *), std::size_t(align));
+    if (size == 0) size = 1;
+    while (true)
+    {
+        void *p(nullptr);
+        if (posix_memalign(&p, alignment, size) == 0) return p;
+        auto handler = std::get_new_handler();
+        if (handler == nullptr) throw std::bad_alloc();
+        handler();
+    }
+}
+
+void *operator new(std::size_t size)
+{
+    return allocate(size);
+}
+
+void *operator new[](std::size_t size)
+{
+    return allocate(size);
+}
+
+void *operator new(std::size_t size, const std::nothrow_t &) noexcept
+{
+    try
+    {
+        return allocate(size);
+    }
+    catch (...)
+    {
+        return nullptr;
+    }
+}
+
+void *operator new[](std::size_t size, const std::nothrow_t &) noexcept
+{
+    return operator new(size, std::nothrow);
+}
+
+void *operator new(std::size_t size, std::align_val_t align)
+{
+    return allocateAligned(size, align);
+}
+
+void *operator new[](std::size_t size, std::align_val_t align)
+{
+    return allocateAligned(size, align);
+}
+
+void operator delete(void *p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete[](void *p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void *p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+void operator delete[](void *p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void *p, std::align_val_t) noexcept
+{
+    std::free(p);
+}
+
+void operator delete[](void *p, std::align_val_t) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void *p, std::size_t, std::align_val_t) noexcept
+{
+    std::free(p);
+}
+
+void operator delete[](void *p, std::size_t, std::align_val_t) noexcept
+{
+    std::free(p);
+}
+
+/***********************************************************************
+ * Steady state scopes and their results
+ **********************************************************************/
+static std::mutex loopsMutex;
+static std::vector<LoopAllocations> loops;
+
+void enableAllocationCheck(void)
+{
+    countAllocations = true;
+}
+
+bool allocationCheckEnabled(void)
+{
+    return countAllocations.load(std::memory_order_relaxed);
+}
+
+SteadyStateAllocations::SteadyStateAllocations(const std::string &loop):
+    _loop(loop),
+    _steady(false),
+    _ended(false),
+    _startAllocations(0),
+    _startBytes(0),
+    _allocations(0),
+    _bytes(0)
+{
+    return;
+}
+
+void SteadyStateAllocations::begin(void)
+{
+    if (_steady or not allocationCheckEnabled()) return;
+    _steady = true;
+    _startAllocations = threadAllocations.allocations;
+    _startBytes = threadAllocations.bytes;
+}
+
+SteadyStateAllocations::~SteadyStateAllocations(void)
+{
+    this->end();
+}
+
+void SteadyStateAllocations::end(void)
+{
+    if (_ended or not allocationCheckEnabled()) return;
+    this->pause();
+    _ended = true;
+    std::lock_guard<std::mutex> lock(loopsMutex);
+    loops.push_back(LoopAllocations{_loop, _steady, _allocations, _bytes});
+}
+
+void SteadyStateAllocations::pause(void)
+{
+    if (not _steady or _ended) return;
+    _allocations += threadAllocations.allocations - _startAllocations;
+    _bytes += threadAllocations.bytes - _startBytes;
+    _startAllocations = threadAllocations.allocations;
+    _startBytes = threadAllocations.bytes;
+}
+
+void SteadyStateAllocations::resume(void)
+{
+    _startAllocations = threadAllocations.allocations;
+    _startBytes = threadAllocations.bytes;
+}
+
+std::vector<LoopAllocations> steadyStateAllocations(void)
+{
+    std::lock_guard<std::mutex> lock(loopsMutex);
+    return loops;
+}
@@ -0,0 +1,72 @@
+// Copyright (c) 2026 SoapySDR contributors
+// SPDX-License-Identifier: BSL-1.0
+
+#pragma once
+#include <string>
+#include <vector>
+#include <cstdint>
+
+/*!
+ * Count heap allocations on every thread from now on.
+ * The global operator new is replaced in all builds, without this call it
+ * only pays for one relaxed load per allocation.
+ */
+void enableAllocationCheck(void);
+
+bool allocationCheckEnabled(void);
+
+/*!
+ * Allocations made by one steady state loop.
+ */
+struct LoopAllocations
+{
+    std::string loop; //e.g. "Dev 0 RX stream"
+    bool steady; //the loop reached its steady state
+    uint64_t allocations;
+    uint64_t bytes;
+};
+
+/*!
+ * Measures the heap allocations of a loop once it is in its steady state.
+ *
+ * Create it on the loop's thread before the loop, call begin() when every
+ * lazy setup is behind it. The count from begin() until end(), or the
+ * destructor, is recorded under the loop's name. With the check disabled every call is a
+ * no-op. The counter is per thread, a loop which shares its thread, like
+ * a task of the coroutine engine, pauses the count while it is suspended.
+ */
+class SteadyStateAllocations
+{
+public:
+    //! \param loop the name the count is recorded under
+    explicit SteadyStateAllocations(const std::string &loop);
+
+    ~SteadyStateAllocations(void);
+
+    SteadyStateAllocations(const SteadyStateAllocations &) = delete;
+    SteadyStateAllocations &operator=(const SteadyStateAllocations &) = delete;
+
+    //! The loop is in its steady state, only the first call counts
+    void begin(void);
+
+    //! The loop is over, record its count, only the first call counts
+    void end(void);
+
+    //! Leave out what the thread allocates until resume(), around a suspension
+    void pause(void);
+    void resume(void);
+
+private:
+    const std::string _loop;
+    bool _steady;
+    bool _ended;
+    uint64_t _startAllocations;
+    uint64_t _startBytes;
+    uint64_t _allocations; //counted in earlier stretches between pauses
+    uint64_t _bytes;
+};
+
+/*!
+ * Every loop recorded so far, in the order they finished.
+ */
+std::vector<LoopAllocations> steadyStateAllocations(void);
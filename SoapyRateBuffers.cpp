@@ -0,0 +1,201 @@
+// Copyright (c) 2026 SoapySDR contributors
+// SPDX-License-Identifier: BSL-1.0
+
+#include "SoapyRateBuffers.hpp"
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <mutex>
+#include <cstring>
+#include <cerrno>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <linux/mempolicy.h>
+#include <unistd.h>
+
+static const size_t HUGE_PAGE_SIZE = 2*1024*1024;
+
+static size_t roundUp(const size_t value, const size_t multiple)
+{
+    return ((value + multiple - 1)/multiple)*multiple;
+}
+
+BufferArena::BufferArena(
+    const size_t numSlices,
+    const size_t sliceBytes,
+    const bool hugePages,
+    const int numaNode,
+    const bool pageAlignSlices):
+    _mem(MAP_FAILED),
+    _size(0),
+    _stride(roundUp(sliceBytes == 0?1:sliceBytes, SLICE_ALIGN)),
+    _numSlices(numSlices == 0?1:numSlices),
+    _hugePages(false)
+{
+    const size_t pageSize = size_t(sysconf(_SC_PAGESIZE));
+    if (pageAlignSlices) _stride = roundUp(_stride, pageSize);
+    else if (_numSlices > 1 and _stride%pageSize == 0) _stride += SLICE_ALIGN;
+    const size_t bytes = _stride*_numSlices;
+
+    #ifdef MAP_HUGETLB
+    if (hugePages)
+    {
+        _size = roundUp(bytes, HUGE_PAGE_SIZE);
+        _mem = mmap(nullptr, _size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        _hugePages = (_mem != MAP_FAILED);
+    }
+    #endif
+
+    if (_mem == MAP_FAILED)
+    {
+        _size = roundUp(bytes, pageSize);
+        _mem = mmap(nullptr, _size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (_mem == MAP_FAILED) throw std::runtime_error("BufferArena mmap failed: " + std::string(strerror(errno)));
+        #ifdef MADV_HUGEPAGE
+        if (hugePages) madvise(_mem, _size, MADV_HUGEPAGE);
+        #endif
+    }
+
+    //the policy has to be in place before the pages are first touched
+    if (numaNode >= 0) _numaError = bindNumaNode(_mem, _size, numaNode);
+
+    //populate now so that the stream loop never takes a first-touch fault
+    std::memset(_mem, 0, _size);
+}
+
+BufferArena::~BufferArena(void)
+{
+    munmap(_mem, _size);
+}
+
+/***********************************************************************
+ * Buffer pool
+ **********************************************************************/
+struct BufferPool::Shared
+{
+    struct Idle
+    {
+        std::unique_ptr<BufferArena> arena;
+        bool pageAligned;
+    };
+
+    bool hugePages;
+    int numaNode;
+    std::mutex mutex;
+    std::vector<Idle> idle;
+    size_t acquired = 0;
+    size_t reused = 0;
+    size_t mappedBytes = 0;
+    std::string numaError;
+};
+
+BufferPool::BufferPool(const bool hugePages, const int numaNode):
+    _shared(new Shared())
+{
+    _shared->hugePages = hugePages;
+    _shared->numaNode = numaNode;
+}
+
+BufferPool::~BufferPool(void)
+{
+    return;
+}
+
+BufferPool::Lease BufferPool::acquire(const size_t numSlices, const size_t sliceBytes, const bool pageAlignSlices)
+{
+    auto shared = _shared;
+    std::lock_guard<std::mutex> lock(shared->mutex);
+    shared->acquired++;
+
+    //an idle arena fits with the same slice count and alignment and a stride that wastes at most half
+    std::unique_ptr<BufferArena> arena;
+    const size_t slices = (numSlices == 0)?1:numSlices;
+    for (auto it = shared->idle.begin(); it != shared->idle.end(); ++it)
+    {
+        const size_t stride = it->arena->stride();
+        if (it->pageAligned != pageAlignSlices or it->arena->numSlices() != slices) continue;
+        if (stride < sliceBytes or stride > 2*sliceBytes + size_t(sysconf(_SC_PAGESIZE))) continue;
+        arena = std::move(it->arena);
+        shared->idle.erase(it);
+        shared->reused++;
+        break;
+    }
+    if (not arena)
+    {
+        arena.reset(new BufferArena(slices, sliceBytes, shared->hugePages, shared->numaNode, pageAlignSlices));
+        shared->mappedBytes += arena->size();
+        if (shared->numaError.empty()) shared->numaError = arena->numaError();
+    }
+
+    return Lease(arena.release(), [shared, pageAlignSlices](BufferArena *released)
+    {
+        std::lock_guard<std::mutex> idleLock(shared->mutex);
+        shared->idle.push_back(Shared::Idle{std::unique_ptr<BufferArena>(released), pageAlignSlices});
+    });
+}
+
+bool BufferPool::hugePages(void) const
+{
+    return _shared->hugePages;
+}
+
+int BufferPool::numaNode(void) const
+{
+    return _shared->numaNode;
+}
+
+size_t BufferPool::acquired(void) const
+{
+    std::lock_guard<std::mutex> lock(_shared->mutex);
+    return _shared->acquired;
+}
+
+size_t BufferPool::reused(void) const
+{
+    std::lock_guard<std::mutex> lock(_shared->mutex);
+    return _shared->reused;
+}
+
+size_t BufferPool::mappedBytes(void) const
+{
+    std::lock_guard<std::mutex> lock(_shared->mutex);
+    return _shared->mappedBytes;
+}
+
+std::string BufferPool::numaError(void) const
+{
+    std::lock_guard<std::mutex> lock(_shared->mutex);
+    return _shared->numaError;
+}
+
+std::string bindNumaNode(void *mem, const size_t size, const int node)
+{
+    const size_t bitsPerWord = 8*sizeof(unsigned long);
+    std::vector<unsigned long> nodeMask(node/bitsPerWord + 1, 0);
+    nodeMask[node/bitsPerWord] |= 1UL << (node%bitsPerWord);
+    //maxnode counts one past the highest bit, the kernel would drop the last one otherwise
+    const long ret = syscall(SYS_mbind, mem, size, MPOL_BIND, nodeMask.data(), nodeMask.size()*bitsPerWord + 1, MPOL_MF_MOVE);
+    if (ret != 0) return "mbind node " + std::to_string(node) + " failed: " + strerror(errno);
+    return "";
+}
+
+BlockRing::BlockRing(
+    const size_t numSlots,
+    const size_t numChans,
+    const size_t slotBytes,
+    const size_t numConsumers,
+    BufferPool &pool,
+    const bool pageAlignSlices):
+    _numSlots(numSlots == 0?1:numSlots),
+    _numChans(numChans),
+    _numConsumers(numConsumers == 0?1:numConsumers),
+    _arena(pool.acquire(_numSlots*_numChans, slotBytes, pageAlignSlices)),
+    _ptrs(_numSlots*_numChans),
+    _info(_numSlots),
+    _cachedTail(0),
+    _highWater(0),
+    _head(0),
+    _tails(new Cursor[_numConsumers])
+{
+    for (size_t i = 0; i < _ptrs.size(); i++) _ptrs[i] = _arena->slice(i);
+}
@@ -0,0 +1,285 @@
+// Copyright (c) 2026 SoapySDR contributors
+// SPDX-License-Identifier: BSL-1.0
+
+#pragma once
+#include <string>
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+/*!
+ * Bind a memory range to one NUMA node with MPOL_BIND.
+ * \return an error message, empty on success
+ */
+std::string bindNumaNode(void *mem, const size_t size, const int node);
+
+/*!
+ * One contiguous, page aligned mapping carved into equally sized slices.
+ *
+ * Each slice starts on a cache line boundary and the stride is padded so
+ * that slices never share a line. Strides which are a multiple of the page
+ * size get one extra line so that channel buffers used in lock-step do not
+ * alias in the same cache sets. Pages are populated up front, after any
+ * NUMA policy is applied, so the stream loop never takes a first-touch fault.
+ */
+class BufferArena
+{
+public:
+    static const size_t SLICE_ALIGN = 64;
+
+    /*!
+     * \param numSlices number of equally sized slices
+     * \param sliceBytes usable bytes per slice
+     * \param hugePages try MAP_HUGETLB, then fall back to transparent huge pages
+     * \param numaNode bind the pages to this node, -1 for the default policy
+     * \param pageAlignSlices start every slice on a page boundary, as O_DIRECT requires
+     * \throws std::runtime_error when the mapping fails
+     */
+    BufferArena(
+        const size_t numSlices,
+        const size_t sliceBytes,
+        const bool hugePages = false,
+        const int numaNode = -1,
+        const bool pageAlignSlices = false);
+
+    ~BufferArena(void);
+
+    BufferArena(const BufferArena &) = delete;
+    BufferArena &operator=(const BufferArena &) = delete;
+
+    //! Pointer to the start of a slice
+    void *slice(const size_t index) const
+    {
+        return static_cast<char *>(_mem) + index*_stride;
+    }
+
+    size_t numSlices(void) const
+    {
+        return _numSlices;
+    }
+
+    //! Distance in bytes between consecutive slices
+    size_t stride(void) const
+    {
+        return _stride;
+    }
+
+    //! Total mapped size in bytes
+    size_t size(void) const
+    {
+        return _size;
+    }
+
+    //! True when the mapping is backed by explicit huge pages
+    bool hugePages(void) const
+    {
+        return _hugePages;
+    }
+
+    //! Why the NUMA binding failed, empty when it succeeded or was not requested
+    const std::string &numaError(void) const
+    {
+        return _numaError;
+    }
+
+private:
+    void *_mem;
+    size_t _size;
+    size_t _stride;
+    size_t _numSlices;
+    bool _hugePages;
+    std::string _numaError;
+};
+
+/*!
+ * Reusable BufferArena mappings which share one huge page and NUMA policy.
+ *
+ * The streams and pipeline stages of a test run take their buffers from one
+ * pool. Dropping a lease hands its arena back, and a later request for the
+ * same layout gets it again already populated and bound, so repeated trials
+ * and restarted stages never map, fault or bind pages again. Leases may
+ * outlive the pool, the idle arenas are unmapped once the last one is gone.
+ */
+class BufferPool
+{
+public:
+    typedef std::shared_ptr<BufferArena> Lease;
+
+    //! \param hugePages and \param numaNode apply to every arena, as for BufferArena
+    BufferPool(const bool hugePages = false, const int numaNode = -1);
+
+    ~BufferPool(void);
+
+    BufferPool(const BufferPool &) = delete;
+    BufferPool &operator=(const BufferPool &) = delete;
+
+    /*!
+     * An arena of numSlices slices of at least sliceBytes, reused when an idle one fits.
+     * \throws std::runtime_error when a new mapping fails
+     */
+    Lease acquire(const size_t numSlices, const size_t sliceBytes, const bool pageAlignSlices = false);
+
+    bool hugePages(void) const;
+
+    int numaNode(void) const;
+
+    //! Leases handed out so far and how many of them reused an idle arena
+    size_t acquired(void) const;
+    size_t reused(void) const;
+
+    //! Bytes mapped by the pool's arenas, leased or idle, arenas stay mapped until the pool is gone
+    size_t mappedBytes(void) const;
+
+    //! The first NUMA binding error of any arena, empty when every binding held
+    std::string numaError(void) const;
+
+private:
+    struct Shared;
+    std::shared_ptr<Shared> _shared;
+};
+
+/*!
+ * Lock-free ring of multi-channel sample blocks between pipeline stages.
+ *
+ * There is a single producer, the stream loop, and a fixed number of
+ * consumers which each see every block. A slot is reused once the slowest
+ * consumer has released it. The cursors live on separate cache lines and
+ * the producer refreshes its copy of the slowest cursor once per commit.
+ */
+class BlockRing
+{
+public:
+    struct BlockInfo
+    {
+        size_t numElems;
+        long long timeNs;
+        int flags;
+        uint64_t seq;
+        int64_t hostNs; //monotonic time of the commit
+    };
+
+    //! The slots are one arena leased from the pool
+    BlockRing(
+        const size_t numSlots,
+        const size_t numChans,
+        const size_t slotBytes,
+        const size_t numConsumers,
+        BufferPool &pool,
+        const bool pageAlignSlices = false);
+
+    size_t numSlots(void) const
+    {
+        return _numSlots;
+    }
+
+    size_t numChans(void) const
+    {
+        return _numChans;
+    }
+
+    const BufferArena &arena(void) const
+    {
+        return *_arena;
+    }
+
+    //! Producer: channel pointers of the next free slot, nullptr when full
+    inline void * const *writeSlot(void)
+    {
+        const uint64_t head = _head.load(std::memory_order_relaxed);
+        if (head - _cachedTail >= _numSlots)
+        {
+            _cachedTail = this->minTail();
+            if (head - _cachedTail >= _numSlots) return nullptr;
+        }
+        return _ptrs.data() + (head%_numSlots)*_numChans;
+    }
+
+    //! Producer: publish the slot returned by writeSlot()
+    inline void commit(const size_t numElems, const long long timeNs, const int flags, const int64_t hostNs = 0)
+    {
+        const uint64_t head = _head.load(std::memory_order_relaxed);
+        _info[head%_numSlots] = BlockInfo{numElems, timeNs, flags, head, hostNs};
+        _head.store(head + 1, std::memory_order_release);
+        _cachedTail = this->minTail();
+        const size_t used = size_t(head + 1 - _cachedTail);
+        if (used > _highWater.load(std::memory_order_relaxed)) _highWater.store(used, std::memory_order_relaxed);
+    }
+
+    //! Consumer: channel pointers of the oldest unread slot, nullptr when empty
+    inline void * const *readSlot(const size_t consumer, BlockInfo &info) const
+    {
+        const uint64_t tail = _tails[consumer].pos.load(std::memory_order_relaxed);
+        if (tail == _head.load(std::memory_order_acquire)) return nullptr;
+        info = _info[tail%_numSlots];
+        return _ptrs.data() + (tail%_numSlots)*_numChans;
+    }
+
+    //! Consumer: hand the slot returned by readSlot() back to the producer
+    inline void release(const size_t consumer)
+    {
+        const uint64_t tail = _tails[consumer].pos.load(std::memory_order_relaxed);
+        _tails[consumer].pos.store(tail + 1, std::memory_order_release);
+    }
+
+    //! Shared consumer: number of blocks ever committed, blocks are numbered from 0
+    inline uint64_t committed(void) const
+    {
+        return _head.load(std::memory_order_acquire);
+    }
+
+    //! Shared consumer: channel pointers and info of a committed block which is not released
+    inline void * const *slotAt(const uint64_t seq, BlockInfo &info) const
+    {
+        info = _info[seq%_numSlots];
+        return _ptrs.data() + (seq%_numSlots)*_numChans;
+    }
+
+    //! Shared consumer: release every block before seq, calls must be serialized
+    inline void releaseTo(const size_t consumer, const uint64_t seq)
+    {
+        _tails[consumer].pos.store(seq, std::memory_order_release);
+    }
+
+    //! Consumer: number of committed slots it has not released yet
+    inline size_t pending(const size_t consumer) const
+    {
+        const uint64_t tail = _tails[consumer].pos.load(std::memory_order_relaxed);
+        return size_t(_head.load(std::memory_order_acquire) - tail);
+    }
+
+    //! Most slots that were ever in use at once
+    size_t highWater(void) const
+    {
+        return _highWater.load(std::memory_order_relaxed);
+    }
+
+private:
+    uint64_t minTail(void) const
+    {
+        uint64_t result = _tails[0].pos.load(std::memory_order_acquire);
+        for (size_t i = 1; i < _numConsumers; i++)
+        {
+            const uint64_t tail = _tails[i].pos.load(std::memory_order_acquire);
+            if (tail < result) result = tail;
+        }
+        return result;
+    }
+
+    struct alignas(64) Cursor
+    {
+        std::atomic<uint64_t> pos{0};
+    };
+
+    const size_t _numSlots;
+    const size_t _numChans;
+    const size_t _numConsumers;
+    BufferPool::Lease _arena;
+    std::vector<void *> _ptrs;
+    std::vector<BlockInfo> _info;
+    uint64_t _cachedTail;
+    std::atomic<size_t> _highWater;
+    alignas(64) std::atomic<uint64_t> _head;
+    std::unique_ptr<Cursor[]> _tails;
+};
@@ -0,0 +1,216 @@
+// Copyright (c) 2026 SoapySDR contributors
+// SPDX-License-Identifier: BSL-1.0
+
+#include "SoapyRateCapture.hpp"
+#include "SoapyRateAlloc.hpp"
+#include "SoapyRateProfile.hpp"
+#include <stdexcept>
+#include <fstream>
+#include <chrono>
+#include <vector>
+#include <cstring>
+#include <algorithm>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/uio.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+static const uint64_t PREALLOC_CHUNK = 256*1024*1024;
+static const size_t DIRECT_IO_ALIGN = 4096;
+static const size_t REPLAY_READAHEAD = 64*1024*1024;
+
+void writeSampleFileInfo(const std::string &path, const SoapySDR::Kwargs &info)
+{
+    std::ofstream meta(path + ".meta");
+    meta << SoapySDR::KwargsToString(info) << std::endl;
+}
+
+SoapySDR::Kwargs readSampleFileInfo(const std::string &path)
+{
+    std::ifstream meta(path + ".meta");
+    std::string markup;
+    if (not std::getline(meta, markup)) return SoapySDR::Kwargs();
+    return SoapySDR::KwargsFromString(markup);
+}
+
+CaptureWriter::CaptureWriter(const std::string &path, BlockRing &ring, const size_t consumer, const size_t elemSize):
+    _ring(ring),
+    _consumer(consumer),
+    _elemSize(elemSize),
+    _fd(-1),
+    _openedDirect(false),
+    _directIO(ring.arena().stride()%DIRECT_IO_ALIGN == 0),
+    _allocated(0),
+    _done(false),
+    _bytesWritten(0),
+    _writeNs(0)
+{
+    int flags = O_WRONLY | O_CREAT | O_TRUNC;
+    #ifdef O_DIRECT
+    if (_directIO) _fd = open(path.c_str(), flags | O_DIRECT, 0644);
+    #endif
+    if (_fd < 0)
+    {
+        _directIO = false;
+        _fd = open(path.c_str(), flags, 0644);
+    }
+    if (_fd < 0) throw std::runtime_error("capture open(" + path + ") failed: " + strerror(errno));
+    _openedDirect = _directIO;
+
+    _thread = std::thread(&CaptureWriter::writerLoop, this);
+}
+
+CaptureWriter::~CaptureWriter(void)
+{
+    this->stop();
+    if (_fd >= 0)
+    {
+        //release the preallocated tail beyond what was written
+        if (ftruncate(_fd, off_t(this->bytesWritten())) != 0) {}
+        close(_fd);
+    }
+}
+
+void CaptureWriter::stop(void)
+{
+    _done = true;
+    if (_thread.joinable()) _thread.join();
+}
+
+void CaptureWriter::writerLoop(void)
+{
+    std::vector<struct iovec> iov(_ring.numChans());
+    uint64_t offset(0);
+    SteadyStateAllocations allocs("capture");
+    ThreadProfile prof("capture");
+
+    while (true)
+    {
+        BlockRing::BlockInfo info;
+        void * const *slot = _ring.readSlot(_consumer, info);
+        if (slot == nullptr)
+        {
+            if (_done) break;
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+            prof.lap(PROFILE_IDLE);
+            continue;
+        }
+        prof.lap(PROFILE_HANDOFF);
+
+        const size_t chanBytes = info.numElems*_elemSize;
+        const size_t blockBytes = chanBytes*iov.size();
+        if (_directIO and chanBytes%DIRECT_IO_ALIGN != 0)
+        {
+            //a short block cannot go through O_DIRECT, finish the file buffered
+            fcntl(_fd, F_SETFL, fcntl(_fd, F_GETFL) & ~O_DIRECT);
+            _directIO = false;
+        }
+
+        //keep the file system allocation ahead of the write position
+        if (offset + blockBytes > _allocated)
+        {
+            #ifdef FALLOC_FL_KEEP_SIZE
+            if (fallocate(_fd, FALLOC_FL_KEEP_SIZE, off_t(_allocated), off_t(PREALLOC_CHUNK)) != 0) {}
+            #endif
+            _allocated += PREALLOC_CHUNK;
+        }
+
+        for (size_t i = 0; i < iov.size(); i++)
+        {
+            iov[i].iov_base = slot[i];
+            iov[i].iov_len = chanBytes;
+        }
+        const auto t0 = std::chrono::steady_clock::now();
+        const ssize_t ret = pwritev(_fd, iov.data(), int(iov.size()), off_t(offset));
+        const auto t1 = std::chrono::steady_clock::now();
+        prof.lap(PROFILE_PROCESSING);
+        _ring.release(_consumer);
+        prof.lap(PROFILE_HANDOFF);
+
+        if (ret != ssize_t(blockBytes))
+        {
+            _error = (ret < 0)?strerror(errno):"short write";
+            break;
+        }
+        offset += blockBytes;
+        _bytesWritten.store(offset, std::memory_order_relaxed);
+        allocs.begin();
+        _writeNs.fetch_add(uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count()), std::memory_order_relaxed);
+    }
+
+    allocs.end();
+    prof.end();
+
+    //keep draining after an error so the producer is never wedged
+    BlockRing::BlockInfo info;
+    while (not _error.empty() and not _done)
+    {
+        if (_ring.readSlot(_consumer, info) != nullptr) _ring.release(_consumer);
+        else std::this_thread::sleep_for(std::chrono::microseconds(100));
+    }
+}
+
+ReplaySource::ReplaySource(const std::string &path, const size_t elemSize, const size_t numChans, const size_t defaultBlockElems):
+    _mem(MAP_FAILED),
+    _size(0),
+    _elemSize(elemSize),
+    _fileChans(numChans),
+    _blockElems(defaultBlockElems),
+    _numBlocks(0),
+    _prefetchedTo(0)
+{
+    const auto info = readSampleFileInfo(path);
+    if (info.count("channels") != 0) _fileChans = std::stoul(info.at("channels"));
+    if (info.count("blockElems") != 0) _blockElems = std::stoul(info.at("blockElems"));
+    if (_fileChans != 1 and _fileChans != numChans)
+    {
+        throw std::runtime_error("replay " + path + " has " + std::to_string(_fileChans) + " channels, the stream has " + std::to_string(numChans));
+    }
+
+    const int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) throw std::runtime_error("replay open(" + path + ") failed: " + strerror(errno));
+    struct stat st;
+    if (fstat(fd, &st) == 0) _size = size_t(st.st_size);
+    if (_size != 0) _mem = mmap(nullptr, _size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (_mem == MAP_FAILED) throw std::runtime_error("replay mmap(" + path + ") failed: " + strerror(errno));
+
+    _numBlocks = (_blockElems == 0)?0:(_size/(_fileChans*_blockElems*_elemSize));
+    if (_numBlocks == 0) throw std::runtime_error("replay " + path + " is smaller than one block");
+
+    //the whole mapping is read front to back, start readahead at the beginning
+    madvise(_mem, _size, MADV_SEQUENTIAL);
+    this->prefetch(0);
+}
+
+ReplaySource::~ReplaySource(void)
+{
+    if (_mem != MAP_FAILED) munmap(_mem, _size);
+}
+
+void ReplaySource::prefetch(const size_t block)
+{
+    const size_t pageSize = size_t(sysconf(_SC_PAGESIZE));
+    const size_t pos = block*_fileChans*_blockElems*_elemSize;
+
+    //a wrap to the start of the file restarts the window
+    if (pos < _prefetchedTo and _prefetchedTo - pos > REPLAY_READAHEAD) _prefetchedTo = pos;
+    if (pos + REPLAY_READAHEAD/2 < _prefetchedTo) return;
+
+    const size_t begin = (std::max(pos, _prefetchedTo)/pageSize)*pageSize;
+    const size_t end = std::min(pos + REPLAY_READAHEAD, _size);
+    if (end > begin) madvise(static_cast<char *>(_mem) + begin, end - begin, MADV_WILLNEED);
+    _prefetchedTo = end;
+}
+
+double ReplaySource::residentFraction(void) const
+{
+    const size_t pageSize = size_t(sysconf(_SC_PAGESIZE));
+    std::vector<unsigned char> vec((_size + pageSize - 1)/pageSize);
+    if (mincore(_mem, _size, vec.data()) != 0) return 0.0;
+    size_t resident(0);
+    for (const auto v : vec) resident += (v & 1);
+    return double(resident)/vec.size();
+}
@@ -0,0 +1,156 @@
+// Copyright (c) 2026 SoapySDR contributors
+// SPDX-License-Identifier: BSL-1.0
+
+#pragma once
+#include "SoapyRateBuffers.hpp"
+#include <SoapySDR/Types.hpp>
+#include <string>
+#include <thread>
+#include <atomic>
+#include <cstdint>
+
+/*!
+ * Sample files are raw blocks, each block holds blockElems elements of
+ * channel 0, then channel 1 and so on. The layout parameters are kept in
+ * a "<file>.meta" sidecar written as a SoapySDR markup string.
+ */
+void writeSampleFileInfo(const std::string &path, const SoapySDR::Kwargs &info);
+
+//! Read the sidecar for a sample file, empty when there is none
+SoapySDR::Kwargs readSampleFileInfo(const std::string &path);
+
+/*!
+ * Writer stage which drains a BlockRing to disk on its own thread.
+ *
+ * The file is opened with O_DIRECT when every channel block is a whole
+ * number of pages, otherwise it falls back to buffered writes. Disk space
+ * is preallocated in large chunks ahead of the write position so the file
+ * system never allocates on the sustained write path.
+ */
+class CaptureWriter
+{
+public:
+    /*!
+     * \param path the output file, truncated if it exists
+     * \param ring the source ring, slots must be page aligned for O_DIRECT
+     * \param consumer this stage's consumer index in the ring
+     * \param elemSize bytes per element
+     * \throws std::runtime_error when the file cannot be opened
+     */
+    CaptureWriter(const std::string &path, BlockRing &ring, const size_t consumer, const size_t elemSize);
+
+    ~CaptureWriter(void);
+
+    //! Drain what is left in the ring, then stop the writer thread
+    void stop(void);
+
+    //! True while the file is written with O_DIRECT, a short block switches it to buffered
+    bool directIO(void) const
+    {
+        return _directIO.load(std::memory_order_relaxed);
+    }
+
+    //! True when the file was opened with O_DIRECT
+    bool openedDirect(void) const
+    {
+        return _openedDirect;
+    }
+
+    uint64_t bytesWritten(void) const
+    {
+        return _bytesWritten.load(std::memory_order_relaxed);
+    }
+
+    //! Seconds spent in write calls
+    double writeTime(void) const
+    {
+        return _writeNs.load(std::memory_order_relaxed)/1e9;
+    }
+
+    //! The first write error, empty when there was none
+    const std::string &error(void) const
+    {
+        return _error;
+    }
+
+private:
+    void writerLoop(void);
+
+    BlockRing &_ring;
+    const size_t _consumer;
+    const size_t _elemSize;
+    int _fd;
+    bool _openedDirect;
+    std::atomic<bool> _directIO;
+    uint64_t _allocated;
+    std::atomic<bool> _done;
+    std::atomic<uint64_t> _bytesWritten;
+    std::atomic<uint64_t> _writeNs;
+    std::string _error;
+    std::thread _thread;
+};
+
+/*!
+ * A sample file mapped read-only for transmit replay.
+ *
+ * Blocks are handed out as pointers into the mapping so the stream writes
+ * straight from the page cache. The layout comes from the sidecar when there
+ * is one, otherwise the file is taken as blocks of defaultBlockElems for every
+ * channel. A single channel file is replayed on every stream channel.
+ */
+class ReplaySource
+{
+public:
+    /*!
+     * \param path the sample file
+     * \param elemSize bytes per element of the stream format
+     * \param numChans number of stream channels
+     * \param defaultBlockElems block size when the sidecar does not specify one
+     * \throws std::runtime_error when the file cannot be mapped or holds no whole block
+     */
+    ReplaySource(const std::string &path, const size_t elemSize, const size_t numChans, const size_t defaultBlockElems);
+
+    ~ReplaySource(void);
+
+    ReplaySource(const ReplaySource &) = delete;
+    ReplaySource &operator=(const ReplaySource &) = delete;
+
+    size_t numBlocks(void) const
+    {
+        return _numBlocks;
+    }
+
+    //! Elements per channel in each block
+    size_t blockElems(void) const
+    {
+        return _blockElems;
+    }
+
+    //! Mapped file size in bytes
+    size_t size(void) const
+    {
+        return _size;
+    }
+
+    //! Pointer to one channel of a block
+    const void *channel(const size_t block, const size_t chan) const
+    {
+        const size_t fileChan = (_fileChans == 1)?0:chan;
+        return static_cast<const char *>(_mem) + (block*_fileChans + fileChan)*_blockElems*_elemSize;
+    }
+
+    //! Ask for readahead of the window which starts at this block
+    void prefetch(const size_t block);
+
+    //! Fraction of the file currently resident in the page cache
+    double residentFraction(void) const;
+
+private:
+    void *_mem;
+    size_t _size;
+    size_t _elemSize;
+    size_t _fileChans;
+    size_t _blockElems;
+    size_t _numBlocks;
+    size_t _prefetchedTo;
+};
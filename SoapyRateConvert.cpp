@@ -0,0 +1,149 @@
+// Copyright (c) 2026 SoapySDR contributors
+// SPDX-License-Identifier: BSL-1.0
+
+#include "SoapyRateConvert.hpp"
+#include "SoapyRateAlloc.hpp"
+#include "SoapyRateProfile.hpp"
+#include "SoapyRateStats.hpp"
+#include <SoapySDR/Formats.hpp>
+#include <stdexcept>
+#include <algorithm>
+#include <chrono>
+
+ConvertStage::ConvertStage(
+    BlockRing &ring,
+    const size_t consumer,
+    const size_t blockElems,
+    const std::string &sourceFormat,
+    const std::string &targetFormat,
+    const double scaler,
+    const size_t numWorkers,
+    BufferPool &pool):
+    _ring(ring),
+    _consumer(consumer),
+    _sourceFormat(sourceFormat),
+    _targetFormat(targetFormat),
+    _scaler(scaler),
+    _fn(nullptr),
+    _done(new std::atomic<uint64_t>[ring.numSlots()]),
+    _released(0),
+    _stop(false),
+    _next(0),
+    _blockElems(blockElems)
+{
+    try
+    {
+        _fn = SoapySDR::ConverterRegistry::getFunction(sourceFormat, targetFormat);
+    }
+    catch (const std::exception &ex)
+    {
+        throw std::runtime_error("no converter " + sourceFormat + " -> " + targetFormat + ": " + ex.what());
+    }
+    if (_fn == nullptr) throw std::runtime_error("no converter " + sourceFormat + " -> " + targetFormat);
+    for (size_t i = 0; i < ring.numSlots(); i++) _done[i] = 0;
+
+    const size_t outBytes = blockElems*SoapySDR::formatToSize(targetFormat);
+    for (size_t i = 0; i < std::max<size_t>(1, numWorkers); i++)
+    {
+        _workers.emplace_back(new Worker());
+        _workers.back()->out = pool.acquire(ring.numChans(), outBytes);
+    }
+    for (auto &worker : _workers)
+    {
+        worker->thread = std::thread(&ConvertStage::workerLoop, this, std::ref(*worker));
+    }
+}
+
+ConvertStage::~ConvertStage(void)
+{
+    this->stop();
+}
+
+void ConvertStage::stop(void)
+{
+    _stop = true;
+    for (auto &worker : _workers)
+    {
+        if (worker->thread.joinable()) worker->thread.join();
+    }
+}
+
+uint64_t ConvertStage::convertedSamples(void) const
+{
+    uint64_t total(0);
+    for (const auto &worker : _workers) total += worker->samples.load(std::memory_order_relaxed);
+    return total;
+}
+
+void ConvertStage::workerStats(const size_t index, uint64_t &samples, double &busy) const
+{
+    const auto &worker = *_workers.at(index);
+    samples = worker.samples.load(std::memory_order_relaxed);
+    busy = worker.busyNs.load(std::memory_order_relaxed)/1e9;
+}
+
+double ConvertStage::soloRate(const double seconds) const
+{
+    std::vector<void *> outs(_ring.numChans());
+    for (size_t c = 0; c < outs.size(); c++) outs[c] = _workers.front()->out->slice(c);
+
+    uint64_t samples(0);
+    const int64_t t0 = steadyNs();
+    const int64_t stopNs = t0 + int64_t(seconds*1e9);
+    int64_t t1(t0);
+    for (uint64_t seq = 0; t1 < stopNs; seq++)
+    {
+        BlockRing::BlockInfo info;
+        void * const *slot = _ring.slotAt(seq, info);
+        for (size_t c = 0; c < outs.size(); c++) _fn(slot[c], outs[c], _blockElems, _scaler);
+        samples += _blockElems;
+        t1 = steadyNs();
+    }
+    return samples/((t1 - t0)/1e9);
+}
+
+void ConvertStage::workerLoop(Worker &worker)
+{
+    std::vector<void *> outs(_ring.numChans());
+    for (size_t c = 0; c < outs.size(); c++) outs[c] = worker.out->slice(c);
+    SteadyStateAllocations allocs("convert worker");
+    ThreadProfile prof("convert worker");
+
+    while (true)
+    {
+        //claim the next block, once stopped only blocks which were already committed remain
+        const uint64_t seq = _next.fetch_add(1, std::memory_order_relaxed);
+        while (_ring.committed() <= seq)
+        {
+            if (_stop) return;
+            std::this_thread::sleep_for(std::chrono::microseconds(50));
+            prof.lap(PROFILE_IDLE);
+        }
+        prof.lap(PROFILE_HANDOFF);
+
+        BlockRing::BlockInfo info;
+        void * const *slot = _ring.slotAt(seq, info);
+        const int64_t t0 = steadyNs();
+        for (size_t c = 0; c < outs.size(); c++) _fn(slot[c], outs[c], info.numElems, _scaler);
+        const int64_t t1 = steadyNs();
+        prof.lap(PROFILE_PROCESSING);
+        worker.samples.store(worker.samples.load(std::memory_order_relaxed) + info.numElems, std::memory_order_relaxed);
+        worker.busyNs.store(worker.busyNs.load(std::memory_order_relaxed) + uint64_t(t1 - t0), std::memory_order_relaxed);
+
+        _done[seq%_ring.numSlots()].store(seq + 1, std::memory_order_release);
+        this->releaseDone();
+        prof.lap(PROFILE_HANDOFF);
+        allocs.begin();
+    }
+}
+
+//slots return to the ring in order, past every block which is already converted
+void ConvertStage::releaseDone(void)
+{
+    std::lock_guard<std::mutex> lock(_releaseMutex);
+    uint64_t pos = _released;
+    while (_done[pos%_ring.numSlots()].load(std::memory_order_acquire) == pos + 1) pos++;
+    if (pos == _released) return;
+    _released = pos;
+    _ring.releaseTo(_consumer, pos);
+}
@@ -0,0 +1,109 @@
+// Copyright (c) 2026 SoapySDR contributors
+// SPDX-License-Identifier: BSL-1.0
+
+#pragma once
+#include "SoapyRateBuffers.hpp"
+#include <SoapySDR/ConverterRegistry.hpp>
+#include <string>
+#include <vector>
+#include <memory>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <cstddef>
+#include <cstdint>
+
+/*!
+ * Host side format conversion of RX blocks on a pool of worker threads.
+ *
+ * The stage is one consumer of a BlockRing. Workers claim whole blocks in
+ * sequence from a shared counter, convert every channel with the registry
+ * converter into their own output buffers, and mark the block done. Slots
+ * go back to the ring strictly in order, whichever worker finishes the
+ * oldest outstanding block releases it and any done blocks behind it.
+ */
+class ConvertStage
+{
+public:
+    /*!
+     * \param ring the source ring holding blocks in the stream format
+     * \param consumer this stage's consumer index in the ring
+     * \param blockElems largest number of elements in a ring slot
+     * \param sourceFormat the stream format
+     * \param targetFormat the format requested by the user
+     * \param scaler passed to the converter, the full scale of the integer side
+     * \param numWorkers number of conversion threads
+     * \param pool where the worker output buffers come from
+     * \throws std::runtime_error when the registry has no such converter
+     */
+    ConvertStage(
+        BlockRing &ring,
+        const size_t consumer,
+        const size_t blockElems,
+        const std::string &sourceFormat,
+        const std::string &targetFormat,
+        const double scaler,
+        const size_t numWorkers,
+        BufferPool &pool);
+
+    ~ConvertStage(void);
+
+    ConvertStage(const ConvertStage &) = delete;
+    ConvertStage &operator=(const ConvertStage &) = delete;
+
+    //! Convert what is left in the ring, then join the workers
+    void stop(void);
+
+    size_t numWorkers(void) const
+    {
+        return _workers.size();
+    }
+
+    const std::string &sourceFormat(void) const
+    {
+        return _sourceFormat;
+    }
+
+    const std::string &targetFormat(void) const
+    {
+        return _targetFormat;
+    }
+
+    //! Samples per channel converted by every worker together
+    uint64_t convertedSamples(void) const;
+
+    //! Samples per channel one worker converted and the seconds it spent converting
+    void workerStats(const size_t worker, uint64_t &samples, double &busy) const;
+
+    /*!
+     * Samples per second of one thread converting ring blocks with no other worker running.
+     * Only valid after stop(), the blocks left in the ring are converted again for the given time.
+     */
+    double soloRate(const double seconds) const;
+
+private:
+    struct alignas(64) Worker
+    {
+        std::thread thread;
+        BufferPool::Lease out; //one slice per channel
+        std::atomic<uint64_t> samples{0};
+        std::atomic<uint64_t> busyNs{0};
+    };
+
+    void workerLoop(Worker &worker);
+    void releaseDone(void);
+
+    BlockRing &_ring;
+    const size_t _consumer;
+    const std::string _sourceFormat;
+    const std::string _targetFormat;
+    const double _scaler;
+    SoapySDR::ConverterRegistry::ConverterFunction _fn;
+    std::unique_ptr<std::atomic<uint64_t>[]> _done; //per slot, the sequence number plus one once converted
+    std::mutex _releaseMutex;
+    uint64_t _released;
+    std::atomic<bool> _stop;
+    alignas(64) std::atomic<uint64_t> _next;
+    size_t _blockElems;
+    std::vector<std::unique_ptr<Worker>> _workers;
+};
@@ -0,0 +1,508 @@
+// Copyright (c) 2026 SoapySDR contributors
+// SPDX-License-Identifier: BSL-1.0
+
+#include "SoapyRateDsp.hpp"
+#include "SoapyRateAlloc.hpp"
+#include "SoapyRateProfile.hpp"
+#include <SoapySDR/Formats.hpp>
+#include <stdexcept>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <numbers>
+#include <cstring>
+
+static const int64_t DSP_STEP_NS = 1000000000LL; //measured time of one load step
+static const double DSP_CONVERGE_RATIO = 1.1; //failed over sustained load where the search stops
+static const double DSP_MIN_LOAD = 1.0/64;
+static const double DSP_MAX_LOAD = 4096.0;
+static const size_t DSP_MAX_STEPS = 64; //reserved so recording a step never allocates
+static const auto DSP_IDLE_SLEEP = std::chrono::microseconds(50);
+
+/***********************************************************************
+ * Kernel parsing and tables
+ **********************************************************************/
+std::string DspKernel::name(void) const
+{
+    switch (type)
+    {
+    case FFT: return "fft:" + std::to_string(size);
+    case FIR: return "fir:" + std::to_string(size) + "/" + std::to_string(decim);
+    case POWER: return "power:" + std::to_string(size);
+    }
+    return "";
+}
+
+static size_t parseKernelSize(const std::string &item, const std::string &value, const size_t defaultSize)
+{
+    if (value.empty()) return defaultSize;
+    size_t pos(0);
+    unsigned long result(0);
+    try
+    {
+        result = std::stoul(value, &pos);
+    }
+    catch (const std::exception &)
+    {
+        pos = 0;
+    }
+    if (pos != value.size() or result == 0) throw std::runtime_error("bad size in DSP kernel " + item);
+    return result;
+}
+
+static DspKernel makeFft(const std::string &item, const size_t size)
+{
+    if (size < 2 or size > (1 << 20) or (size & (size - 1)) != 0) throw std::runtime_error("FFT size must be a power of two in " + item);
+    DspKernel k{DspKernel::FFT, size, 1, {}, {}, {}};
+    for (size_t j = 0; j < size/2; j++) k.twiddles.push_back(std::polar(1.0f, float(-2*std::numbers::pi*j/size)));
+    size_t bits(0);
+    while ((size_t(1) << bits) < size) bits++;
+    for (size_t i = 0; i < size; i++)
+    {
+        uint32_t r(0);
+        for (size_t b = 0; b < bits; b++) if ((i >> b) & 1) r |= uint32_t(1) << (bits - 1 - b);
+        k.bitReverse.push_back(r);
+    }
+    return k;
+}
+
+//windowed sinc low pass with its cutoff at the decimated Nyquist rate
+static DspKernel makeFir(const size_t numTaps, const size_t decim)
+{
+    DspKernel k{DspKernel::FIR, numTaps, decim, {}, {}, {}};
+    const double cutoff = 0.5/decim;
+    double sum(0.0);
+    for (size_t j = 0; j < numTaps; j++)
+    {
+        const double t = j - (numTaps - 1)/2.0;
+        const double sinc = (t == 0.0)?2*cutoff:std::sin(2*std::numbers::pi*cutoff*t)/(std::numbers::pi*t);
+        const double window = (numTaps == 1)?1.0:(0.54 - 0.46*std::cos(2*std::numbers::pi*j/(numTaps - 1)));
+        k.taps.push_back(float(sinc*window));
+        sum += sinc*window;
+    }
+    for (auto &tap : k.taps) tap = float(tap/sum);
+    return k;
+}
+
+std::vector<DspKernel> parseDspKernels(const std::string &spec)
+{
+    std::vector<DspKernel> kernels;
+    size_t start(0);
+    while (start <= spec.size())
+    {
+        const size_t end = std::min(spec.find(',', start), spec.size());
+        std::string item = spec.substr(start, end - start);
+        item.erase(0, item.find_first_not_of(" "));
+        item.erase(item.find_last_not_of(" ") + 1);
+        start = end + 1;
+        if (item.empty()) continue;
+
+        const size_t colon = item.find(':');
+        const std::string kind = item.substr(0, colon);
+        const std::string value = (colon == std::string::npos)?"":item.substr(colon + 1);
+        if (kind == "fft") kernels.push_back(makeFft(item, parseKernelSize(item, value, 1024)));
+        else if (kind == "fir")
+        {
+            const size_t slash = value.find('/');
+            const size_t numTaps = parseKernelSize(item, value.substr(0, slash), 64);
+            const size_t decim = (slash == std::string::npos)?4:parseKernelSize(item, value.substr(slash + 1), 4);
+            kernels.push_back(makeFir(numTaps, decim));
+        }
+        else if (kind == "power") kernels.push_back(DspKernel{DspKernel::POWER, parseKernelSize(item, value, 256), 1, {}, {}, {}});
+        else throw std::runtime_error("unknown DSP kernel " + item + ", use fft, fir or power");
+    }
+    if (kernels.empty()) throw std::runtime_error("no DSP kernels in " + spec);
+    return kernels;
+}
+
+static std::string joinKernelNames(const std::vector<DspKernel> &kernels)
+{
+    std::string names;
+    for (const auto &k : kernels)
+    {
+        if (not names.empty()) names += ",";
+        names += k.name();
+    }
+    return names;
+}
+
+/***********************************************************************
+ * The kernels, complex products are spelled out to stay clear of the
+ * NaN checking library call behind std::complex multiplication
+ **********************************************************************/
+static void runFft(std::complex<float> *x, const DspKernel &k)
+{
+    const size_t n = k.size;
+    for (size_t i = 0; i < n; i++)
+    {
+        const size_t j = k.bitReverse[i];
+        if (i < j) std::swap(x[i], x[j]);
+    }
+    for (size_t len = 2; len <= n; len <<= 1)
+    {
+        const size_t half = len/2;
+        const size_t step = n/len;
+        for (size_t i = 0; i < n; i += len)
+        {
+            for (size_t j = 0; j < half; j++)
+            {
+                const auto w = k.twiddles[j*step];
+                const auto v = x[i + j + half];
+                const std::complex<float> t(w.real()*v.real() - w.imag()*v.imag(), w.real()*v.imag() + w.imag()*v.real());
+                x[i + j + half] = x[i + j] - t;
+                x[i + j] += t;
+            }
+        }
+    }
+}
+
+static float runFir(const std::complex<float> *x, const size_t numElems, const DspKernel &k, std::complex<float> *out)
+{
+    const size_t numTaps = k.size;
+    size_t numOut(0);
+    for (size_t i = 0; i + numTaps <= numElems; i += k.decim)
+    {
+        float re(0.0f), im(0.0f);
+        for (size_t j = 0; j < numTaps; j++)
+        {
+            re += k.taps[j]*x[i + j].real();
+            im += k.taps[j]*x[i + j].imag();
+        }
+        out[numOut++] = std::complex<float>(re, im);
+    }
+    return (numOut == 0)?0.0f:out[numOut/2].real();
+}
+
+static float runPower(const std::complex<float> *x, const size_t numElems, const DspKernel &k)
+{
+    float total(0.0f);
+    for (size_t i = 0; i < numElems; i++) total += x[i].real()*x[i].real() + x[i].imag()*x[i].imag();
+    const float threshold = 2.0f*total/std::max<size_t>(1, numElems);
+    size_t detections(0);
+    for (size_t off = 0; off + k.size <= numElems; off += k.size)
+    {
+        float power(0.0f);
+        for (size_t i = off; i < off + k.size; i++) power += x[i].real()*x[i].real() + x[i].imag()*x[i].imag();
+        if (power/k.size > threshold) detections++;
+    }
+    return total + detections;
+}
+
+void DspStage::runKernels(Worker &worker, const size_t numElems)
+{
+    const auto *x = worker.input;
+    auto *scratch = worker.scratch;
+    for (const auto &k : _kernels) switch (k.type)
+    {
+    case DspKernel::FFT:
+        for (size_t off = 0; off + k.size <= numElems; off += k.size)
+        {
+            std::memcpy(scratch, x + off, k.size*sizeof(*x));
+            runFft(scratch, k);
+            worker.sink += scratch[1].real();
+        }
+        break;
+    case DspKernel::FIR:
+        worker.sink += runFir(x, numElems, k, scratch);
+        break;
+    case DspKernel::POWER:
+        worker.sink += runPower(x, numElems, k);
+        break;
+    }
+}
+
+/***********************************************************************
+ * Stage setup and accessors
+ **********************************************************************/
+DspStage::DspStage(
+    BlockRing &ring,
+    const size_t consumer,
+    const size_t blockElems,
+    const std::string &format,
+    const double scaler,
+    const std::vector<DspKernel> &kernels,
+    const size_t numWorkers,
+    const StreamPublisher &rxPub,
+    BufferPool &pool):
+    _ring(ring),
+    _consumer(consumer),
+    _format(format),
+    _scaler(scaler),
+    _kernels(kernels),
+    _kernelNames(joinKernelNames(kernels)),
+    _rxPub(rxPub),
+    _fn(nullptr),
+    _remaining(new std::atomic<size_t>[ring.numSlots()]),
+    _done(new std::atomic<uint64_t>[ring.numSlots()]),
+    _released(0),
+    _stop(false),
+    _dispatchDone(false),
+    _load(1.0),
+    _draining(true),
+    _stepStartNs(0),
+    _stepBusyNs(0),
+    _stepSamples(0),
+    _stepFaults(0),
+    _stepPeak(0),
+    _good(0.0),
+    _bad(0.0),
+    _converged(false)
+{
+    if (format != SOAPY_SDR_CF32) try
+    {
+        _fn = SoapySDR::ConverterRegistry::getFunction(format, SOAPY_SDR_CF32);
+    }
+    catch (const std::exception &ex)
+    {
+        throw std::runtime_error("no converter " + format + " -> " + SOAPY_SDR_CF32 + " for the DSP stage: " + ex.what());
+    }
+    for (size_t i = 0; i < ring.numSlots(); i++)
+    {
+        _remaining[i] = 0;
+        _done[i] = 0;
+    }
+
+    _steps.reserve(DSP_MAX_STEPS);
+
+    //every queue holds all the tasks the ring can have outstanding
+    size_t fftSize(0);
+    for (const auto &k : kernels) if (k.type == DspKernel::FFT) fftSize = std::max(fftSize, k.size);
+    const size_t bufferBytes = std::max(blockElems, fftSize)*sizeof(std::complex<float>);
+    for (size_t i = 0; i < std::max<size_t>(1, numWorkers); i++)
+    {
+        _workers.emplace_back(new Worker());
+        auto &worker = *_workers.back();
+        worker.index = i;
+        worker.tasks.resize(ring.numSlots()*ring.numChans());
+        worker.buffers = pool.acquire(2, bufferBytes);
+        worker.input = static_cast<std::complex<float> *>(worker.buffers->slice(0));
+        worker.scratch = static_cast<std::complex<float> *>(worker.buffers->slice(1));
+    }
+    for (auto &worker : _workers)
+    {
+        worker->thread = std::thread(&DspStage::workerLoop, this, std::ref(*worker));
+    }
+    _dispatcher = std::thread(&DspStage::dispatchLoop, this);
+}
+
+DspStage::~DspStage(void)
+{
+    this->stop();
+}
+
+void DspStage::stop(void)
+{
+    _stop = true;
+    if (_dispatcher.joinable()) _dispatcher.join();
+    for (auto &worker : _workers)
+    {
+        if (worker->thread.joinable()) worker->thread.join();
+    }
+}
+
+uint64_t DspStage::processedSamples(void) const
+{
+    uint64_t total(0);
+    for (const auto &worker : _workers) total += worker->samples.load(std::memory_order_relaxed);
+    return total;
+}
+
+uint64_t DspStage::steals(void) const
+{
+    uint64_t total(0);
+    for (const auto &worker : _workers) total += worker->steals.load(std::memory_order_relaxed);
+    return total;
+}
+
+uint64_t DspStage::busyNs(void) const
+{
+    uint64_t total(0);
+    for (const auto &worker : _workers) total += worker->busyNs.load(std::memory_order_relaxed);
+    return total;
+}
+
+std::vector<DspLoadStep> DspStage::steps(void) const
+{
+    std::lock_guard<std::mutex> lock(_searchMutex);
+    return _steps;
+}
+
+bool DspStage::converged(void) const
+{
+    std::lock_guard<std::mutex> lock(_searchMutex);
+    return _converged;
+}
+
+double DspStage::sustainedLoad(void) const
+{
+    std::lock_guard<std::mutex> lock(_searchMutex);
+    return _good;
+}
+
+double DspStage::failedLoad(void) const
+{
+    std::lock_guard<std::mutex> lock(_searchMutex);
+    return _bad;
+}
+
+/***********************************************************************
+ * Dispatcher: hand out blocks and steer the load search
+ **********************************************************************/
+void DspStage::dispatchLoop(void)
+{
+    const size_t numChans = _ring.numChans();
+    uint64_t next(0);
+    size_t target(0);
+    SteadyStateAllocations allocs("DSP dispatcher");
+    ThreadProfile prof("DSP dispatcher");
+    while (not _stop)
+    {
+        const uint64_t committed = _ring.committed();
+        if (next != 0) allocs.begin();
+        for (; next < committed; next++)
+        {
+            //all channels of a block start on one worker, the others steal them when idle
+            _remaining[next%_ring.numSlots()].store(numChans, std::memory_order_relaxed);
+            auto &worker = *_workers[target++ % _workers.size()];
+            std::lock_guard<std::mutex> lock(worker.mutex);
+            for (size_t c = 0; c < numChans; c++) worker.tasks[worker.back++ % worker.tasks.size()] = Task{next, c};
+        }
+        prof.lap(PROFILE_HANDOFF);
+        this->controlStep(steadyNs());
+        prof.lap(PROFILE_ACCOUNTING);
+        std::this_thread::sleep_for(DSP_IDLE_SLEEP);
+        prof.lap(PROFILE_IDLE);
+    }
+    allocs.end();
+    prof.end();
+    _dispatchDone = true;
+}
+
+void DspStage::controlStep(const int64_t nowNs)
+{
+    const size_t numSlots = _ring.numSlots();
+    const size_t pending = _ring.pending(_consumer);
+    _stepPeak = std::max(_stepPeak, pending);
+    if (_converged) return;
+
+    //a failed step leaves a backlog, the next one starts once it has mostly drained
+    if (_draining)
+    {
+        if (pending > numSlots/4) return;
+        _draining = false;
+        _stepStartNs = nowNs;
+        _stepBusyNs = this->busyNs();
+        _stepSamples = this->processedSamples();
+        _stepFaults = _rxPub.droppedBlocks() + _rxPub.overflows();
+        _stepPeak = pending;
+        return;
+    }
+    if (nowNs - _stepStartNs < DSP_STEP_NS) return;
+
+    const double load = _load.load(std::memory_order_relaxed);
+    const uint64_t samples = this->processedSamples() - _stepSamples;
+    DspLoadStep step;
+    step.load = load;
+    step.sustained = _rxPub.droppedBlocks() + _rxPub.overflows() == _stepFaults and _stepPeak < numSlots and pending <= numSlots/2;
+    step.ringPeak = _stepPeak;
+    step.cpuPerSample = (samples == 0)?0.0:double(this->busyNs() - _stepBusyNs)/samples;
+
+    std::lock_guard<std::mutex> lock(_searchMutex);
+    _steps.push_back(step);
+    if (step.sustained) _good = std::max(_good, load);
+    else _bad = (_bad == 0.0)?load:std::min(_bad, load);
+
+    //double until a failure, halve until a success, then bisect geometrically
+    double nextLoad(load);
+    if (_bad == 0.0) nextLoad = load*2;
+    else if (_good == 0.0) nextLoad = load/2;
+    else nextLoad = std::sqrt(_good*_bad);
+    if ((_good != 0.0 and _bad != 0.0 and _bad/_good <= DSP_CONVERGE_RATIO) or nextLoad < DSP_MIN_LOAD or nextLoad > DSP_MAX_LOAD)
+    {
+        _converged = true;
+        nextLoad = std::max(_good, DSP_MIN_LOAD);
+    }
+    _load.store(nextLoad, std::memory_order_relaxed);
+    _draining = true;
+}
+
+/***********************************************************************
+ * Workers: own queue newest first, then steal the oldest elsewhere
+ **********************************************************************/
+bool DspStage::takeTask(Worker &worker, Task &task)
+{
+    {
+        std::lock_guard<std::mutex> lock(worker.mutex);
+        if (worker.back != worker.front)
+        {
+            task = worker.tasks[--worker.back % worker.tasks.size()];
+            return true;
+        }
+    }
+    for (size_t i = 1; i < _workers.size(); i++)
+    {
+        auto &victim = *_workers[(worker.index + i) % _workers.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (victim.back == victim.front) continue;
+        task = victim.tasks[victim.front++ % victim.tasks.size()];
+        worker.steals.store(worker.steals.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        return true;
+    }
+    return false;
+}
+
+void DspStage::workerLoop(Worker &worker)
+{
+    SteadyStateAllocations allocs("DSP worker");
+    ThreadProfile prof("DSP worker");
+    while (true)
+    {
+        Task task;
+        if (this->takeTask(worker, task))
+        {
+            prof.lap(PROFILE_HANDOFF);
+            this->process(worker, task);
+            prof.lap(PROFILE_PROCESSING);
+            allocs.begin();
+            continue;
+        }
+        if (_dispatchDone) return;
+        std::this_thread::sleep_for(DSP_IDLE_SLEEP);
+        prof.lap(PROFILE_IDLE);
+    }
+}
+
+void DspStage::process(Worker &worker, const Task &task)
+{
+    BlockRing::BlockInfo info;
+    void * const *slot = _ring.slotAt(task.seq, info);
+    const size_t numElems = info.numElems;
+    const int64_t t0 = steadyNs();
+    if (_fn != nullptr) _fn(slot[task.chan], worker.input, numElems, _scaler);
+    else std::memcpy(worker.input, slot[task.chan], numElems*sizeof(std::complex<float>));
+
+    const double load = _load.load(std::memory_order_relaxed);
+    const size_t passes = size_t(load);
+    for (size_t p = 0; p < passes; p++) this->runKernels(worker, numElems);
+    const size_t partial = size_t((load - passes)*numElems);
+    if (partial != 0) this->runKernels(worker, partial);
+    const int64_t t1 = steadyNs();
+    worker.samples.store(worker.samples.load(std::memory_order_relaxed) + numElems, std::memory_order_relaxed);
+    worker.busyNs.store(worker.busyNs.load(std::memory_order_relaxed) + uint64_t(t1 - t0), std::memory_order_relaxed);
+
+    const size_t index = task.seq%_ring.numSlots();
+    if (_remaining[index].fetch_sub(1, std::memory_order_acq_rel) != 1) return;
+    _done[index].store(task.seq + 1, std::memory_order_release);
+    this->releaseDone();
+}
+
+//slots return to the ring in order, past every block which is already processed
+void DspStage::releaseDone(void)
+{
+    std::lock_guard<std::mutex> lock(_releaseMutex);
+    uint64_t pos = _released;
+    while (_done[pos%_ring.numSlots()].load(std::memory_order_acquire) == pos + 1) pos++;
+    if (pos == _released) return;
+    _released = pos;
+    _ring.releaseTo(_consumer, pos);
+}
@@ -0,0 +1,205 @@
+// Copyright (c) 2026 SoapySDR contributors
+// SPDX-License-Identifier: BSL-1.0
+
+#pragma once
+#include "SoapyRateBuffers.hpp"
+#include "SoapyRateStats.hpp"
+#include <SoapySDR/ConverterRegistry.hpp>
+#include <string>
+#include <vector>
+#include <complex>
+#include <memory>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <cstddef>
+#include <cstdint>
+
+/*!
+ * One synthetic processing kernel run over every channel of every block.
+ */
+struct DspKernel
+{
+    enum Type
+    {
+        FFT, //radix 2 transforms of size over the block
+        FIR, //size taps low pass, keeping every decim output
+        POWER //mean power over windows of size, counting windows above twice the block mean
+    };
+
+    Type type;
+    size_t size;
+    size_t decim;
+    std::vector<std::complex<float>> twiddles;
+    std::vector<uint32_t> bitReverse;
+    std::vector<float> taps;
+
+    //! The kernel as written on the command line, with every default filled in
+    std::string name(void) const;
+};
+
+/*!
+ * Parse a comma separated kernel list: fft[:size], fir[:taps[/decim]], power[:window].
+ * \throws std::runtime_error on an unknown kernel or a bad size
+ */
+std::vector<DspKernel> parseDspKernels(const std::string &spec);
+
+/*!
+ * One trial of the load search.
+ */
+struct DspLoadStep
+{
+    double load; //kernel passes over every block
+    bool sustained; //no dropped blocks or overflows and the backlog stayed under half the ring
+    size_t ringPeak; //most blocks waiting for the stage
+    double cpuPerSample; //worker ns per channel sample at this load
+};
+
+/*!
+ * Synthetic DSP on the RX blocks, run by a work-stealing thread pool.
+ *
+ * The stage is one consumer of a BlockRing. A dispatcher thread hands every
+ * new block to the next worker as one task per channel, workers pop their own
+ * newest task first and steal the oldest task of another worker when they run
+ * dry. A block goes back to the ring once all its channels are done, in order.
+ *
+ * Every task converts its channel to CF32 and runs the kernel chain load times,
+ * a fractional load runs the last pass over that share of the block. The
+ * dispatcher searches for the highest load the host sustains at the stream rate:
+ * the load doubles until a step drops blocks, then bisects between the last
+ * sustained and the first failed load, and holds the best load once converged.
+ */
+class DspStage
+{
+public:
+    /*!
+     * \param ring the source ring holding blocks in the stream format
+     * \param consumer this stage's consumer index in the ring
+     * \param blockElems largest number of elements in a ring slot
+     * \param format the stream format
+     * \param scaler passed to the converter, the full scale of the integer side
+     * \param kernels the kernel chain from parseDspKernels()
+     * \param numWorkers number of processing threads
+     * \param rxPub the RX stream counters, its drops and overflows fail a step
+     * \param pool where the worker buffers come from
+     * \throws std::runtime_error when the registry has no converter to CF32
+     */
+    DspStage(
+        BlockRing &ring,
+        const size_t consumer,
+        const size_t blockElems,
+        const std::string &format,
+        const double scaler,
+        const std::vector<DspKernel> &kernels,
+        const size_t numWorkers,
+        const StreamPublisher &rxPub,
+        BufferPool &pool);
+
+    ~DspStage(void);
+
+    DspStage(const DspStage &) = delete;
+    DspStage &operator=(const DspStage &) = delete;
+
+    //! Stop dispatching, finish the queued tasks and join every thread
+    void stop(void);
+
+    size_t numWorkers(void) const
+    {
+        return _workers.size();
+    }
+
+    //! The kernel chain, comma separated
+    const std::string &kernelNames(void) const
+    {
+        return _kernelNames;
+    }
+
+    //! Kernel passes per block right now
+    double load(void) const
+    {
+        return _load.load(std::memory_order_relaxed);
+    }
+
+    //! Samples per channel every worker processed together
+    uint64_t processedSamples(void) const;
+
+    //! Tasks taken from another worker's queue
+    uint64_t steals(void) const;
+
+    //! Steps of the load search so far
+    std::vector<DspLoadStep> steps(void) const;
+
+    //! The search narrowed the load to the convergence ratio
+    bool converged(void) const;
+
+    //! Highest load of a sustained step, 0 when none was
+    double sustainedLoad(void) const;
+
+    //! Lowest load of a failed step, 0 when none failed
+    double failedLoad(void) const;
+
+private:
+    struct Task
+    {
+        uint64_t seq;
+        size_t chan;
+    };
+
+    struct alignas(64) Worker
+    {
+        size_t index;
+        std::thread thread;
+        std::mutex mutex;
+        std::vector<Task> tasks; //fixed ring, pushed and popped at the back, stolen from the front
+        uint64_t front = 0;
+        uint64_t back = 0;
+        BufferPool::Lease buffers; //the converted input and the kernel scratch
+        std::complex<float> *input = nullptr;
+        std::complex<float> *scratch = nullptr;
+        float sink = 0.0f; //kernel results end up here so nothing is optimized away
+        std::atomic<uint64_t> samples{0};
+        std::atomic<uint64_t> busyNs{0};
+        std::atomic<uint64_t> steals{0};
+    };
+
+    void dispatchLoop(void);
+    void controlStep(const int64_t nowNs);
+    void workerLoop(Worker &worker);
+    bool takeTask(Worker &worker, Task &task);
+    void process(Worker &worker, const Task &task);
+    void runKernels(Worker &worker, const size_t numElems);
+    void releaseDone(void);
+    uint64_t busyNs(void) const;
+
+    BlockRing &_ring;
+    const size_t _consumer;
+    const std::string _format;
+    const double _scaler;
+    const std::vector<DspKernel> _kernels;
+    const std::string _kernelNames;
+    const StreamPublisher &_rxPub;
+    SoapySDR::ConverterRegistry::ConverterFunction _fn;
+    std::unique_ptr<std::atomic<size_t>[]> _remaining; //per slot, channels still to process
+    std::unique_ptr<std::atomic<uint64_t>[]> _done; //per slot, the sequence number plus one once processed
+    std::mutex _releaseMutex;
+    uint64_t _released;
+    std::atomic<bool> _stop;
+    std::atomic<bool> _dispatchDone;
+    alignas(64) std::atomic<double> _load;
+
+    //load search state, owned by the dispatcher except where the mutex is taken
+    bool _draining;
+    int64_t _stepStartNs;
+    uint64_t _stepBusyNs;
+    uint64_t _stepSamples;
+    uint64_t _stepFaults;
+    size_t _stepPeak;
+    mutable std::mutex _searchMutex;
+    std::vector<DspLoadStep> _steps;
+    double _good;
+    double _bad;
+    bool _converged;
+
+    std::thread _dispatcher;
+    std::vector<std::unique_ptr<Worker>> _workers;
+};
@@ -0,0 +1,134 @@
+// Copyright (c) 2026 SoapySDR contributors
+// SPDX-License-Identifier: BSL-1.0
+
+#include "SoapyRateEngine.hpp"
+#include <chrono>
+#include <stdexcept>
+#include <iostream>
+#include <sys/resource.h>
+
+static const auto ENGINE_IDLE_SLEEP = std::chrono::microseconds(20); //back off after a pass without samples
+
+/***********************************************************************
+ * Task handle ownership
+ **********************************************************************/
+StreamTask::StreamTask(StreamTask &&other) noexcept:
+    _handle(other._handle)
+{
+    other._handle = nullptr;
+}
+
+StreamTask &StreamTask::operator=(StreamTask &&other) noexcept
+{
+    if (this == &other) return *this;
+    if (_handle) _handle.destroy();
+    _handle = other._handle;
+    other._handle = nullptr;
+    return *this;
+}
+
+StreamTask::~StreamTask(void)
+{
+    if (_handle) _handle.destroy();
+}
+
+EngineThreadStats currentThreadStats(void)
+{
+    EngineThreadStats stats;
+    struct rusage usage;
+    if (getrusage(RUSAGE_THREAD, &usage) != 0) return stats;
+    stats.cpuTime = usage.ru_utime.tv_sec + usage.ru_utime.tv_usec*1e-6 + usage.ru_stime.tv_sec + usage.ru_stime.tv_usec*1e-6;
+    stats.voluntarySwitches = usage.ru_nvcsw;
+    stats.involuntarySwitches = usage.ru_nivcsw;
+    return stats;
+}
+
+/***********************************************************************
+ * Scheduler threads
+ **********************************************************************/
+StreamEngine::StreamEngine(const size_t numThreads):
+    _nextThread(0),
+    _stop(false)
+{
+    if (numThreads == 0) throw std::runtime_error("stream engine needs at least one thread");
+    for (size_t i = 0; i < numThreads; i++) _threads.emplace_back(new EngineThread());
+    for (auto &et : _threads) et->thread = std::thread(&StreamEngine::threadLoop, this, std::ref(*et));
+}
+
+StreamEngine::~StreamEngine(void)
+{
+    this->stop();
+}
+
+void StreamEngine::spawn(const TaskFactory &factory)
+{
+    auto &et = *_threads[_nextThread++ % _threads.size()];
+    std::unique_ptr<EngineSlot> slot(new EngineSlot(true));
+    auto task = factory(*slot);
+    Job job{std::move(slot), std::move(task)};
+    {
+        std::lock_guard<std::mutex> lock(et.mutex);
+        et.inbox.push_back(std::move(job));
+    }
+    et.cond.notify_one();
+}
+
+void StreamEngine::stop(void)
+{
+    _stop = true;
+    for (auto &et : _threads)
+    {
+        {
+            std::lock_guard<std::mutex> lock(et->mutex);
+        }
+        et->cond.notify_one();
+        if (et->thread.joinable()) et->thread.join();
+    }
+}
+
+void StreamEngine::threadLoop(EngineThread &et)
+{
+    std::vector<Job> jobs;
+    while (true)
+    {
+        //pick up new tasks, sleeping on the inbox while there is nothing else to run
+        {
+            std::unique_lock<std::mutex> lock(et.mutex);
+            if (jobs.empty()) et.cond.wait(lock, [&]{return _stop or not et.inbox.empty();});
+            for (auto &job : et.inbox) jobs.push_back(std::move(job));
+            et.stats.streams += et.inbox.size();
+            et.inbox.clear();
+        }
+        if (jobs.empty()) break;
+
+        bool progress(false);
+        for (auto it = jobs.begin(); it != jobs.end();)
+        {
+            it->task.resume();
+            if (not it->slot->takeIdle()) progress = true;
+            if (not it->task.done())
+            {
+                ++it;
+                continue;
+            }
+            try
+            {
+                if (it->task.error()) std::rethrow_exception(it->task.error());
+            }
+            catch (const std::exception &ex)
+            {
+                std::cerr << "Stream task failed: " << ex.what() << std::endl;
+            }
+            it = jobs.erase(it);
+        }
+        et.stats.passes++;
+        if (progress) continue;
+        et.stats.idlePasses++;
+        std::this_thread::sleep_for(ENGINE_IDLE_SLEEP);
+    }
+
+    const auto usage = currentThreadStats();
+    et.stats.cpuTime = usage.cpuTime;
+    et.stats.voluntarySwitches = usage.voluntarySwitches;
+    et.stats.involuntarySwitches = usage.involuntarySwitches;
+}
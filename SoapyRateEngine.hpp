@@ -0,0 +1,237 @@
+// Copyright (c) 2026 SoapySDR contributors
+// SPDX-License-Identifier: BSL-1.0
+
+#pragma once
+#include <coroutine>
+#include <exception>
+#include <functional>
+#include <string>
+#include <vector>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+/*!
+ * A stream loop written as a coroutine.
+ *
+ * The task is created suspended and runs until it awaits its EngineSlot.
+ * Without an engine the slot never suspends, so resuming the task once
+ * runs the whole loop on the calling thread, exactly like a plain function.
+ */
+class StreamTask
+{
+public:
+    struct promise_type
+    {
+        std::exception_ptr error;
+
+        StreamTask get_return_object(void)
+        {
+            return StreamTask(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+        std::suspend_always initial_suspend(void) noexcept
+        {
+            return {};
+        }
+        std::suspend_always final_suspend(void) noexcept
+        {
+            return {};
+        }
+        void return_void(void)
+        {
+            return;
+        }
+        void unhandled_exception(void)
+        {
+            error = std::current_exception();
+        }
+    };
+
+    StreamTask(StreamTask &&other) noexcept;
+    StreamTask &operator=(StreamTask &&other) noexcept;
+    ~StreamTask(void);
+
+    StreamTask(const StreamTask &) = delete;
+    StreamTask &operator=(const StreamTask &) = delete;
+
+    bool done(void) const
+    {
+        return not _handle or _handle.done();
+    }
+
+    //! Run the task to its next suspension point
+    void resume(void)
+    {
+        _handle.resume();
+    }
+
+    //! The exception which ended the task, nullptr when it returned
+    std::exception_ptr error(void) const
+    {
+        return _handle?_handle.promise().error:nullptr;
+    }
+
+private:
+    explicit StreamTask(std::coroutine_handle<promise_type> handle):
+        _handle(handle)
+    {
+        return;
+    }
+    std::coroutine_handle<promise_type> _handle;
+};
+
+/*!
+ * The scheduling point of one task, awaited before every stream call.
+ *
+ * An engine slot suspends the task and stream calls use a zero timeout,
+ * a stream which found nothing to do marks itself idle so the engine can
+ * back off once a whole pass over its tasks made no progress. A default
+ * constructed slot belongs to no engine, it never suspends and leaves the
+ * calls blocking with the usual timeout.
+ */
+class EngineSlot
+{
+public:
+    static const long BLOCKING_TIMEOUT_US = 100000;
+
+    EngineSlot(void) = default;
+
+    explicit EngineSlot(const bool polling):
+        _polling(polling)
+    {
+        return;
+    }
+
+    //! Timeout for the stream calls of this task
+    long timeoutUs(void) const
+    {
+        return _polling?0:BLOCKING_TIMEOUT_US;
+    }
+
+    bool polling(void) const
+    {
+        return _polling;
+    }
+
+    //! The last stream call returned without moving any samples
+    void markIdle(void)
+    {
+        _idle = true;
+    }
+
+    //! Read and clear the idle mark, called by the engine after every resume
+    bool takeIdle(void)
+    {
+        const bool idle = _idle;
+        _idle = false;
+        return idle;
+    }
+
+    bool await_ready(void) const noexcept
+    {
+        return not _polling;
+    }
+    void await_suspend(std::coroutine_handle<>) const noexcept
+    {
+        return;
+    }
+    void await_resume(void) const noexcept
+    {
+        return;
+    }
+
+private:
+    bool _polling = false;
+    bool _idle = false;
+};
+
+/*!
+ * Scheduling cost of one thread which ran stream loops.
+ */
+struct EngineThreadStats
+{
+    size_t streams = 0;
+    double cpuTime = 0.0; //user plus system seconds
+    long voluntarySwitches = 0;
+    long involuntarySwitches = 0;
+    uint64_t passes = 0; //rounds over every task of the thread, 0 for a stream thread
+    uint64_t idlePasses = 0; //rounds in which no task moved samples
+};
+
+/*!
+ * Cpu time and context switches of the calling thread since it started.
+ */
+EngineThreadStats currentThreadStats(void);
+
+/*!
+ * Stream loops multiplexed as coroutines over a small pool of threads.
+ *
+ * Every spawned task goes to the next thread round robin and stays there.
+ * A thread resumes its tasks in turn, each runs one non-blocking stream
+ * call and suspends again. When no task of a pass moved any samples the
+ * thread sleeps briefly instead of spinning on the driver.
+ */
+class StreamEngine
+{
+public:
+    typedef std::function<StreamTask(EngineSlot &)> TaskFactory;
+
+    explicit StreamEngine(const size_t numThreads);
+
+    ~StreamEngine(void);
+
+    StreamEngine(const StreamEngine &) = delete;
+    StreamEngine &operator=(const StreamEngine &) = delete;
+
+    size_t numThreads(void) const
+    {
+        return _threads.size();
+    }
+
+    //! A scheduler thread, exposed for affinity and priority
+    std::thread &thread(const size_t index)
+    {
+        return _threads[index]->thread;
+    }
+
+    /*!
+     * Create a task on the next thread, it starts on that thread's next pass.
+     * \param factory called with the task's slot, returns the suspended task
+     */
+    void spawn(const TaskFactory &factory);
+
+    //! Wait for every task to return, then join the threads
+    void stop(void);
+
+    //! Per thread statistics, complete after stop()
+    const EngineThreadStats &stats(const size_t index) const
+    {
+        return _threads[index]->stats;
+    }
+
+private:
+    struct Job
+    {
+        std::unique_ptr<EngineSlot> slot;
+        StreamTask task;
+    };
+
+    struct EngineThread
+    {
+        std::thread thread;
+        std::mutex mutex;
+        std::condition_variable cond;
+        std::vector<Job> inbox; //spawned but not yet picked up
+        EngineThreadStats stats;
+    };
+
+    void threadLoop(EngineThread &et);
+
+    std::vector<std::unique_ptr<EngineThread>> _threads;
+    size_t _nextThread;
+    std::atomic<bool> _stop;
+};
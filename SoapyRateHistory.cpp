@@ -0,0 +1,368 @@
+// Copyright (c) 2026 SoapySDR contributors
+// SPDX-License-Identifier: BSL-1.0
+
+#include "SoapyRateHistory.hpp"
+#include <SoapySDR/Version.hpp>
+#include <stdexcept>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+#include <ctime>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+#include <sys/utsname.h>
+
+static const char *STORE_HEADER = "# SoapySDRUtil rate test results v1\n";
+static const size_t RUN_FIELDS = 8;
+static const size_t STREAM_FIELDS = 19;
+
+/***********************************************************************
+ * Host metadata
+ **********************************************************************/
+static std::string cpuModel(void)
+{
+    std::ifstream cpuinfo("/proc/cpuinfo");
+    std::string line;
+    while (std::getline(cpuinfo, line))
+    {
+        if (line.compare(0, 10, "model name") != 0) continue;
+        const auto colon = line.find(':');
+        if (colon == std::string::npos) break;
+        const auto start = line.find_first_not_of(' ', colon + 1);
+        return (start == std::string::npos)?"":line.substr(start);
+    }
+    return "";
+}
+
+StoredRun currentStoredRun(void)
+{
+    StoredRun run;
+    run.unixTime = (long long)std::time(nullptr);
+    struct utsname uts;
+    if (uname(&uts) == 0)
+    {
+        run.host = uts.nodename;
+        run.kernel = std::string(uts.sysname) + " " + uts.release + " " + uts.machine;
+    }
+    run.cpu = cpuModel();
+    run.libVersion = SoapySDR::getLibVersion();
+    run.abiVersion = SoapySDR::getABIVersion();
+
+    char stamp[32];
+    const time_t now = time_t(run.unixTime);
+    struct tm utc;
+    gmtime_r(&now, &utc);
+    strftime(stamp, sizeof(stamp), "%Y%m%dT%H%M%S", &utc);
+    run.id = std::string(stamp);
+    run.id += "-" + run.host + "-" + std::to_string(getpid());
+    return run;
+}
+
+std::string StoredStream::key(const StoredRun &r) const
+{
+    std::ostringstream ss;
+    ss << r.host << "/" << driver << "/" << hardware << "/" << direction << "/" << format << "/"
+        << numChans << "/" << numElems << "/" << sampleRate;
+    return ss.str();
+}
+
+/***********************************************************************
+ * Line format
+ **********************************************************************/
+//fields are tab separated, so tabs and line breaks inside a field become spaces
+static std::string field(const std::string &str)
+{
+    std::string result(str);
+    for (auto &ch : result) if (ch == '\t' or ch == '\n' or ch == '\r') ch = ' ';
+    return result;
+}
+
+static std::string number(const double value)
+{
+    char buff[32];
+    snprintf(buff, sizeof(buff), "%.9g", value);
+    return buff;
+}
+
+static std::vector<std::string> splitFields(const std::string &line, const char sep)
+{
+    std::vector<std::string> fields;
+    size_t start(0);
+    while (true)
+    {
+        const auto end = line.find(sep, start);
+        fields.push_back(line.substr(start, end - start));
+        if (end == std::string::npos) return fields;
+        start = end + 1;
+    }
+}
+
+static void addField(std::string &out, const std::string &value)
+{
+    out += '\t';
+    out += value;
+}
+
+static void appendRun(std::string &out, const StoredRun &run)
+{
+    out += "run";
+    addField(out, field(run.id));
+    addField(out, std::to_string(run.unixTime));
+    addField(out, field(run.host));
+    addField(out, field(run.kernel));
+    addField(out, field(run.cpu));
+    addField(out, field(run.libVersion));
+    addField(out, field(run.abiVersion));
+    out += "\n";
+}
+
+static void appendStream(std::string &out, const StoredStream &s)
+{
+    out += "stream";
+    addField(out, field(s.run));
+    addField(out, field(s.device));
+    addField(out, field(s.driver));
+    addField(out, field(s.hardware));
+    addField(out, field(s.hardwareInfo));
+    addField(out, field(s.direction));
+    addField(out, field(s.format));
+    addField(out, std::to_string(s.numChans));
+    addField(out, std::to_string(s.numElems));
+    addField(out, number(s.sampleRate));
+    addField(out, number(s.rate));
+    addField(out, std::to_string(s.overflows));
+    addField(out, std::to_string(s.underflows));
+    addField(out, number(s.latencyP50));
+    addField(out, number(s.latencyP99));
+    addField(out, number(s.latencyP999));
+    addField(out, number(s.latencyMax));
+    out += "\t";
+    for (size_t i = 0; i < s.rateSamples.size(); i++)
+    {
+        if (i != 0) out += ",";
+        out += number(s.rateSamples[i]);
+    }
+    out += "\n";
+}
+
+static bool parseStream(const std::vector<std::string> &f, StoredStream &s)
+{
+    if (f.size() != STREAM_FIELDS) return false;
+    s.run = f[1];
+    s.device = f[2];
+    s.driver = f[3];
+    s.hardware = f[4];
+    s.hardwareInfo = f[5];
+    s.direction = f[6];
+    s.format = f[7];
+    s.numChans = std::strtoull(f[8].c_str(), nullptr, 10);
+    s.numElems = std::strtoull(f[9].c_str(), nullptr, 10);
+    s.sampleRate = std::strtod(f[10].c_str(), nullptr);
+    s.rate = std::strtod(f[11].c_str(), nullptr);
+    s.overflows = std::strtoull(f[12].c_str(), nullptr, 10);
+    s.underflows = std::strtoull(f[13].c_str(), nullptr, 10);
+    s.latencyP50 = std::strtod(f[14].c_str(), nullptr);
+    s.latencyP99 = std::strtod(f[15].c_str(), nullptr);
+    s.latencyP999 = std::strtod(f[16].c_str(), nullptr);
+    s.latencyMax = std::strtod(f[17].c_str(), nullptr);
+    if (not f[18].empty()) for (const auto &v : splitFields(f[18], ',')) s.rateSamples.push_back(std::strtod(v.c_str(), nullptr));
+    return true;
+}
+
+/***********************************************************************
+ * The store file
+ **********************************************************************/
+ResultsStore::ResultsStore(const std::string &path):
+    _path(path)
+{
+    return;
+}
+
+void ResultsStore::load(std::vector<StoredRun> &runs, std::vector<StoredStream> &streams) const
+{
+    std::ifstream in(_path);
+    std::string line;
+    while (std::getline(in, line))
+    {
+        if (line.empty() or line[0] == '#') continue;
+        const auto f = splitFields(line, '\t');
+        if (f[0] == "run" and f.size() == RUN_FIELDS)
+        {
+            StoredRun run;
+            run.id = f[1];
+            run.unixTime = std::strtoll(f[2].c_str(), nullptr, 10);
+            run.host = f[3];
+            run.kernel = f[4];
+            run.cpu = f[5];
+            run.libVersion = f[6];
+            run.abiVersion = f[7];
+            runs.push_back(run);
+        }
+        StoredStream s;
+        if (f[0] == "stream" and parseStream(f, s)) streams.push_back(s);
+    }
+}
+
+void ResultsStore::append(const StoredRun &run, const std::vector<StoredStream> &streams) const
+{
+    std::string out;
+    appendRun(out, run);
+    for (const auto &s : streams) appendStream(out, s);
+
+    const int fd = open(_path.c_str(), O_WRONLY | O_APPEND | O_CREAT | O_CLOEXEC, 0644);
+    if (fd < 0) throw std::runtime_error("results store " + _path + ": " + std::strerror(errno));
+    std::string error;
+    if (flock(fd, LOCK_EX) != 0) error = std::strerror(errno);
+
+    //a new file starts with the format header, checked under the lock
+    struct stat st;
+    if (error.empty() and fstat(fd, &st) == 0 and st.st_size == 0) out.insert(0, STORE_HEADER);
+    if (error.empty() and write(fd, out.data(), out.size()) != ssize_t(out.size())) error = std::strerror(errno);
+    close(fd);
+    if (not error.empty()) throw std::runtime_error("results store " + _path + ": " + error);
+}
+
+/***********************************************************************
+ * Significance tests
+ **********************************************************************/
+//continued fraction of the incomplete beta function, modified Lentz
+static double betaFraction(const double a, const double b, const double x)
+{
+    const double tiny = 1e-300;
+    double c = 1.0;
+    double d = 1.0 - (a + b)*x/(a + 1.0);
+    if (std::abs(d) < tiny) d = tiny;
+    d = 1.0/d;
+    double h = d;
+    for (int m = 1; m <= 300; m++)
+    {
+        const double m2 = 2.0*m;
+        double aa = m*(b - m)*x/((a - 1.0 + m2)*(a + m2));
+        d = 1.0 + aa*d;
+        if (std::abs(d) < tiny) d = tiny;
+        c = 1.0 + aa/c;
+        if (std::abs(c) < tiny) c = tiny;
+        d = 1.0/d;
+        h *= d*c;
+        aa = -(a + m)*(a + b + m)*x/((a + m2)*(a + 1.0 + m2));
+        d = 1.0 + aa*d;
+        if (std::abs(d) < tiny) d = tiny;
+        c = 1.0 + aa/c;
+        if (std::abs(c) < tiny) c = tiny;
+        d = 1.0/d;
+        const double del = d*c;
+        h *= del;
+        if (std::abs(del - 1.0) < 1e-14) break;
+    }
+    return h;
+}
+
+//regularized incomplete beta function I_x(a, b)
+static double incompleteBeta(const double a, const double b, const double x)
+{
+    if (x <= 0.0) return 0.0;
+    if (x >= 1.0) return 1.0;
+    const double front = std::exp(std::lgamma(a + b) - std::lgamma(a) - std::lgamma(b) + a*std::log(x) + b*std::log(1.0 - x));
+    if (x < (a + 1.0)/(a + b + 2.0)) return front*betaFraction(a, b, x)/a;
+    return 1.0 - front*betaFraction(b, a, 1.0 - x)/b;
+}
+
+//two sided p-value of Student's t
+static double studentP(const double t, const double df)
+{
+    return incompleteBeta(df/2.0, 0.5, df/(df + t*t));
+}
+
+static void meanVariance(const std::vector<double> &values, double &mean, double &variance)
+{
+    mean = variance = 0.0;
+    if (values.empty()) return;
+    for (const auto v : values) mean += v;
+    mean /= values.size();
+    if (values.size() < 2) return;
+    for (const auto v : values) variance += (v - mean)*(v - mean);
+    variance /= (values.size() - 1);
+}
+
+//a difference without any spread is certain, no difference is no evidence either way
+static double pFromT(const double diff, const double stdError, const double df)
+{
+    if (stdError <= 0.0) return (diff == 0.0)?1.0:0.0;
+    return studentP(diff/stdError, df);
+}
+
+//the new value as one more draw from the baseline runs
+static double predictionP(const double current, const std::vector<double> &baseline)
+{
+    double mean, variance;
+    meanVariance(baseline, mean, variance);
+    const double n = double(baseline.size());
+    return pFromT(current - mean, std::sqrt(variance*(1.0 + 1.0/n)), n - 1.0);
+}
+
+static double welchP(const std::vector<double> &a, const std::vector<double> &b)
+{
+    double ma, va, mb, vb;
+    meanVariance(a, ma, va);
+    meanVariance(b, mb, vb);
+    const double sa = va/a.size();
+    const double sb = vb/b.size();
+    const double se2 = sa + sb;
+    const double dfDen = sa*sa/(a.size() - 1.0) + sb*sb/(b.size() - 1.0);
+    const double df = (dfDen > 0.0)?(se2*se2/dfDen):(a.size() + b.size() - 2.0);
+    return pFromT(ma - mb, std::sqrt(se2), df);
+}
+
+std::vector<MetricChange> compareStream(
+    const StoredStream &current,
+    const std::vector<const StoredStream *> &baseline,
+    const double alpha,
+    const double minChange)
+{
+    struct Metric
+    {
+        const char *name;
+        double StoredStream::*value;
+        double scale;
+        bool higherIsBetter;
+    };
+    static const Metric metrics[] = {
+        {"rate Msps", &StoredStream::rate, 1e-6, true},
+        {"p50 call us", &StoredStream::latencyP50, 1.0, false},
+        {"p99 call us", &StoredStream::latencyP99, 1.0, false},
+        {"p99.9 call us", &StoredStream::latencyP999, 1.0, false},
+    };
+
+    std::vector<MetricChange> changes;
+    if (baseline.empty()) return changes;
+    for (const auto &m : metrics)
+    {
+        std::vector<double> values;
+        for (const auto *s : baseline) values.push_back(s->*m.value);
+        double mean, variance;
+        meanVariance(values, mean, variance);
+
+        MetricChange c;
+        c.metric = m.name;
+        c.baseline = mean*m.scale;
+        c.current = current.*m.value*m.scale;
+        c.change = (mean != 0.0)?((current.*m.value - mean)/mean):0.0;
+        c.p = -1.0;
+        if (values.size() >= 2) c.p = predictionP(current.*m.value, values);
+        else if (m.value == &StoredStream::rate and current.rateSamples.size() >= 2 and baseline.front()->rateSamples.size() >= 2)
+        {
+            c.p = welchP(current.rateSamples, baseline.front()->rateSamples);
+        }
+        c.significant = c.p >= 0.0 and c.p < alpha and std::abs(c.change) >= minChange;
+        c.worse = m.higherIsBetter?(c.change < 0.0):(c.change > 0.0);
+        changes.push_back(c);
+    }
+    return changes;
+}
@@ -0,0 +1,116 @@
+// Copyright (c) 2026 SoapySDR contributors
+// SPDX-License-Identifier: BSL-1.0
+
+#pragma once
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+/*!
+ * The host side of one stored rate test run.
+ */
+struct StoredRun
+{
+    std::string id; //unique per run, e.g. "20261014T101500-host-1234"
+    long long unixTime = 0;
+    std::string host;
+    std::string kernel;
+    std::string cpu;
+    std::string libVersion; //SoapySDR::getLibVersion()
+    std::string abiVersion;
+};
+
+//! The run about to be stored, with the metadata of this host
+StoredRun currentStoredRun(void);
+
+/*!
+ * The final results of one stream of a stored run.
+ */
+struct StoredStream
+{
+    std::string run; //id of the StoredRun
+    std::string device; //the device label
+    std::string driver;
+    std::string hardware; //getHardwareKey()
+    std::string hardwareInfo; //getHardwareInfo() as a markup string
+    std::string direction; //"RX" or "TX"
+    std::string format;
+    size_t numChans = 0;
+    size_t numElems = 0;
+    double sampleRate = 0.0; //configured samples per second
+    double rate = 0.0; //measured samples per second
+    unsigned long long overflows = 0;
+    unsigned long long underflows = 0;
+    double latencyP50 = 0.0; //stream call latency in microseconds
+    double latencyP99 = 0.0;
+    double latencyP999 = 0.0;
+    double latencyMax = 0.0;
+    std::vector<double> rateSamples; //measured samples per second over each second
+
+    //! Streams with the same key measured the same thing and can be compared
+    std::string key(const StoredRun &run) const;
+};
+
+/*!
+ * An append-only file of rate test results.
+ *
+ * Every run is one "run" line with the host metadata followed by one "stream"
+ * line per stream, tab separated. A run is appended with one write under an
+ * exclusive lock, so runs of several processes never interleave.
+ */
+class ResultsStore
+{
+public:
+    explicit ResultsStore(const std::string &path);
+
+    const std::string &path(void) const
+    {
+        return _path;
+    }
+
+    /*!
+     * Every run and stream stored so far, in the order they were appended.
+     * A missing file is an empty store, lines which do not parse are skipped.
+     */
+    void load(std::vector<StoredRun> &runs, std::vector<StoredStream> &streams) const;
+
+    //! \throws std::runtime_error when the file cannot be written
+    void append(const StoredRun &run, const std::vector<StoredStream> &streams) const;
+
+private:
+    const std::string _path;
+};
+
+/*!
+ * One metric of a stream against its baseline.
+ */
+struct MetricChange
+{
+    std::string metric; //e.g. "rate Msps"
+    double baseline; //mean over the baseline runs
+    double current;
+    double change; //relative, positive means larger
+    double p; //two sided p-value, negative when there is nothing to test against
+    bool significant; //p below the level and a change large enough to matter
+    bool worse; //the change is a regression
+};
+
+/*!
+ * Compare a stream with the same stream of earlier runs.
+ *
+ * With two or more baseline runs every metric is tested as a new observation
+ * against the spread between the runs, a Student t prediction interval. With a
+ * single baseline run only the rate can be tested, with Welch's t-test over the
+ * per second samples of both runs.
+ *
+ * \param current the stream of this run
+ * \param baseline earlier streams with the same key
+ * \param alpha significance level
+ * \param minChange smallest relative change reported as significant
+ */
+std::vector<MetricChange> compareStream(
+    const StoredStream &current,
+    const std::vector<const StoredStream *> &baseline,
+    const double alpha,
+    const double minChange);
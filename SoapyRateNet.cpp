@@ -0,0 +1,517 @@
+// Copyright (c) 2026 SoapySDR contributors
+// SPDX-License-Identifier: BSL-1.0
+
+#include "SoapyRateNet.hpp"
+#include "SoapyRateAlloc.hpp"
+#include "SoapyRateProfile.hpp"
+#include <stdexcept>
+#include <algorithm>
+#include <random>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+#include <ctime>
+#include <unistd.h>
+#include <poll.h>
+#include <netdb.h>
+#include <arpa/inet.h>
+
+static const uint32_t NET_MAGIC_DATA = 0x534e5444; //"SNTD"
+static const uint32_t NET_MAGIC_REPORT = 0x534e5452; //"SNTR"
+static const size_t NET_BATCH = 64; //datagrams per sendmmsg and recvmmsg
+static const size_t NET_MAX_DATAGRAM = 65507; //largest UDP payload over IPv4
+static const int NET_SOCKET_BUFFER = 32 << 20; //asked for, the kernel caps it at rmem_max and wmem_max
+static const int64_t NET_REPORT_NS = 1000000000LL; //the receiver reports to the sink this often
+static const int64_t NET_PRINT_NS = 5000000000LL;
+static const int NET_FINAL_REPORT_MS = 1500; //how long a stopped sink waits for the report of its last packets
+
+static_assert(sizeof(NetPacketHeader) == 48, "the header is the wire format");
+
+static inline int64_t realtimeNs(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return int64_t(ts.tv_sec)*1000000000LL + ts.tv_nsec;
+}
+
+//"host:port", "[v6 host]:port", or only the port when the host is optional
+static void splitHostPort(const std::string &spec, std::string &host, std::string &port)
+{
+    const auto colon = spec.rfind(':');
+    if (colon == std::string::npos)
+    {
+        host.clear();
+        port = spec;
+        return;
+    }
+    host = spec.substr(0, colon);
+    port = spec.substr(colon + 1);
+    if (host.size() >= 2 and host.front() == '[' and host.back() == ']') host = host.substr(1, host.size() - 2);
+}
+
+static int openUdpSocket(const std::string &spec, const bool passive, struct sockaddr_storage &addr, socklen_t &addrLen)
+{
+    std::string host, port;
+    splitHostPort(spec, host, port);
+    if (port.empty() or (host.empty() and not passive)) throw std::runtime_error("expected host:port, got " + spec);
+
+    struct addrinfo hints;
+    std::memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_DGRAM;
+    hints.ai_flags = passive?AI_PASSIVE:0;
+    struct addrinfo *result(nullptr);
+    const int ret = getaddrinfo(host.empty()?nullptr:host.c_str(), port.c_str(), &hints, &result);
+    if (ret != 0) throw std::runtime_error(spec + ": " + gai_strerror(ret));
+
+    int fd(-1);
+    for (auto *ai = result; ai != nullptr and fd < 0; ai = ai->ai_next)
+    {
+        fd = socket(ai->ai_family, ai->ai_socktype | SOCK_CLOEXEC, ai->ai_protocol);
+        if (fd < 0) continue;
+        std::memcpy(&addr, ai->ai_addr, ai->ai_addrlen);
+        addrLen = ai->ai_addrlen;
+    }
+    freeaddrinfo(result);
+    if (fd < 0) throw std::runtime_error(spec + ": " + std::strerror(errno));
+    return fd;
+}
+
+//a buffer below the request drops bursts inside the host, which the loss numbers would blame on the network
+static void requestSocketBuffer(const int fd, const int option, const char *name)
+{
+    if (setsockopt(fd, SOL_SOCKET, option, &NET_SOCKET_BUFFER, sizeof(NET_SOCKET_BUFFER)) != 0)
+    {
+        fprintf(stderr, "Warning: %s of %d bytes failed: %s\n", name, NET_SOCKET_BUFFER, std::strerror(errno));
+        return;
+    }
+
+    //linux reports twice the usable size, the doubled part is its bookkeeping
+    int granted(0);
+    socklen_t len(sizeof(granted));
+    if (getsockopt(fd, SOL_SOCKET, option, &granted, &len) == 0 and granted/2 < NET_SOCKET_BUFFER)
+    {
+        fprintf(stderr, "Warning: %s capped at %d of %d bytes, raise net.core.%s\n", name, granted/2, NET_SOCKET_BUFFER,
+            (option == SO_SNDBUF)?"wmem_max":"rmem_max");
+    }
+}
+
+static std::string addressName(const struct sockaddr_storage &addr)
+{
+    char host[NI_MAXHOST], port[NI_MAXSERV];
+    if (getnameinfo(reinterpret_cast<const struct sockaddr *>(&addr), sizeof(addr), host, sizeof(host),
+        port, sizeof(port), NI_NUMERICHOST | NI_NUMERICSERV) != 0) return "unknown";
+    return std::string(host) + ":" + port;
+}
+
+/***********************************************************************
+ * Sink: RX blocks out through sendmmsg
+ **********************************************************************/
+NetSink::NetSink(const std::string &dest, const size_t payload, BlockRing &ring, const size_t consumer, const size_t elemSize):
+    _dest(dest),
+    _payload(std::max(elemSize, payload - payload%elemSize)),
+    _ring(ring),
+    _consumer(consumer),
+    _elemSize(elemSize),
+    _session(std::random_device()() | (uint64_t(std::random_device()()) << 32)),
+    _fd(-1),
+    _headers(NET_BATCH),
+    _iov(2*NET_BATCH),
+    _msgs(NET_BATCH),
+    _seq(0),
+    _done(false),
+    _packets(0),
+    _bytes(0),
+    _batches(0),
+    _sendErrors(0),
+    _haveReport(false)
+{
+    if (_payload + sizeof(NetPacketHeader) > NET_MAX_DATAGRAM) throw std::runtime_error("network payload over the largest datagram");
+
+    //connected, so the kernel only hands back the reports of this peer
+    struct sockaddr_storage addr;
+    socklen_t addrLen(0);
+    _fd = openUdpSocket(dest, false, addr, addrLen);
+    if (connect(_fd, reinterpret_cast<const struct sockaddr *>(&addr), addrLen) != 0)
+    {
+        const std::string error = std::strerror(errno);
+        close(_fd);
+        throw std::runtime_error(dest + ": " + error);
+    }
+    requestSocketBuffer(_fd, SO_SNDBUF, "SO_SNDBUF");
+
+    //every datagram is its header followed by a slice of a ring slot
+    std::memset(_msgs.data(), 0, _msgs.size()*sizeof(_msgs[0]));
+    std::memset(&_report, 0, sizeof(_report));
+    for (size_t i = 0; i < NET_BATCH; i++)
+    {
+        _iov[2*i].iov_base = &_headers[i];
+        _iov[2*i].iov_len = sizeof(NetPacketHeader);
+        _msgs[i].msg_hdr.msg_iov = &_iov[2*i];
+        _msgs[i].msg_hdr.msg_iovlen = 2;
+    }
+    _thread = std::thread(&NetSink::senderLoop, this);
+}
+
+NetSink::~NetSink(void)
+{
+    this->stop();
+    if (_fd >= 0) close(_fd);
+}
+
+void NetSink::stop(void)
+{
+    _done = true;
+    if (_thread.joinable()) _thread.join();
+}
+
+bool NetSink::peerReport(NetPeerReport &report) const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    report = _report;
+    return _haveReport;
+}
+
+std::string NetSink::error(void) const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _error;
+}
+
+void NetSink::senderLoop(void)
+{
+    SteadyStateAllocations allocs("net sink");
+    ThreadProfile prof("net sink");
+    const size_t numChans = _ring.numChans();
+    while (true)
+    {
+        BlockRing::BlockInfo info;
+        void * const *slot = _ring.readSlot(_consumer, info);
+        if (slot == nullptr)
+        {
+            if (_done) break;
+            this->pollReports(0);
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+            prof.lap(PROFILE_IDLE);
+            continue;
+        }
+        prof.lap(PROFILE_HANDOFF);
+
+        const size_t chanBytes = info.numElems*_elemSize;
+        size_t n(0);
+        for (size_t c = 0; c < numChans; c++)
+        {
+            for (size_t offset = 0; offset < chanBytes; offset += _payload)
+            {
+                auto &h = _headers[n];
+                h.magic = NET_MAGIC_DATA;
+                h.chan = uint16_t(c);
+                h.numChans = uint16_t(numChans);
+                h.elemSize = uint32_t(_elemSize);
+                h.bytes = uint32_t(std::min(_payload, chanBytes - offset));
+                h.session = _session;
+                h.seq = _seq++;
+                _iov[2*n + 1].iov_base = static_cast<char *>(slot[c]) + offset;
+                _iov[2*n + 1].iov_len = h.bytes;
+                if (++n == NET_BATCH)
+                {
+                    this->flush(info, n);
+                    n = 0;
+                }
+            }
+        }
+        if (n != 0) this->flush(info, n);
+        prof.lap(PROFILE_PROCESSING);
+        _ring.release(_consumer);
+        prof.lap(PROFILE_HANDOFF);
+        this->pollReports(0);
+        prof.lap(PROFILE_STATUS_POLL);
+        allocs.begin();
+    }
+    allocs.end();
+    prof.end();
+
+    //the peer reports once a second, wait for the one which covers the last packet
+    const int64_t deadline = steadyNs() + int64_t(NET_FINAL_REPORT_MS)*1000000;
+    while (_seq != 0 and steadyNs() < deadline)
+    {
+        this->pollReports(50);
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_haveReport and _report.expected >= _seq) break;
+    }
+}
+
+void NetSink::flush(const BlockRing::BlockInfo &info, const size_t numPackets)
+{
+    const int64_t sendNs = realtimeNs();
+    const int64_t residencyNs = std::max<int64_t>(0, steadyNs() - info.hostNs);
+    for (size_t i = 0; i < numPackets; i++)
+    {
+        _headers[i].sendNs = sendNs;
+        _headers[i].residencyNs = residencyNs;
+    }
+    _residency.record(uint64_t(residencyNs));
+
+    size_t sent(0);
+    while (sent < numPackets)
+    {
+        const int ret = sendmmsg(_fd, _msgs.data() + sent, unsigned(numPackets - sent), 0);
+        _batches.store(_batches.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        if (ret < 0)
+        {
+            if (errno == EINTR) continue;
+
+            //the datagram at the front was refused, count it and carry on with the rest
+            _sendErrors.store(_sendErrors.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            const char *error = std::strerror(errno);
+            std::lock_guard<std::mutex> lock(_mutex);
+            _error = error;
+            sent++;
+            continue;
+        }
+        uint64_t bytes(0);
+        for (size_t i = sent; i < sent + size_t(ret); i++) bytes += _headers[i].bytes;
+        _bytes.store(_bytes.load(std::memory_order_relaxed) + bytes, std::memory_order_relaxed);
+        _packets.store(_packets.load(std::memory_order_relaxed) + ret, std::memory_order_relaxed);
+        sent += ret;
+    }
+}
+
+void NetSink::pollReports(const int timeoutMs)
+{
+    struct pollfd pfd = {_fd, POLLIN, 0};
+    if (timeoutMs > 0 and poll(&pfd, 1, timeoutMs) <= 0) return;
+    NetPeerReport report;
+    while (true)
+    {
+        //a refused earlier datagram shows up here as an error, it was counted when sent
+        const ssize_t ret = recv(_fd, &report, sizeof(report), MSG_DONTWAIT);
+        if (ret < 0 and errno == ECONNREFUSED) continue;
+        if (ret < 0) return;
+        if (size_t(ret) != sizeof(report) or report.magic != NET_MAGIC_REPORT or report.session != _session) continue;
+        std::lock_guard<std::mutex> lock(_mutex);
+        _report = report;
+        _haveReport = true;
+    }
+}
+
+/***********************************************************************
+ * Receive mode: recvmmsg with kernel timestamps
+ **********************************************************************/
+static std::atomic<bool> receiveDone(false);
+static void sigIntHandler(const int)
+{
+    receiveDone = true;
+}
+
+struct ReceiveSession
+{
+    uint64_t session = 0;
+    struct sockaddr_storage peer;
+    socklen_t peerLen = 0;
+    unsigned numChans = 0;
+    unsigned elemSize = 0;
+    int64_t firstNs = 0; //steady time of the first and the latest packet
+    int64_t lastNs = 0;
+    uint64_t firstSeq = 0;
+    uint64_t expected = 0;
+    uint64_t received = 0;
+    uint64_t bytes = 0;
+    uint64_t reordered = 0;
+    uint64_t skewed = 0; //packets which arrived before they were sent, the clocks disagree
+    LatencyHistogram network;
+    LatencyHistogram socket;
+    LatencyHistogram residency;
+
+    double elapsed(void) const
+    {
+        return (lastNs - firstNs)/1e9;
+    }
+
+    uint64_t lost(void) const
+    {
+        const uint64_t span = expected - firstSeq;
+        return (span > received)?(span - received):0;
+    }
+};
+
+static void sendReport(const int fd, const ReceiveSession &s)
+{
+    NetPeerReport r;
+    std::memset(&r, 0, sizeof(r));
+    r.magic = NET_MAGIC_REPORT;
+    r.session = s.session;
+    r.firstSeq = s.firstSeq;
+    r.expected = s.expected;
+    r.received = s.received;
+    r.bytes = s.bytes;
+    r.reordered = s.reordered;
+    r.elapsed = s.elapsed();
+    r.networkP50Ns = s.network.percentile(50);
+    r.networkP99Ns = s.network.percentile(99);
+    r.networkMaxNs = s.network.max();
+    r.socketP99Ns = s.socket.percentile(99);
+    //best effort, a report which does not go out is replaced by the next one a second later
+    (void)sendto(fd, &r, sizeof(r), MSG_DONTWAIT, reinterpret_cast<const struct sockaddr *>(&s.peer), s.peerLen);
+}
+
+static void printSession(const char *prefix, const ReceiveSession &s)
+{
+    const double elapsed = s.elapsed();
+    const double mbps = (elapsed > 0.0)?(s.bytes/elapsed/1e6):0.0;
+    const double msps = (s.numChans == 0 or s.elemSize == 0)?0.0:(mbps/(s.numChans*s.elemSize));
+    const uint64_t span = s.expected - s.firstSeq;
+    printf("%s%g MBps\t%g Msps x%u\tpackets %llu\tlost %llu (%.4f%%)\treordered %llu\tnetwork us p50 %.1f p99 %.1f max %.1f\tsocket p99 %.1f us\tring p99 %.1f us\n",
+        prefix, mbps, msps, s.numChans, (unsigned long long)s.received, (unsigned long long)s.lost(),
+        (span != 0)?(100.0*s.lost()/span):0.0, (unsigned long long)s.reordered,
+        s.network.percentile(50)/1e3, s.network.percentile(99)/1e3, s.network.max()/1e3,
+        s.socket.percentile(99)/1e3, s.residency.percentile(99)/1e3);
+    fflush(stdout);
+}
+
+int SoapySDRNetReceive(const std::string &bind, const double duration)
+{
+    int fd(-1);
+    try
+    {
+        struct sockaddr_storage addr;
+        socklen_t addrLen(0);
+        fd = openUdpSocket(bind, true, addr, addrLen);
+        if (::bind(fd, reinterpret_cast<const struct sockaddr *>(&addr), addrLen) != 0) throw std::runtime_error(bind + ": " + std::strerror(errno));
+        requestSocketBuffer(fd, SO_RCVBUF, "SO_RCVBUF");
+        const int on(1);
+        const bool stamps = setsockopt(fd, SOL_SOCKET, SO_TIMESTAMPNS, &on, sizeof(on)) == 0;
+        const struct timeval wait = {0, 100000};
+        if (setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &wait, sizeof(wait)) != 0) throw std::runtime_error(std::string("SO_RCVTIMEO: ") + std::strerror(errno));
+
+        //one buffer, address and control block per datagram of a batch
+        std::vector<char> buffers(NET_BATCH*NET_MAX_DATAGRAM);
+        std::vector<struct iovec> iov(NET_BATCH);
+        std::vector<struct mmsghdr> msgs(NET_BATCH);
+        std::vector<struct sockaddr_storage> names(NET_BATCH);
+        const size_t controlLen = CMSG_SPACE(sizeof(struct timespec));
+        std::vector<char> control(NET_BATCH*controlLen);
+        std::memset(msgs.data(), 0, msgs.size()*sizeof(msgs[0]));
+        for (size_t i = 0; i < NET_BATCH; i++)
+        {
+            iov[i].iov_base = buffers.data() + i*NET_MAX_DATAGRAM;
+            iov[i].iov_len = NET_MAX_DATAGRAM;
+            msgs[i].msg_hdr.msg_iov = &iov[i];
+            msgs[i].msg_hdr.msg_iovlen = 1;
+        }
+
+        printf("Receiving on %s, %s\n", addressName(addr).c_str(),
+            stamps?"kernel timestamps split the network and socket latency":"no kernel timestamps, the socket latency is part of the network");
+        printf("Network latency compares the clocks of both hosts, it needs PTP or NTP across hosts\n");
+        fflush(stdout);
+        signal(SIGINT, sigIntHandler);
+
+        ReceiveSession s;
+        uint64_t badPackets(0);
+        const int64_t startNs = steadyNs();
+        int64_t lastReportNs(startNs), lastPrintNs(startNs);
+        while (not receiveDone)
+        {
+            const int64_t nowNs = steadyNs();
+            if (duration > 0.0 and nowNs - startNs >= int64_t(duration*1e9)) break;
+            if (s.received != 0 and nowNs - lastReportNs >= NET_REPORT_NS)
+            {
+                sendReport(fd, s);
+                lastReportNs = nowNs;
+            }
+            if (s.received != 0 and nowNs - lastPrintNs >= NET_PRINT_NS)
+            {
+                printSession("", s);
+                lastPrintNs = nowNs;
+            }
+
+            for (size_t i = 0; i < NET_BATCH; i++)
+            {
+                msgs[i].msg_hdr.msg_name = &names[i];
+                msgs[i].msg_hdr.msg_namelen = sizeof(names[i]);
+                msgs[i].msg_hdr.msg_control = control.data() + i*controlLen;
+                msgs[i].msg_hdr.msg_controllen = controlLen;
+            }
+            const int n = recvmmsg(fd, msgs.data(), unsigned(NET_BATCH), MSG_WAITFORONE, nullptr);
+            const int64_t appNs = realtimeNs();
+            const int64_t arrivalNs = steadyNs();
+            if (n < 0)
+            {
+                if (errno == EAGAIN or errno == EWOULDBLOCK or errno == EINTR) continue;
+                throw std::runtime_error(std::string("recvmmsg: ") + std::strerror(errno));
+            }
+
+            for (int i = 0; i < n; i++)
+            {
+                NetPacketHeader h;
+                if (msgs[i].msg_len < sizeof(h))
+                {
+                    badPackets++;
+                    continue;
+                }
+                std::memcpy(&h, iov[i].iov_base, sizeof(h));
+                if (h.magic != NET_MAGIC_DATA or sizeof(h) + h.bytes != msgs[i].msg_len)
+                {
+                    badPackets++;
+                    continue;
+                }
+
+                //a new sink starts over, the summary covers the last session
+                if (h.session != s.session)
+                {
+                    if (s.received != 0) printSession("Session ended: ", s);
+                    s = ReceiveSession();
+                    s.session = h.session;
+                    s.peer = names[i];
+                    s.peerLen = msgs[i].msg_hdr.msg_namelen;
+                    s.numChans = h.numChans;
+                    s.elemSize = h.elemSize;
+                    s.firstNs = arrivalNs;
+                    s.firstSeq = s.expected = h.seq;
+                    printf("Session %016llx from %s: %u channel%s, %u byte elements\n", (unsigned long long)h.session,
+                        addressName(s.peer).c_str(), h.numChans, (h.numChans == 1)?"":"s", h.elemSize);
+                    fflush(stdout);
+                }
+
+                int64_t kernelNs(appNs);
+                auto *msg = &msgs[i].msg_hdr;
+                for (auto *cmsg = CMSG_FIRSTHDR(msg); cmsg != nullptr; cmsg = CMSG_NXTHDR(msg, cmsg))
+                {
+                    if (cmsg->cmsg_level != SOL_SOCKET or cmsg->cmsg_type != SCM_TIMESTAMPNS) continue;
+                    struct timespec ts;
+                    std::memcpy(&ts, CMSG_DATA(cmsg), sizeof(ts));
+                    kernelNs = int64_t(ts.tv_sec)*1000000000LL + ts.tv_nsec;
+                }
+                if (kernelNs >= h.sendNs) s.network.record(uint64_t(kernelNs - h.sendNs));
+                else s.skewed++;
+                s.socket.record(uint64_t(std::max<int64_t>(0, appNs - kernelNs)));
+                s.residency.record(uint64_t(std::max<int64_t>(0, h.residencyNs)));
+
+                s.received++;
+                s.bytes += h.bytes;
+                s.lastNs = arrivalNs;
+                if (h.seq >= s.expected) s.expected = h.seq + 1;
+                else s.reordered++;
+            }
+        }
+
+        if (s.received != 0) sendReport(fd, s);
+        printf("\nNet receive summary:\n");
+        if (s.received == 0) printf("  no packets received\n");
+        else printSession("  ", s);
+        if (s.skewed != 0) printf("  %llu packets arrived before their send time, the host clocks are not synchronized\n", (unsigned long long)s.skewed);
+        if (badPackets != 0) printf("  %llu datagrams were not from a net sink\n", (unsigned long long)badPackets);
+        fflush(stdout);
+        close(fd);
+        return (s.received != 0 and s.lost() == 0)?EXIT_SUCCESS:EXIT_FAILURE;
+    }
+    catch (const std::exception &ex)
+    {
+        fprintf(stderr, "Error in net receive: %s\n", ex.what());
+        if (fd >= 0) close(fd);
+        return EXIT_FAILURE;
+    }
+}
@@ -0,0 +1,160 @@
+// Copyright (c) 2026 SoapySDR contributors
+// SPDX-License-Identifier: BSL-1.0
+
+#pragma once
+#include "SoapyRateBuffers.hpp"
+#include "SoapyRateStats.hpp"
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <cstddef>
+#include <cstdint>
+#include <sys/socket.h>
+#include <sys/uio.h>
+
+/*!
+ * Every datagram of the network sink starts with this header, in host byte
+ * order, followed by bytes of one channel of one RX block.
+ */
+struct NetPacketHeader
+{
+    uint32_t magic;
+    uint16_t chan;
+    uint16_t numChans;
+    uint32_t elemSize;
+    uint32_t bytes; //payload after the header
+    uint64_t session; //random per sink, a new session resets the receiver
+    uint64_t seq; //packet number within the session
+    int64_t sendNs; //CLOCK_REALTIME when the batch was handed to the kernel
+    int64_t residencyNs; //from the RX commit until the send
+};
+
+/*!
+ * What the receiver has seen of one session, sent back to the sink once a second.
+ */
+struct NetPeerReport
+{
+    uint32_t magic;
+    uint32_t reserved;
+    uint64_t session;
+    uint64_t firstSeq; //the first packet the receiver saw
+    uint64_t expected; //highest sequence number plus one
+    uint64_t received; //packets
+    uint64_t bytes;
+    uint64_t reordered;
+    double elapsed; //seconds from the first to the last packet
+    uint64_t networkP50Ns; //kernel receive time minus the send time, needs synchronized clocks across hosts
+    uint64_t networkP99Ns;
+    uint64_t networkMaxNs;
+    uint64_t socketP99Ns; //from the kernel receive time until the receiver read the packet
+};
+
+/*!
+ * Network stage which forwards every RX block to a peer over UDP.
+ *
+ * Each channel of a block is cut into datagrams of at most payload bytes.
+ * The datagrams of a block go out in batches through sendmmsg, their iovecs
+ * point into the ring slot so no sample is copied in user space. The peer,
+ * the tool in --netSource mode, reports what it received once a second, the
+ * last report gives the end to end rate, the loss and the network latency.
+ */
+class NetSink
+{
+public:
+    /*!
+     * \param dest the peer as host:port
+     * \param payload most sample bytes per datagram
+     * \param ring the source ring
+     * \param consumer this stage's consumer index in the ring
+     * \param elemSize bytes per element
+     * \throws std::runtime_error when the peer cannot be resolved or the socket fails
+     */
+    NetSink(const std::string &dest, const size_t payload, BlockRing &ring, const size_t consumer, const size_t elemSize);
+
+    ~NetSink(void);
+
+    //! Send what is left in the ring, wait briefly for the final report, then stop the thread
+    void stop(void);
+
+    const std::string &dest(void) const
+    {
+        return _dest;
+    }
+
+    size_t payload(void) const
+    {
+        return _payload;
+    }
+
+    uint64_t packetsSent(void) const
+    {
+        return _packets.load(std::memory_order_relaxed);
+    }
+
+    uint64_t bytesSent(void) const
+    {
+        return _bytes.load(std::memory_order_relaxed);
+    }
+
+    //! sendmmsg calls
+    uint64_t batches(void) const
+    {
+        return _batches.load(std::memory_order_relaxed);
+    }
+
+    //! Datagrams the kernel refused, e.g. while the peer was not listening
+    uint64_t sendErrors(void) const
+    {
+        return _sendErrors.load(std::memory_order_relaxed);
+    }
+
+    //! From the RX commit until the block was sent, valid once stopped
+    const LatencyHistogram &residency(void) const
+    {
+        return _residency;
+    }
+
+    //! The latest report of the peer, false when none arrived
+    bool peerReport(NetPeerReport &report) const;
+
+    //! The last send error, empty when there was none
+    std::string error(void) const;
+
+private:
+    void senderLoop(void);
+    void flush(const BlockRing::BlockInfo &info, const size_t numPackets);
+    void pollReports(const int timeoutMs);
+
+    const std::string _dest;
+    const size_t _payload;
+    BlockRing &_ring;
+    const size_t _consumer;
+    const size_t _elemSize;
+    const uint64_t _session;
+    int _fd;
+    std::vector<NetPacketHeader> _headers;
+    std::vector<struct iovec> _iov;
+    std::vector<struct mmsghdr> _msgs;
+    uint64_t _seq;
+    LatencyHistogram _residency;
+    std::atomic<bool> _done;
+    std::atomic<uint64_t> _packets;
+    std::atomic<uint64_t> _bytes;
+    std::atomic<uint64_t> _batches;
+    std::atomic<uint64_t> _sendErrors;
+    mutable std::mutex _mutex;
+    bool _haveReport;
+    NetPeerReport _report;
+    std::string _error;
+    std::thread _thread;
+};
+
+/*!
+ * Receive mode: count and time the datagrams of a NetSink until SIGINT or the duration.
+ * \param bind the local [host:]port
+ * \param duration seconds to run, 0 until SIGINT
+ * \return EXIT_SUCCESS when packets were received without loss
+ */
+int SoapySDRNetReceive(const std::string &bind, const double duration);
@@ -0,0 +1,165 @@
+// Copyright (c) 2026 SoapySDR contributors
+// SPDX-License-Identifier: BSL-1.0
+
+#include "SoapyRateProfile.hpp"
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <cstring>
+#include <cerrno>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+
+static const auto TSC_CALIBRATION = std::chrono::milliseconds(50);
+
+static std::atomic<bool> profiling(false);
+static std::atomic<double> ticksPerSecond(0.0);
+
+const char *profilePhaseName(const int phase)
+{
+    switch (phase)
+    {
+    case PROFILE_SCHEDULING: return "scheduling";
+    case PROFILE_STREAM_CALL: return "stream call";
+    case PROFILE_STATUS_POLL: return "status poll";
+    case PROFILE_ACCOUNTING: return "accounting";
+    case PROFILE_HANDOFF: return "ring handoff";
+    case PROFILE_PROCESSING: return "processing";
+    case PROFILE_IDLE: return "idle";
+    }
+    return "unknown";
+}
+
+const char *perfCounterName(const int counter)
+{
+    switch (counter)
+    {
+    case PERF_CACHE_MISSES: return "cache misses";
+    case PERF_CONTEXT_SWITCHES: return "context switches";
+    case PERF_PAGE_FAULTS: return "page faults";
+    }
+    return "unknown";
+}
+
+/***********************************************************************
+ * Cycle counter calibration
+ **********************************************************************/
+void enableProfile(void)
+{
+    if (profiling.exchange(true)) return;
+
+    //the counter runs at a fixed rate on every current x86, measure it against the steady clock
+    #if defined(__x86_64__) || defined(__i386__)
+    const auto t0 = std::chrono::steady_clock::now();
+    const uint64_t c0 = profileTicks();
+    std::this_thread::sleep_for(TSC_CALIBRATION);
+    const auto t1 = std::chrono::steady_clock::now();
+    const uint64_t c1 = profileTicks();
+    ticksPerSecond = double(c1 - c0)/std::chrono::duration<double>(t1 - t0).count();
+    #else
+    typedef std::chrono::steady_clock::period period;
+    ticksPerSecond = double(period::den)/period::num;
+    #endif
+}
+
+bool profileEnabled(void)
+{
+    return profiling.load(std::memory_order_relaxed);
+}
+
+double profileTicksPerSecond(void)
+{
+    return ticksPerSecond.load(std::memory_order_relaxed);
+}
+
+/***********************************************************************
+ * Per thread perf_event counters
+ **********************************************************************/
+static int openPerfCounter(const int counter, bool &userOnly)
+{
+    struct perf_event_attr attr;
+    std::memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    switch (counter)
+    {
+    case PERF_CACHE_MISSES:
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = PERF_COUNT_HW_CACHE_MISSES;
+        break;
+    case PERF_CONTEXT_SWITCHES:
+        attr.type = PERF_TYPE_SOFTWARE;
+        attr.config = PERF_COUNT_SW_CONTEXT_SWITCHES;
+        break;
+    case PERF_PAGE_FAULTS:
+        attr.type = PERF_TYPE_SOFTWARE;
+        attr.config = PERF_COUNT_SW_PAGE_FAULTS;
+        break;
+    }
+    attr.exclude_hv = 1;
+
+    //the calling thread on any cpu, a restrictive perf_event_paranoid still allows user space only
+    userOnly = false;
+    int fd = int(syscall(SYS_perf_event_open, &attr, 0, -1, -1, PERF_FLAG_FD_CLOEXEC));
+    if (fd < 0 and (errno == EACCES or errno == EPERM))
+    {
+        attr.exclude_kernel = 1;
+        userOnly = true;
+        fd = int(syscall(SYS_perf_event_open, &attr, 0, -1, -1, PERF_FLAG_FD_CLOEXEC));
+    }
+    return fd;
+}
+
+/***********************************************************************
+ * Profile scopes and their results
+ **********************************************************************/
+static std::mutex profilesMutex;
+static std::vector<ThreadProfileResult> profiles;
+
+ThreadProfile::ThreadProfile(const std::string &thread):
+    _enabled(profileEnabled()),
+    _ended(false),
+    _last(0)
+{
+    _result.thread = thread;
+    for (int p = 0; p < NUM_PROFILE_PHASES; p++) _result.ticks[p] = _result.laps[p] = 0;
+    for (int c = 0; c < NUM_PERF_COUNTERS; c++)
+    {
+        _perfFds[c] = -1;
+        _result.perfValid[c] = _result.perfUserOnly[c] = false;
+        _result.perf[c] = 0;
+        if (not _enabled) continue;
+        _perfFds[c] = openPerfCounter(c, _result.perfUserOnly[c]);
+        if (_perfFds[c] < 0 and _result.perfError.empty()) _result.perfError = std::string(perfCounterName(c)) + " unavailable, " + std::strerror(errno);
+    }
+    _last = profileTicks();
+}
+
+ThreadProfile::~ThreadProfile(void)
+{
+    this->end();
+}
+
+void ThreadProfile::end(void)
+{
+    if (_ended or not _enabled) return;
+    _ended = true;
+    for (int c = 0; c < NUM_PERF_COUNTERS; c++)
+    {
+        if (_perfFds[c] < 0) continue;
+        uint64_t value(0);
+        _result.perfValid[c] = read(_perfFds[c], &value, sizeof(value)) == ssize_t(sizeof(value));
+        _result.perf[c] = value;
+        close(_perfFds[c]);
+        _perfFds[c] = -1;
+    }
+    std::lock_guard<std::mutex> lock(profilesMutex);
+    profiles.push_back(_result);
+}
+
+std::vector<ThreadProfileResult> threadProfiles(void)
+{
+    std::lock_guard<std::mutex> lock(profilesMutex);
+    return profiles;
+}
@@ -0,0 +1,125 @@
+// Copyright (c) 2026 SoapySDR contributors
+// SPDX-License-Identifier: BSL-1.0
+
+#pragma once
+#include <string>
+#include <vector>
+#include <cstdint>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#else
+#include <chrono>
+#endif
+
+/*!
+ * Where a profiled loop spends its time.
+ */
+enum ProfilePhase
+{
+    PROFILE_SCHEDULING, //between two passes of the loop, on the coroutine engine waiting for the turn
+    PROFILE_STREAM_CALL, //inside the driver's stream calls
+    PROFILE_STATUS_POLL, //control flags and stream status
+    PROFILE_ACCOUNTING, //timing, counters and timestamps of the tool itself
+    PROFILE_HANDOFF, //passing blocks through the ring
+    PROFILE_PROCESSING, //the work of a pipeline stage
+    PROFILE_IDLE, //a pipeline stage waiting for blocks
+    NUM_PROFILE_PHASES
+};
+
+const char *profilePhaseName(const int phase);
+
+/*!
+ * Linux perf_event counters read per thread.
+ */
+enum PerfCounter
+{
+    PERF_CACHE_MISSES,
+    PERF_CONTEXT_SWITCHES,
+    PERF_PAGE_FAULTS,
+    NUM_PERF_COUNTERS
+};
+
+const char *perfCounterName(const int counter);
+
+/*!
+ * Turn the profiler on and calibrate the cycle counter.
+ * Call before the profiled threads start, without it every ThreadProfile is a no-op.
+ */
+void enableProfile(void);
+
+bool profileEnabled(void);
+
+//! Cycle counter ticks per second, 0 before enableProfile()
+double profileTicksPerSecond(void);
+
+//! The time stamp counter where there is one, else steady clock nanoseconds
+static inline uint64_t profileTicks(void)
+{
+    #if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+    #else
+    return uint64_t(std::chrono::steady_clock::now().time_since_epoch().count());
+    #endif
+}
+
+/*!
+ * The phases and perf counters of one profiled loop.
+ */
+struct ThreadProfileResult
+{
+    std::string thread; //e.g. "Dev 0 RX stream"
+    uint64_t ticks[NUM_PROFILE_PHASES];
+    uint64_t laps[NUM_PROFILE_PHASES];
+    bool perfValid[NUM_PERF_COUNTERS];
+    bool perfUserOnly[NUM_PERF_COUNTERS]; //kernel events were not permitted
+    uint64_t perf[NUM_PERF_COUNTERS];
+    std::string perfError; //why the first counter which failed could not be opened
+};
+
+/*!
+ * Cycle counts per phase of a loop, plus the perf counters of its thread.
+ *
+ * Create it on the loop's thread right before the loop and call lap() at the
+ * end of each phase, the ticks since the previous lap go to that phase. A lap
+ * is a counter read and two additions, it never allocates or enters the
+ * kernel. The perf counters are opened in the constructor and read in end(),
+ * or the destructor, when the result is recorded under the loop's name.
+ * Loops which share a thread, like the tasks of the coroutine engine, each
+ * see the counters of the whole thread.
+ */
+class ThreadProfile
+{
+public:
+    //! \param thread the name the result is recorded under
+    explicit ThreadProfile(const std::string &thread);
+
+    ~ThreadProfile(void);
+
+    ThreadProfile(const ThreadProfile &) = delete;
+    ThreadProfile &operator=(const ThreadProfile &) = delete;
+
+    //! Charge the ticks since the last lap to this phase
+    inline void lap(const ProfilePhase phase)
+    {
+        if (not _enabled) return;
+        const uint64_t now = profileTicks();
+        _result.ticks[phase] += now - _last;
+        _result.laps[phase]++;
+        _last = now;
+    }
+
+    //! The loop is over, read the counters and record the result, only the first call counts
+    void end(void);
+
+private:
+    const bool _enabled;
+    bool _ended;
+    uint64_t _last;
+    int _perfFds[NUM_PERF_COUNTERS];
+    ThreadProfileResult _result;
+};
+
+/*!
+ * Every profile recorded so far, in the order they finished.
+ */
+std::vector<ThreadProfileResult> threadProfiles(void);
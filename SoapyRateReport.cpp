@@ -0,0 +1,59 @@
+// Copyright (c) 2026 SoapySDR contributors
+// SPDX-License-Identifier: BSL-1.0
+
+#include "SoapyRateReport.hpp"
+#include <stdexcept>
+
+bool rateTestOutputSupported(const std::string &format)
+{
+    return format == "json" or format == "csv";
+}
+
+static std::string quoted(const std::string &str, const bool csv)
+{
+    std::string result("\"");
+    for (const char ch : str)
+    {
+        if (ch == '"') result += csv?"\"\"":"\\\"";
+        else if (ch == '\\' and not csv) result += "\\\\";
+        else if (static_cast<unsigned char>(ch) < 0x20) result += ' ';
+        else result += ch;
+    }
+    return result + "\"";
+}
+
+RateTestReporter::RateTestReporter(const std::string &format, FILE *out):
+    _csv(format == "csv"),
+    _out(out)
+{
+    if (not rateTestOutputSupported(format))
+    {
+        fclose(_out);
+        throw std::runtime_error("unknown output format " + format);
+    }
+    if (not _csv) return;
+    fprintf(_out, "type,device,dir,format,channels,elems,sample_rate,time_s,msps,mbps,samples,"
+        "overflows,underflows,lost_samples,lat_p50_us,lat_p99_us,lat_p999_us,lat_max_us,pass\n");
+    fflush(_out);
+}
+
+RateTestReporter::~RateTestReporter(void)
+{
+    fclose(_out);
+}
+
+void RateTestReporter::write(const RateTestRecord &r)
+{
+    const char *pass = (r.pass > 0)?(_csv?"1":"true"):(r.pass == 0)?(_csv?"0":"false"):(_csv?"":"null");
+    std::lock_guard<std::mutex> lock(_mutex);
+    const char *fmt = _csv?
+        "%s,%s,%s,%s,%zu,%zu,%.17g,%.6f,%.6f,%.6f,%llu,%llu,%llu,%llu,%.3f,%.3f,%.3f,%.3f,%s\n":
+        "{\"type\": %s, \"device\": %s, \"dir\": %s, \"format\": %s, \"channels\": %zu, \"elems\": %zu, "
+        "\"sample_rate\": %.17g, \"time_s\": %.6f, \"msps\": %.6f, \"mbps\": %.6f, \"samples\": %llu, "
+        "\"overflows\": %llu, \"underflows\": %llu, \"lost_samples\": %llu, \"lat_p50_us\": %.3f, "
+        "\"lat_p99_us\": %.3f, \"lat_p999_us\": %.3f, \"lat_max_us\": %.3f, \"pass\": %s}\n";
+    fprintf(_out, fmt, quoted(r.type, _csv).c_str(), quoted(r.device, _csv).c_str(), quoted(r.direction, _csv).c_str(),
+        quoted(r.format, _csv).c_str(), r.numChans, r.numElems, r.sampleRate, r.time, r.rate/1e6, r.bytesRate/1e6,
+        r.samples, r.overflows, r.underflows, r.lostSamples, r.latencyP50, r.latencyP99, r.latencyP999, r.latencyMax, pass);
+    fflush(_out);
+}
@@ -0,0 +1,61 @@
+// Copyright (c) 2026 SoapySDR contributors
+// SPDX-License-Identifier: BSL-1.0
+
+#pragma once
+#include <string>
+#include <mutex>
+#include <cstdio>
+#include <cstddef>
+
+/*!
+ * One structured rate test record.
+ * Interval records cover the time since the previous interval,
+ * final records cover the whole measurement of one stream and
+ * the result record carries the overall pass or fail.
+ * Matrix records hold the highest sustained rate of one combination.
+ */
+struct RateTestRecord
+{
+    std::string type; //"interval", "final", "result", "matrix" or "search"
+    std::string device;
+    std::string direction;
+    std::string format;
+    size_t numChans = 0;
+    size_t numElems = 0;
+    double sampleRate = 0.0; //configured samples per second
+    double time = 0.0; //seconds since the measurement started
+    double rate = 0.0; //measured samples per second
+    double bytesRate = 0.0; //measured bytes per second over all channels
+    unsigned long long samples = 0;
+    unsigned long long overflows = 0;
+    unsigned long long underflows = 0;
+    unsigned long long lostSamples = 0;
+    double latencyP50 = 0.0; //stream call latency in microseconds
+    double latencyP99 = 0.0;
+    double latencyP999 = 0.0;
+    double latencyMax = 0.0;
+    int pass = -1; //1 or 0 against the target, -1 when not judged
+};
+
+//! Is this a supported --output format?
+bool rateTestOutputSupported(const std::string &format);
+
+/*!
+ * Writes records as JSON lines, one object per line, or as CSV with a
+ * header row. Records may be written from several stream threads.
+ */
+class RateTestReporter
+{
+public:
+    //! \param out taken over, it is closed with the reporter
+    RateTestReporter(const std::string &format, FILE *out);
+
+    ~RateTestReporter(void);
+
+    void write(const RateTestRecord &record);
+
+private:
+    bool _csv;
+    FILE *_out;
+    std::mutex _mutex;
+};
@@ -0,0 +1,217 @@
+// Copyright (c) 2026 SoapySDR contributors
+// SPDX-License-Identifier: BSL-1.0
+
+#include "SoapyRateSignal.hpp"
+#include <SoapySDR/Formats.hpp>
+#include <algorithm>
+#include <numbers>
+#include <stdexcept>
+#include <vector>
+#include <cstdint>
+#include <cmath>
+
+/***********************************************************************
+ * Tone kernel
+ **********************************************************************/
+static const size_t LANES = 8;
+static const size_t RESEED_ELEMS = 1024; //bounded float rotation drift
+
+void generateToneCF32(float *out, const size_t numElems, const double phase, const double omega, const float amplitude)
+{
+    const float stepRe = float(std::cos(LANES*omega));
+    const float stepIm = float(std::sin(LANES*omega));
+
+    size_t i = 0;
+    while (i + LANES <= numElems)
+    {
+        //seed the lane phasors from the exact phase
+        alignas(32) float re[LANES], im[LANES];
+        for (size_t k = 0; k < LANES; k++)
+        {
+            const double ph = phase + (i + k)*omega;
+            re[k] = amplitude*float(std::cos(ph));
+            im[k] = amplitude*float(std::sin(ph));
+        }
+
+        const size_t fullEnd = i + ((numElems - i)/LANES)*LANES;
+        const size_t blockEnd = std::min(fullEnd, i + RESEED_ELEMS);
+        for (; i < blockEnd; i += LANES)
+        {
+            for (size_t k = 0; k < LANES; k++)
+            {
+                out[2*(i+k)+0] = re[k];
+                out[2*(i+k)+1] = im[k];
+            }
+            for (size_t k = 0; k < LANES; k++)
+            {
+                const float r = re[k]*stepRe - im[k]*stepIm;
+                im[k] = re[k]*stepIm + im[k]*stepRe;
+                re[k] = r;
+            }
+        }
+    }
+
+    //tail shorter than the lane count
+    for (; i < numElems; i++)
+    {
+        const double ph = phase + i*omega;
+        out[2*i+0] = amplitude*float(std::cos(ph));
+        out[2*i+1] = amplitude*float(std::sin(ph));
+    }
+}
+
+/***********************************************************************
+ * PRBS kernel
+ **********************************************************************/
+static inline float prbsBit(uint32_t &state, const float level)
+{
+    const uint32_t bit = ((state >> 22) ^ (state >> 17)) & 1;
+    state = ((state << 1) | bit) & 0x7fffff;
+    return bit?level:-level;
+}
+
+void generatePrbsCF32(float *out, const size_t numElems, uint32_t &state, const float amplitude)
+{
+    const float level = amplitude*float(std::numbers::sqrt2/2);
+    for (size_t i = 0; i < numElems*2; i++) out[i] = prbsBit(state, level);
+}
+
+/***********************************************************************
+ * Format packing
+ **********************************************************************/
+template <typename Type>
+static void packIntegers(const float *in, Type *out, const size_t numElems, const float maxVal)
+{
+    //round half away from zero with a clamp, written branch free to vectorize
+    for (size_t i = 0; i < numElems*2; i++)
+    {
+        const float x = std::min(maxVal, std::max(-maxVal-1, in[i]));
+        out[i] = Type(x + ((x < 0.0f)?-0.5f:0.5f));
+    }
+}
+
+static void packCS12(const float *in, uint8_t *out, const size_t numElems)
+{
+    //SoapySDR CS12 layout: I[7:0], Q[3:0]<<4 | I[11:8], Q[11:4]
+    for (size_t i = 0; i < numElems; i++)
+    {
+        const float re = std::min(2047.0f, std::max(-2048.0f, in[2*i+0]));
+        const float im = std::min(2047.0f, std::max(-2048.0f, in[2*i+1]));
+        const uint16_t I = uint16_t(int16_t(re + ((re < 0.0f)?-0.5f:0.5f)));
+        const uint16_t Q = uint16_t(int16_t(im + ((im < 0.0f)?-0.5f:0.5f)));
+        out[3*i+0] = uint8_t(I & 0xff);
+        out[3*i+1] = uint8_t(((I >> 8) & 0x0f) | ((Q & 0x0f) << 4));
+        out[3*i+2] = uint8_t(Q >> 4);
+    }
+}
+
+void packFromCF32(const float *in, void *out, const size_t numElems, const std::string &format)
+{
+    if (format == SOAPY_SDR_CF32) std::copy(in, in + numElems*2, reinterpret_cast<float *>(out));
+    else if (format == SOAPY_SDR_CS16) packIntegers(in, reinterpret_cast<int16_t *>(out), numElems, 32767.0f);
+    else if (format == SOAPY_SDR_CS12) packCS12(in, reinterpret_cast<uint8_t *>(out), numElems);
+    else if (format == SOAPY_SDR_CS8) packIntegers(in, reinterpret_cast<int8_t *>(out), numElems, 127.0f);
+    else throw std::runtime_error("packFromCF32() unsupported format " + format);
+}
+
+template <typename Type>
+static void unpackIntegers(const Type *in, float *out, const size_t numElems)
+{
+    for (size_t i = 0; i < numElems*2; i++) out[i] = float(in[i]);
+}
+
+static void unpackCS12(const uint8_t *in, float *out, const size_t numElems)
+{
+    for (size_t i = 0; i < numElems; i++)
+    {
+        const uint16_t I = uint16_t(in[3*i+0]) | uint16_t((in[3*i+1] & 0x0f) << 8);
+        const uint16_t Q = uint16_t(in[3*i+1] >> 4) | uint16_t(in[3*i+2] << 4);
+        out[2*i+0] = float(int16_t(I << 4) >> 4);
+        out[2*i+1] = float(int16_t(Q << 4) >> 4);
+    }
+}
+
+void unpackToCF32(const void *in, float *out, const size_t numElems, const std::string &format)
+{
+    if (format == SOAPY_SDR_CF32) std::copy_n(reinterpret_cast<const float *>(in), numElems*2, out);
+    else if (format == SOAPY_SDR_CS16) unpackIntegers(reinterpret_cast<const int16_t *>(in), out, numElems);
+    else if (format == SOAPY_SDR_CS12) unpackCS12(reinterpret_cast<const uint8_t *>(in), out, numElems);
+    else if (format == SOAPY_SDR_CS8) unpackIntegers(reinterpret_cast<const int8_t *>(in), out, numElems);
+    else throw std::runtime_error("unpackToCF32() unsupported format " + format);
+}
+
+bool signalFormatSupported(const std::string &format)
+{
+    return format == SOAPY_SDR_CF32 or format == SOAPY_SDR_CS16 or
+        format == SOAPY_SDR_CS12 or format == SOAPY_SDR_CS8;
+}
+
+double defaultFullScale(const std::string &format)
+{
+    if (format == SOAPY_SDR_CS16) return 32767.0;
+    if (format == SOAPY_SDR_CS12) return 2047.0;
+    if (format == SOAPY_SDR_CS8) return 127.0;
+    return 1.0;
+}
+
+/***********************************************************************
+ * Transmit waveform ring
+ **********************************************************************/
+static const size_t MAX_RING_BUFFS = 16;
+static const size_t MAX_RING_BYTES = 32*1024*1024;
+static const double TONE_AMPLITUDE = 0.7; //fraction of full scale, headroom for the DAC
+
+TxWaveform::TxWaveform(
+    const std::string &format,
+    const double fullScale,
+    const size_t numElems,
+    const double toneFreq,
+    const double sampleRate,
+    const bool hugePages,
+    const int numaNode,
+    const TxPattern pattern):
+    _pattern(pattern),
+    _elemSize(SoapySDR::formatToSize(format)),
+    _numElems(numElems),
+    _numBuffs(1),
+    _toneFreq(0.0)
+{
+    if (not signalFormatSupported(format)) throw std::runtime_error("TX waveform unsupported format " + format);
+    if (numElems == 0 or sampleRate <= 0.0) throw std::runtime_error("TX waveform invalid size or rate");
+
+    //pick the ring length which needs the smallest tone frequency adjustment
+    const size_t maxBuffs = std::max<size_t>(1, std::min(MAX_RING_BUFFS, MAX_RING_BYTES/(numElems*_elemSize)));
+    double bestErr = -1.0;
+    if (pattern == TX_PATTERN_PRBS) _numBuffs = maxBuffs;
+    else for (size_t k = 1; k <= maxBuffs; k++)
+    {
+        const double total = double(k*numElems);
+        const double cycles = std::round(toneFreq/sampleRate*total);
+        const double err = std::abs(cycles/total*sampleRate - toneFreq);
+        if (bestErr >= 0.0 and err >= bestErr) continue;
+        bestErr = err;
+        _numBuffs = k;
+        _toneFreq = cycles/total*sampleRate;
+        if (err < 1e-9*sampleRate) break;
+    }
+
+    //render the whole ring in tiles so the scratch stays cache resident
+    _arena.reset(new BufferArena(_numBuffs, _numElems*_elemSize, hugePages, numaNode));
+    const double omega = 2*std::numbers::pi*_toneFreq/sampleRate;
+    const float amplitude = float(TONE_AMPLITUDE*fullScale);
+    const size_t tileElems = 4096;
+    std::vector<float> tile(tileElems*2);
+    uint32_t prbsState = 1;
+    for (size_t b = 0; b < _numBuffs; b++)
+    {
+        char *out = static_cast<char *>(_arena->slice(b));
+        for (size_t i = 0; i < _numElems; i += tileElems)
+        {
+            const size_t n = std::min(tileElems, _numElems - i);
+            const double phase = std::fmod((b*_numElems + i)*omega, 2*std::numbers::pi);
+            if (pattern == TX_PATTERN_PRBS) generatePrbsCF32(tile.data(), n, prbsState, amplitude);
+            else generateToneCF32(tile.data(), n, phase, omega, amplitude);
+            packFromCF32(tile.data(), out + i*_elemSize, n, format);
+        }
+    }
+}
@@ -0,0 +1,117 @@
+// Copyright (c) 2026 SoapySDR contributors
+// SPDX-License-Identifier: BSL-1.0
+
+#pragma once
+#include "SoapyRateBuffers.hpp"
+#include <string>
+#include <memory>
+#include <cstddef>
+#include <cstdint>
+
+/*!
+ * Generate an interleaved CF32 tone: out[2k] + j*out[2k+1] = A*exp(j*(phase + k*omega)).
+ * The kernel steps eight phasors in lock-step so the loop body vectorizes,
+ * phasors are re-seeded from the exact phase every block to bound drift.
+ */
+void generateToneCF32(float *out, const size_t numElems, const double phase, const double omega, const float amplitude);
+
+/*!
+ * Generate interleaved CF32 QPSK symbols from a PRBS-23 sequence (x^23 + x^18 + 1),
+ * two bits per element, each component is +/-amplitude/sqrt(2).
+ * \param state the LFSR state, carried across calls, must not be zero
+ */
+void generatePrbsCF32(float *out, const size_t numElems, uint32_t &state, const float amplitude);
+
+/*!
+ * Pack interleaved CF32 samples into the given stream format.
+ * Supported formats: CF32, CS16, CS12, CS8.
+ * \throws std::runtime_error for any other format
+ */
+void packFromCF32(const float *in, void *out, const size_t numElems, const std::string &format);
+
+/*!
+ * Unpack a stream format into interleaved CF32, the inverse of packFromCF32().
+ * Values stay in the units of the format, integers are not scaled.
+ * \throws std::runtime_error for an unsupported format
+ */
+void unpackToCF32(const void *in, float *out, const size_t numElems, const std::string &format);
+
+//! Is the format supported by packFromCF32() and unpackToCF32()?
+bool signalFormatSupported(const std::string &format);
+
+//! Conventional full scale for a format when the driver does not report one
+double defaultFullScale(const std::string &format);
+
+//! What the transmit ring holds
+enum TxPattern
+{
+    TX_PATTERN_TONE,
+    TX_PATTERN_PRBS,
+};
+
+/*!
+ * A ring of transmit buffers holding a precomputed tone or PRBS pattern.
+ *
+ * For a tone the ring length is chosen so that it spans a whole number of
+ * tone cycles, the tone frequency is quantized by the smallest amount required
+ * and the phase is continuous when the last buffer wraps to the first.
+ * A PRBS pattern takes the longest ring allowed, so a position within it is
+ * unambiguous over the longest span. After construction no per-write
+ * computation is required. The ring itself lives in a BufferArena, one slice per buffer.
+ */
+class TxWaveform
+{
+public:
+    TxWaveform(
+        const std::string &format,
+        const double fullScale,
+        const size_t numElems,
+        const double toneFreq,
+        const double sampleRate,
+        const bool hugePages = false,
+        const int numaNode = -1,
+        const TxPattern pattern = TX_PATTERN_TONE);
+
+    TxPattern pattern(void) const
+    {
+        return _pattern;
+    }
+
+    //! Number of buffers in the ring
+    size_t numBuffers(void) const
+    {
+        return _numBuffs;
+    }
+
+    //! Elements per buffer
+    size_t numElems(void) const
+    {
+        return _numElems;
+    }
+
+    //! Get the buffer at the ring position (wraps)
+    const void *buffer(const size_t index) const
+    {
+        return _arena->slice(index % _numBuffs);
+    }
+
+    //! Why binding the ring to a NUMA node failed, empty on success
+    const std::string &numaError(void) const
+    {
+        return _arena->numaError();
+    }
+
+    //! The tone frequency actually generated after quantization, 0 for PRBS
+    double toneFrequency(void) const
+    {
+        return _toneFreq;
+    }
+
+private:
+    TxPattern _pattern;
+    size_t _elemSize;
+    size_t _numElems;
+    size_t _numBuffs;
+    double _toneFreq;
+    std::unique_ptr<BufferArena> _arena;
+};
@@ -0,0 +1,429 @@
+// Copyright (c) 2026 SoapySDR contributors
+// SPDX-License-Identifier: BSL-1.0
+
+#pragma once
+#include <SoapySDR/Time.hpp>
+#include <array>
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+//! Nanoseconds on the steady clock, the one time base of the streams, stages and reports
+inline int64_t steadyNs(void)
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/***********************************************************************
+ * Log-linear latency histogram in nanoseconds.
+ *
+ * Values below 2^(SUB_BITS+1) get one bucket each, above that every
+ * power of two octave is split into 2^SUB_BITS linear sub-buckets,
+ * which bounds the relative error to about 3%. The bucket array is a
+ * fixed member so recording never allocates or branches on size.
+ **********************************************************************/
+class LatencyHistogram
+{
+public:
+    static const size_t SUB_BITS = 5;
+    static const size_t SUB_COUNT = size_t(1) << SUB_BITS;
+    static const size_t MAX_BITS = 40; //~18 minutes in ns
+    static const size_t NUM_BUCKETS = (MAX_BITS - SUB_BITS)*SUB_COUNT + 2*SUB_COUNT;
+
+    LatencyHistogram(void)
+    {
+        this->reset();
+    }
+
+    void reset(void)
+    {
+        _buckets.fill(0);
+        _count = 0;
+        _max = 0;
+        _sum = 0.0;
+        _sumSq = 0.0;
+    }
+
+    //! Record a single duration, this is the hot path
+    inline void record(uint64_t ns)
+    {
+        if (ns >= (uint64_t(1) << MAX_BITS)) ns = (uint64_t(1) << MAX_BITS) - 1;
+        _buckets[bucketIndex(ns)]++;
+        _count++;
+        if (ns > _max) _max = ns;
+        const double x(ns);
+        _sum += x;
+        _sumSq += x*x;
+    }
+
+    //! Accumulate the contents of another histogram into this one
+    void merge(const LatencyHistogram &other)
+    {
+        for (size_t i = 0; i < NUM_BUCKETS; i++) _buckets[i] += other._buckets[i];
+        _count += other._count;
+        if (other._max > _max) _max = other._max;
+        _sum += other._sum;
+        _sumSq += other._sumSq;
+    }
+
+    uint64_t count(void) const
+    {
+        return _count;
+    }
+
+    uint64_t max(void) const
+    {
+        return _max;
+    }
+
+    double mean(void) const
+    {
+        return (_count == 0)?0.0:(_sum/_count);
+    }
+
+    double stddev(void) const
+    {
+        if (_count < 2) return 0.0;
+        const double m = this->mean();
+        const double var = _sumSq/_count - m*m;
+        return (var > 0.0)?std::sqrt(var):0.0;
+    }
+
+    //! Upper bound of the bucket holding the given percentile [0, 100]
+    uint64_t percentile(const double pct) const
+    {
+        if (_count == 0) return 0;
+        const uint64_t rank = uint64_t(std::ceil(pct/100.0*_count));
+        uint64_t seen(0);
+        for (size_t i = 0; i < NUM_BUCKETS; i++)
+        {
+            seen += _buckets[i];
+            if (seen >= rank and seen != 0)
+            {
+                const uint64_t upper = bucketUpper(i);
+                return (upper < _max)?upper:_max;
+            }
+        }
+        return _max;
+    }
+
+private:
+    static inline size_t bucketIndex(const uint64_t ns)
+    {
+        if (ns < 2*SUB_COUNT) return size_t(ns);
+        const size_t msb = 63 - __builtin_clzll(ns);
+        const size_t shift = msb - SUB_BITS;
+        return shift*SUB_COUNT + size_t(ns >> shift);
+    }
+
+    static uint64_t bucketUpper(const size_t index)
+    {
+        if (index < 2*SUB_COUNT) return index;
+        const size_t shift = index/SUB_COUNT - 1;
+        const uint64_t sub = index - shift*SUB_COUNT;
+        return ((sub + 1) << shift) - 1;
+    }
+
+    std::array<uint64_t, NUM_BUCKETS> _buckets;
+    uint64_t _count;
+    uint64_t _max;
+    double _sum;
+    double _sumSq;
+};
+
+/***********************************************************************
+ * Call latency and inter-call period for one stream direction
+ **********************************************************************/
+struct StreamCallTiming
+{
+    LatencyHistogram latency; //duration of each stream call
+    LatencyHistogram period; //time between the start of successive calls
+    int64_t lastStartNs = -1;
+
+    inline void record(const int64_t startNs, const int64_t endNs)
+    {
+        latency.record(uint64_t(endNs - startNs));
+        if (lastStartNs >= 0) period.record(uint64_t(startNs - lastStartNs));
+        lastStartNs = startNs;
+    }
+
+    void merge(const StreamCallTiming &other)
+    {
+        latency.merge(other.latency);
+        period.merge(other.period);
+    }
+
+    void reset(void)
+    {
+        latency.reset();
+        period.reset();
+    }
+};
+
+/***********************************************************************
+ * Lock-free handoff of stream loop statistics to the reporter thread.
+ *
+ * Only the stream thread writes the counters, so updates are relaxed
+ * stores without a read-modify-write. The call timing is double
+ * buffered: the reporter asks for a swap, the stream thread flips
+ * buffers at the top of its next call and the retired buffer belongs to
+ * the reporter until the following swap. Stream written and reporter
+ * written state live on separate cache lines.
+ **********************************************************************/
+class StreamPublisher
+{
+public:
+    static const uint64_t NO_LIMIT = ~uint64_t(0);
+
+    /*******************************************************************
+     * Stream thread side
+     ******************************************************************/
+    void start(const int64_t startNs)
+    {
+        _startNs.store(startNs, std::memory_order_relaxed);
+        _started.store(true, std::memory_order_release);
+    }
+
+    inline void publishSamples(const uint64_t total)
+    {
+        _samples.store(total, std::memory_order_relaxed);
+    }
+
+    inline void addOverflow(void)
+    {
+        _overflows.store(_overflows.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+
+    inline void addUnderflow(void)
+    {
+        _underflows.store(_underflows.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+
+    inline void publishLost(const uint64_t total)
+    {
+        _lostSamples.store(total, std::memory_order_relaxed);
+    }
+
+    inline void publishDropped(const uint64_t total)
+    {
+        _droppedBlocks.store(total, std::memory_order_relaxed);
+    }
+
+    //! The timing buffer the stream thread records into
+    inline StreamCallTiming &timing(void)
+    {
+        return _timing[_active];
+    }
+
+    //! Answer a pending timing swap, call once before every stream call
+    inline void poll(void)
+    {
+        const uint32_t request = _swapRequest.load(std::memory_order_acquire);
+        if (request == _swapAck.load(std::memory_order_relaxed)) return;
+        const int64_t last = _timing[_active].lastStartNs;
+        _active ^= 1;
+        _timing[_active].lastStartNs = last;
+        _swapAck.store(request, std::memory_order_release);
+    }
+
+    //! The stream path the reporter asked for
+    inline int path(void) const
+    {
+        return _path.load(std::memory_order_relaxed);
+    }
+
+    inline bool limitReached(const uint64_t total) const
+    {
+        return total >= _stopAt.load(std::memory_order_relaxed);
+    }
+
+    //! The loop has ended, nothing is written after this
+    void finish(const int64_t stopNs)
+    {
+        _stopNs.store(stopNs, std::memory_order_relaxed);
+        _finished.store(true, std::memory_order_release);
+    }
+
+    /*******************************************************************
+     * Reporter thread side
+     ******************************************************************/
+    bool started(void) const
+    {
+        return _started.load(std::memory_order_acquire);
+    }
+
+    bool finished(void) const
+    {
+        return _finished.load(std::memory_order_acquire);
+    }
+
+    int64_t startNs(void) const
+    {
+        return _startNs.load(std::memory_order_relaxed);
+    }
+
+    int64_t stopNs(void) const
+    {
+        return _stopNs.load(std::memory_order_relaxed);
+    }
+
+    uint64_t samples(void) const
+    {
+        return _samples.load(std::memory_order_relaxed);
+    }
+
+    uint64_t overflows(void) const
+    {
+        return _overflows.load(std::memory_order_relaxed);
+    }
+
+    uint64_t underflows(void) const
+    {
+        return _underflows.load(std::memory_order_relaxed);
+    }
+
+    uint64_t lostSamples(void) const
+    {
+        return _lostSamples.load(std::memory_order_relaxed);
+    }
+
+    uint64_t droppedBlocks(void) const
+    {
+        return _droppedBlocks.load(std::memory_order_relaxed);
+    }
+
+    void requestPath(const int path)
+    {
+        _path.store(path, std::memory_order_relaxed);
+    }
+
+    void setLimit(const uint64_t total)
+    {
+        _stopAt.store(total, std::memory_order_relaxed);
+    }
+
+    /*!
+     * Swap the timing buffers and return the retired one.
+     * Waits for the stream thread to answer, or takes over once it finished.
+     * The caller resets the buffer before the next swap.
+     */
+    StreamCallTiming &collectTiming(void)
+    {
+        const uint32_t request = _swapRequest.load(std::memory_order_relaxed) + 1;
+        _swapRequest.store(request, std::memory_order_release);
+        while (_swapAck.load(std::memory_order_acquire) != request)
+        {
+            if (this->finished())
+            {
+                this->poll();
+                break;
+            }
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+        }
+        return _timing[_active ^ 1];
+    }
+
+private:
+    //written by the stream thread
+    alignas(64) std::atomic<uint64_t> _samples{0};
+    std::atomic<uint64_t> _overflows{0};
+    std::atomic<uint64_t> _underflows{0};
+    std::atomic<uint64_t> _lostSamples{0};
+    std::atomic<uint64_t> _droppedBlocks{0};
+    std::atomic<uint32_t> _swapAck{0};
+    std::atomic<bool> _started{false};
+    std::atomic<bool> _finished{false};
+    std::atomic<int64_t> _startNs{0};
+    std::atomic<int64_t> _stopNs{0};
+
+    //written by the reporter thread
+    alignas(64) std::atomic<uint32_t> _swapRequest{0};
+    std::atomic<int> _path{0};
+    std::atomic<uint64_t> _stopAt{NO_LIMIT};
+
+    //owned by whichever side holds the buffer
+    alignas(64) int _active = 0;
+    StreamCallTiming _timing[2];
+};
+
+/***********************************************************************
+ * RX hardware timestamp continuity.
+ *
+ * Every block must start where the previous one ended. Times are
+ * compared in ticks of the sample rate, so the count of lost samples is
+ * exact however long the run. A difference of one tick is accepted as
+ * rounding in the driver's time conversion.
+ **********************************************************************/
+class TimestampContinuity
+{
+public:
+    static const long long TICK_TOLERANCE = 1;
+
+    explicit TimestampContinuity(const double rate = 0.0):
+        _rate(rate)
+    {
+        return;
+    }
+
+    //! Record a block which starts at timeNs, this is the hot path
+    inline void update(const long long timeNs, const size_t numElems)
+    {
+        const long long ticks = SoapySDR::timeNsToTicks(timeNs, _rate);
+        if (_blocks != 0)
+        {
+            const long long gap = ticks - _nextTicks;
+            if (gap > TICK_TOLERANCE)
+            {
+                _lostSamples += uint64_t(gap);
+                _gaps++;
+                if (uint64_t(gap) > _maxGap) _maxGap = uint64_t(gap);
+            }
+            else if (gap < -TICK_TOLERANCE) _overlaps++;
+        }
+        _nextTicks = ticks + (long long)numElems;
+        _blocks++;
+    }
+
+    //! Samples missing between blocks
+    uint64_t lostSamples(void) const
+    {
+        return _lostSamples;
+    }
+
+    //! Number of discontinuities where samples went missing
+    uint64_t gaps(void) const
+    {
+        return _gaps;
+    }
+
+    //! Largest single discontinuity in samples
+    uint64_t maxGap(void) const
+    {
+        return _maxGap;
+    }
+
+    //! Blocks which started before the previous block ended
+    uint64_t overlaps(void) const
+    {
+        return _overlaps;
+    }
+
+    //! Number of timestamped blocks checked
+    uint64_t blocks(void) const
+    {
+        return _blocks;
+    }
+
+private:
+    double _rate;
+    long long _nextTicks = 0;
+    uint64_t _blocks = 0;
+    uint64_t _lostSamples = 0;
+    uint64_t _gaps = 0;
+    uint64_t _maxGap = 0;
+    uint64_t _overlaps = 0;
+};
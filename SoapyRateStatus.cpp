@@ -0,0 +1,85 @@
+// Copyright (c) 2026 SoapySDR contributors
+// SPDX-License-Identifier: BSL-1.0
+
+#include "SoapyRateStatus.hpp"
+#include "SoapyRateProfile.hpp"
+#include "SoapyRateStats.hpp"
+#include <SoapySDR/Errors.hpp>
+#include <chrono>
+
+//a driver which returns without waiting is polled at this period instead
+static const auto NONBLOCKING_POLL = std::chrono::milliseconds(10);
+
+//a call which came back within a tenth of its wait did not block, in ns
+static const int64_t NONBLOCKING_RETURN_NS = StreamStatusMonitor::WAIT_US*1000/10;
+
+StreamStatusMonitor::StreamStatusMonitor(SoapySDR::Device *device, SoapySDR::Stream *stream, const size_t capacity):
+    _device(device),
+    _stream(stream),
+    _ring(capacity),
+    _done(false),
+    _overflows(0),
+    _underflows(0),
+    _timeErrors(0),
+    _numEvents(0)
+{
+    _thread = std::thread(&StreamStatusMonitor::monitorLoop, this);
+}
+
+StreamStatusMonitor::~StreamStatusMonitor(void)
+{
+    this->stop();
+}
+
+void StreamStatusMonitor::stop(void)
+{
+    _done = true;
+    if (_thread.joinable()) _thread.join();
+}
+
+std::vector<StreamStatusEvent> StreamStatusMonitor::events(void) const
+{
+    const uint64_t total = this->numEvents();
+    const size_t n = (total < _ring.size())?size_t(total):_ring.size();
+    std::vector<StreamStatusEvent> result;
+    result.reserve(n);
+    for (uint64_t i = total - n; i < total; i++) result.push_back(_ring[i%_ring.size()]);
+    return result;
+}
+
+void StreamStatusMonitor::monitorLoop(void)
+{
+    ThreadProfile prof("status monitor");
+    while (not _done)
+    {
+        StreamStatusEvent ev{0, 0, 0, 0, 0};
+        const int64_t callNs = steadyNs();
+        ev.code = _device->readStreamStatus(_stream, ev.chanMask, ev.flags, ev.timeNs, WAIT_US);
+        ev.hostNs = steadyNs();
+        prof.lap(PROFILE_STATUS_POLL);
+
+        if (ev.code == SOAPY_SDR_NOT_SUPPORTED)
+        {
+            _error = "readStreamStatus not supported";
+            break;
+        }
+        //burst acknowledgements are not flow events
+        if (ev.code != SOAPY_SDR_TIMEOUT and ev.code != 0)
+        {
+            if (ev.code == SOAPY_SDR_OVERFLOW) _overflows.fetch_add(1, std::memory_order_relaxed);
+            if (ev.code == SOAPY_SDR_UNDERFLOW) _underflows.fetch_add(1, std::memory_order_relaxed);
+            if (ev.code == SOAPY_SDR_TIME_ERROR) _timeErrors.fetch_add(1, std::memory_order_relaxed);
+            const uint64_t n = _numEvents.load(std::memory_order_relaxed);
+            _ring[n%_ring.size()] = ev;
+            _numEvents.store(n + 1, std::memory_order_relaxed);
+            prof.lap(PROFILE_ACCOUNTING);
+        }
+
+        //whatever it returned, a driver which did not wait would spin this loop and flood the ring
+        if (ev.hostNs - callNs < NONBLOCKING_RETURN_NS)
+        {
+            std::this_thread::sleep_for(NONBLOCKING_POLL);
+            prof.lap(PROFILE_IDLE);
+        }
+    }
+}
@@ -0,0 +1,96 @@
+// Copyright (c) 2026 SoapySDR contributors
+// SPDX-License-Identifier: BSL-1.0
+
+#pragma once
+#include <SoapySDR/Device.hpp>
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+//! One readStreamStatus result, hostNs is on the steady clock
+struct StreamStatusEvent
+{
+    int code;
+    size_t chanMask;
+    int flags;
+    long long timeNs; //hardware time, valid when flags has SOAPY_SDR_HAS_TIME
+    int64_t hostNs;
+};
+
+/*!
+ * Blocks on readStreamStatus on its own thread for one stream.
+ *
+ * Every event is counted and kept in a bounded ring which retains the
+ * most recent events, so flow problems are seen as they happen and the
+ * stream loop never polls for them. The counters can be read at any time,
+ * the ring only once the monitor has stopped.
+ */
+class StreamStatusMonitor
+{
+public:
+    //! Longest a single readStreamStatus call blocks, bounds how long stop() takes
+    static const long WAIT_US = 100000;
+
+    /*!
+     * \param device the device which owns the stream
+     * \param stream the stream to watch, it may be activated later
+     * \param capacity number of events retained in the ring
+     */
+    StreamStatusMonitor(SoapySDR::Device *device, SoapySDR::Stream *stream, const size_t capacity = 4096);
+
+    ~StreamStatusMonitor(void);
+
+    StreamStatusMonitor(const StreamStatusMonitor &) = delete;
+    StreamStatusMonitor &operator=(const StreamStatusMonitor &) = delete;
+
+    //! Finish the call in progress and join the thread
+    void stop(void);
+
+    uint64_t overflows(void) const
+    {
+        return _overflows.load(std::memory_order_relaxed);
+    }
+
+    uint64_t underflows(void) const
+    {
+        return _underflows.load(std::memory_order_relaxed);
+    }
+
+    //! Late bursts and other TIME_ERROR reports
+    uint64_t timeErrors(void) const
+    {
+        return _timeErrors.load(std::memory_order_relaxed);
+    }
+
+    //! Every event seen, including those which fell out of the ring
+    uint64_t numEvents(void) const
+    {
+        return _numEvents.load(std::memory_order_relaxed);
+    }
+
+    //! Retained events oldest first, only valid after stop()
+    std::vector<StreamStatusEvent> events(void) const;
+
+    //! Why monitoring ended early, empty while it runs or after a clean stop
+    const std::string &error(void) const
+    {
+        return _error;
+    }
+
+private:
+    void monitorLoop(void);
+
+    SoapySDR::Device *_device;
+    SoapySDR::Stream *_stream;
+    std::vector<StreamStatusEvent> _ring;
+    std::atomic<bool> _done;
+    std::atomic<uint64_t> _overflows;
+    std::atomic<uint64_t> _underflows;
+    std::atomic<uint64_t> _timeErrors;
+    std::atomic<uint64_t> _numEvents;
+    std::string _error;
+    std::thread _thread;
+};
@@ -5,239 +5,2743 @@
 #include <SoapySDR/Formats.hpp>
 #include <SoapySDR/Errors.hpp>
 #include <SoapySDR/Logger.hpp>
+#include <SoapySDR/Time.hpp>
+#include "SoapyRateTest.hpp"
+#include "SoapyRateStats.hpp"
+#include "SoapyRateSignal.hpp"
+#include "SoapyRateBuffers.hpp"
+#include "SoapyRateThreads.hpp"
+#include "SoapyRateCapture.hpp"
+#include "SoapyRateReport.hpp"
+#include "SoapyRateStatus.hpp"
+#include "SoapyRateVerify.hpp"
+#include "SoapyRateConvert.hpp"
+#include "SoapyRateEngine.hpp"
+#include "SoapyRateDsp.hpp"
+#include "SoapyRateAlloc.hpp"
+#include "SoapyRateProfile.hpp"
+#include "SoapyRateHistory.hpp"
+#include "SoapyRateNet.hpp"
 #include <string>
+#include <vector>
+#include <memory>
+#include <algorithm>
 #include <cstdlib>
 #include <iostream>
 #include <stdexcept>
 #include <csignal>
 #include <chrono>
 #include <cstdio>
+#include <cstring>
 #include <thread>
-#include <numbers>
+#include <atomic>
+#include <future>
+#include <ctime>
+#include <cmath>
+#include <limits>
+#include <map>
+#include <unistd.h>
+#include <sys/resource.h>
 
-static sig_atomic_t loopDone = false;
+static std::atomic<bool> loopDone(false);
+static std::atomic<bool> interrupted(false); //loopDone also ends each search trial, this only on SIGINT
 static void sigIntHandler(const int)
 {
+    interrupted = true;
     loopDone = true;
 }
 
-void runRateTestStreamLoop(
+/***********************************************************************
+ * Per-path accounting for the copy vs direct access comparison
+ **********************************************************************/
+enum StreamPath
+{
+    STREAM_PATH_COPY = 0,
+    STREAM_PATH_DIRECT = 1,
+};
+
+static const char *streamPathName(const int path)
+{
+    return (path == STREAM_PATH_DIRECT)?"direct":"copy";
+}
+
+struct StreamPathStats
+{
+    unsigned long long samples = 0;
+    double elapsed = 0.0; //wall time in seconds
+    double cpuTime = 0.0; //thread cpu time in seconds
+};
+
+static double threadCpuTime(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return ts.tv_sec + ts.tv_nsec*1e-9;
+}
+
+//elements per stream call, the stream MTU unless one was requested
+static size_t transferElems(const SoapySDRRateTestArgs &args, SoapySDR::Device *device, SoapySDR::Stream *stream)
+{
+    return (args.numElems != 0)?args.numElems:device->getStreamMTU(stream);
+}
+
+static void printCallTiming(const char *name, const int direction, const char *label, const StreamCallTiming &timing)
+{
+    const auto &lat = timing.latency;
+    const auto &per = timing.period;
+    if (lat.count() == 0) return;
+    printf("  %sDir %d %s call latency us: p50 %.1f  p99 %.1f  p99.9 %.1f  max %.1f  (%llu calls)\n",
+        name, direction, label, lat.percentile(50)/1e3, lat.percentile(99)/1e3, lat.percentile(99.9)/1e3,
+        lat.max()/1e3, (unsigned long long)lat.count());
+    printf("  %sDir %d %s call period us:  mean %.1f  jitter %.1f  p99.9 %.1f  max %.1f\n",
+        name, direction, label, per.mean()/1e3, per.stddev()/1e3, per.percentile(99.9)/1e3, per.max()/1e3);
+}
+
+/***********************************************************************
+ * One stream under test and the results collected by its loop
+ **********************************************************************/
+struct BurstTrial
+{
+    double lead = 0.0; //seconds
+    unsigned long long bursts = 0;
+    unsigned long long late = 0;
+    unsigned long long hostLate = 0; //first write returned after the burst time
+};
+
+struct RateTestStream
+{
+    std::string name; //prefix for printed lines, empty for a single device
+    std::string label; //device label for records
+    SoapySDR::Device *device = nullptr;
+    SoapySDR::Stream *stream = nullptr;
+    int direction = SOAPY_SDR_RX;
+    std::string format;
+    size_t numChans = 0;
+    size_t elemSize = 0;
+    size_t numElems = 0; //elements per stream call
+    double sampleRate = 0.0; //rate reported by the device
+    bool hardwareTime = false; //stream times come from a hardware clock
+    bool timedBurst = false; //the TX stream runs timed bursts
+    bool relay = false; //the TX stream sends the RX blocks from the ring
+    size_t relayConsumer = 0;
+    size_t numDirectBuffs = 0; //direct access buffers, 0 runs the copy path only
+    BufferPool *pool = nullptr; //stream and pipeline buffers of the whole run
+    const TxWaveform *txWaveform = nullptr;
+    ReplaySource *replay = nullptr; //transmit from a mapped sample file instead of the tone
+    BlockRing *rxRing = nullptr; //full RX blocks are handed to the pipeline stages
+    const CaptureWriter *capture = nullptr;
+    const RxVerifier *verify = nullptr;
+    const ConvertStage *convert = nullptr;
+    const DspStage *dsp = nullptr;
+    RateTestReporter *reporter = nullptr; //structured records, nullptr for text only
+    std::unique_ptr<StreamStatusMonitor> status; //asynchronous flow events, runs alongside the stream thread
+
+    //live counters from the stream thread, the loop itself never prints
+    StreamPublisher pub;
+    clockid_t cpuClock = CLOCK_THREAD_CPUTIME_ID; //the stream thread's cpu clock, valid once started
+    double finalCpu = 0.0; //stream thread cpu seconds when the loop finished
+    EngineThreadStats threadStats; //scheduling cost of the stream's own thread, unused on the coroutine engine
+
+    //reporter thread state, baselines are taken when the warmup ends
+    bool measuring = false;
+    int64_t measureStartNs = 0;
+    uint64_t baseSamples = 0;
+    uint64_t baseOverflows = 0;
+    uint64_t baseUnderflows = 0;
+    uint64_t baseLost = 0;
+    uint64_t baseDropped = 0;
+    uint64_t baseStatusOverflows = 0; //events reported through readStreamStatus
+    uint64_t baseStatusUnderflows = 0;
+    int64_t lastPrintNs = 0;
+    uint64_t lastPrintSamples = 0;
+    uint64_t lastPrintOverflows = 0; //measured counts at the previous interval record
+    uint64_t lastPrintUnderflows = 0;
+    uint64_t lastPrintLost = 0;
+    int64_t lastSampleNs = 0;
+    uint64_t lastSampleCount = 0;
+    std::vector<double> rateSamples; //measured rate over each second, for the results store
+    int path = STREAM_PATH_COPY;
+    int64_t phaseStartNs = 0;
+    uint64_t phaseStartSamples = 0;
+    double phaseStartCpu = 0.0;
+    StreamPathStats pathStats[2];
+
+    //final results, complete once the reporter finished the stream
+    unsigned long long totalSamples = 0;
+    unsigned long long droppedBlocks = 0; //RX blocks that found the ring full
+    unsigned int overflows = 0;
+    unsigned int underflows = 0;
+    unsigned long long lostSamples = 0; //samples missing from the RX timestamps after the warmup
+    double elapsed = 0.0;
+    long majorFaults = 0; //page faults which waited on storage in the stream thread
+    unsigned long long replayPasses = 0;
+    StreamCallTiming timing;
+    std::string error; //the stream error which ended the loop
+    TimestampContinuity continuity;
+    std::vector<BurstTrial> trials;
+    LatencyHistogram burstSlack; //hardware time left before each burst when its first write returned
+    bool leadConverged = false;
+    double minLead = 0.0; //smallest timed burst lead in seconds without late bursts, 0 when none was found
+    unsigned long long relayBlocks = 0;
+    unsigned long long relayLate = 0; //blocks whose first write returned after their TX time
+    LatencyHistogram relayResidency; //from the RX commit until the last element was written
+    LatencyHistogram relaySlack; //hardware time left before the TX time when the first write returned
+};
+
+static RateTestRecord makeRecord(
+    const char *type,
+    const RateTestStream &rts,
+    const double time,
+    const double elapsed,
+    const unsigned long long samples,
+    const unsigned long long overflows,
+    const unsigned long long underflows,
+    const unsigned long long lostSamples,
+    const StreamCallTiming &timing)
+{
+    RateTestRecord r;
+    r.type = type;
+    r.device = rts.label;
+    r.direction = (rts.direction == SOAPY_SDR_RX)?"RX":"TX";
+    r.format = rts.format;
+    r.numChans = rts.numChans;
+    r.numElems = rts.numElems;
+    r.sampleRate = rts.sampleRate;
+    r.time = time;
+    r.rate = (elapsed > 0.0)?(samples/elapsed):0.0;
+    r.bytesRate = r.rate*rts.numChans*rts.elemSize;
+    r.samples = samples;
+    r.overflows = overflows;
+    r.underflows = underflows;
+    r.lostSamples = lostSamples;
+    const auto &lat = timing.latency;
+    if (lat.count() == 0) return r;
+    r.latencyP50 = lat.percentile(50)/1e3;
+    r.latencyP99 = lat.percentile(99)/1e3;
+    r.latencyP999 = lat.percentile(99.9)/1e3;
+    r.latencyMax = lat.max()/1e3;
+    return r;
+}
+
+static long threadMajorFaults(void)
+{
+    struct rusage usage;
+    if (getrusage(RUSAGE_THREAD, &usage) != 0) return 0;
+    return usage.ru_majflt;
+}
+
+//publish the thread's cpu clock before the reporter may read it
+static void startStreamPublisher(RateTestStream &rts)
+{
+    pthread_getcpuclockid(pthread_self(), &rts.cpuClock);
+    rts.pub.start(steadyNs());
+}
+
+static void finishStreamPublisher(RateTestStream &rts)
+{
+    rts.finalCpu = threadCpuTime();
+    rts.pub.finish(steadyNs());
+}
+
+static const unsigned long long ALLOC_SETTLE_CALLS = 100; //transfers before the loop counts as steady
+
+//a coroutine so the engine can multiplex several streams, with a default slot it runs straight through
+StreamTask runRateTestStreamLoop(const SoapySDRRateTestArgs &args, RateTestStream &rts, EngineSlot &slot)
+{
+    SoapySDR::Device *device = rts.device;
+    SoapySDR::Stream *stream = rts.stream;
+    const int direction = rts.direction;
+    const size_t numChans = rts.numChans;
+    const size_t elemSize = rts.elemSize;
+    const size_t numElems = rts.numElems;
+    const TxWaveform *txWaveform = rts.txWaveform;
+    const char *name = rts.name.c_str();
+    StreamPublisher &pub = rts.pub;
+    const long timeoutUs = slot.timeoutUs();
+
+    //a throwing stream call ends the loop like an error code, so the publisher still finishes for the reporter
+    try
+    {
+        //one arena holds every channel's buffer, each slice is cache line aligned
+        const auto buffMem = rts.pool->acquire(numChans, elemSize*numElems);
+        if (not buffMem->numaError().empty()) std::cerr << name << "Dir " << direction << " " << buffMem->numaError() << std::endl;
+        std::vector<void *> buffs(numChans);
+        for (size_t i = 0; i < numChans; i++) buffs[i] = buffMem->slice(i);
+
+        //transmit cycles through the precomputed waveform ring, every channel sends the same tone,
+        //or walks the mapped replay file and hands its pages to the driver without a copy
+        ReplaySource *replay = rts.replay;
+        const size_t txElems = (replay != nullptr)?replay->blockElems():(txWaveform != nullptr)?txWaveform->numElems():numElems;
+        size_t txIndex(0), txOffset(0);
+        unsigned long long replayPasses(0);
+        std::vector<const void *> txBuffs(numChans);
+
+        //receive blocks go straight into the pipeline ring, the arena is the overflow scratch
+        BlockRing *rxRing = rts.rxRing;
+        std::vector<void *> ringBuffs(numChans);
+        size_t ringFill(0);
+        long long ringTimeNs(0);
+        int ringFlags(0);
+        unsigned long long droppedBlocks(0);
+
+        //direct access buffers are owned by the driver, only the pointers live here
+        const size_t numDirectBuffs = rts.numDirectBuffs;
+        std::vector<void *> directBuffs(numChans);
+        std::vector<bool> directFilled(numDirectBuffs, false);
+
+        //hardware timestamps show exactly how many samples the driver dropped
+        const bool checkTime = (direction == SOAPY_SDR_RX and rts.hardwareTime);
+        TimestampContinuity continuity(rts.sampleRate);
+
+        unsigned long long totalSamples(0);
+        const long faultsStart = threadMajorFaults();
+        unsigned long long numCalls(0);
+        SteadyStateAllocations allocs(rts.name + ((direction == SOAPY_SDR_RX)?"RX":"TX") + " stream");
+        ThreadProfile prof(rts.name + ((direction == SOAPY_SDR_RX)?"RX":"TX") + " stream");
+
+        std::cout << "Starting stream " << name << direction << std::endl;
+        device->activateStream(stream);
+        startStreamPublisher(rts);
+
+        //only stream calls and relaxed counter stores from here on, the reporter does the rest
+        while (not loopDone)
+        {
+            int ret(0);
+            int flags(0);
+            long long timeNs(0);
+            size_t handle(0);
+            void * const *ringSlot(nullptr);
+            if (slot.polling()) allocs.pause();
+            co_await slot;
+            if (slot.polling()) allocs.resume();
+            prof.lap(PROFILE_SCHEDULING);
+            pub.poll();
+            const int path = pub.path();
+            prof.lap(PROFILE_STATUS_POLL);
+            const int64_t callStartNs = steadyNs();
+            if (path == STREAM_PATH_COPY) switch(direction)
+            {
+            case SOAPY_SDR_RX:
+                if (rxRing != nullptr and (ringSlot = rxRing->writeSlot()) != nullptr)
+                {
+                    for (size_t i = 0; i < numChans; i++) ringBuffs[i] = static_cast<char *>(ringSlot[i]) + ringFill*elemSize;
+                    ret = device->readStream(stream, ringBuffs.data(), numElems - ringFill, flags, timeNs, timeoutUs);
+                }
+                else ret = device->readStream(stream, buffs.data(), numElems, flags, timeNs, timeoutUs);
+                break;
+            case SOAPY_SDR_TX:
+                for (size_t i = 0; i < numChans; i++)
+                {
+                    const void *block = (replay != nullptr)?replay->channel(txIndex, i):txWaveform->buffer(txIndex);
+                    txBuffs[i] = static_cast<const char *>(block) + txOffset*elemSize;
+                }
+                ret = device->writeStream(stream, txBuffs.data(), txElems - txOffset, flags, timeNs, timeoutUs);
+                break;
+            }
+            else switch(direction)
+            {
+            case SOAPY_SDR_RX:
+                ret = device->acquireReadBuffer(stream, handle, const_cast<const void **>(directBuffs.data()), flags, timeNs, timeoutUs);
+                if (ret >= 0) device->releaseReadBuffer(stream, handle);
+                break;
+            case SOAPY_SDR_TX:
+                ret = device->acquireWriteBuffer(stream, handle, directBuffs.data(), timeoutUs);
+                if (ret < 0) break;
+                ret = std::min<int>(ret, txElems);
+                //fill each driver buffer with the waveform once, afterwards it is recycled untouched
+                if (handle < numDirectBuffs and not directFilled[handle])
+                {
+                    const void *src = txWaveform->buffer(handle);
+                    for (size_t i = 0; i < numChans; i++) std::memcpy(directBuffs[i], src, ret*elemSize);
+                    directFilled[handle] = true;
+                }
+                device->releaseWriteBuffer(stream, handle, ret, flags, timeNs);
+                break;
+            }
+            prof.lap(PROFILE_STREAM_CALL);
+
+            //polling returns at once when there is nothing to move, those calls would swamp the latency
+            if (ret != SOAPY_SDR_TIMEOUT or not slot.polling()) pub.timing().record(callStartNs, steadyNs());
+            prof.lap(PROFILE_ACCOUNTING);
+
+            if (ret == SOAPY_SDR_TIMEOUT)
+            {
+                slot.markIdle();
+                continue;
+            }
+            if (ret == SOAPY_SDR_OVERFLOW)
+            {
+                pub.addOverflow();
+                continue;
+            }
+            if (ret == SOAPY_SDR_UNDERFLOW)
+            {
+                pub.addUnderflow();
+                continue;
+            }
+            if (ret < 0)
+            {
+                rts.error = SoapySDR::errToStr(ret);
+                break;
+            }
+            totalSamples += ret;
+            pub.publishSamples(totalSamples);
+            if (++numCalls == ALLOC_SETTLE_CALLS) allocs.begin();
+            if (checkTime and (flags & SOAPY_SDR_HAS_TIME) != 0)
+            {
+                continuity.update(timeNs, size_t(ret));
+                pub.publishLost(continuity.lostSamples());
+            }
+            prof.lap(PROFILE_ACCOUNTING);
+
+            //only whole blocks are published so every file and stage sees fixed size blocks
+            if (rxRing != nullptr and direction == SOAPY_SDR_RX)
+            {
+                if (ringSlot == nullptr) pub.publishDropped(++droppedBlocks);
+                else
+                {
+                    if (ringFill == 0)
+                    {
+                        ringTimeNs = timeNs;
+                        ringFlags = flags;
+                    }
+                    ringFill += ret;
+                    if (ringFill >= numElems)
+                    {
+                        rxRing->commit(ringFill, ringTimeNs, ringFlags, steadyNs());
+                        ringFill = 0;
+                    }
+                }
+                prof.lap(PROFILE_HANDOFF);
+            }
+
+            //partial writes resume from the same ring position to keep the phase continuous
+            if (direction == SOAPY_SDR_TX and path == STREAM_PATH_COPY)
+            {
+                txOffset += ret;
+                if (txOffset >= txElems)
+                {
+                    txOffset = 0;
+                    txIndex++;
+                }
+                if (replay != nullptr and txOffset == 0)
+                {
+                    if (txIndex == replay->numBlocks())
+                    {
+                        txIndex = 0;
+                        replayPasses++;
+                        if (args.replayLoops != 0 and replayPasses >= args.replayLoops) loopDone = true;
+                    }
+                    replay->prefetch(txIndex);
+                }
+            }
+
+            //a sample limited run stops each stream on its own count
+            if (pub.limitReached(totalSamples)) break;
+            prof.lap(PROFILE_ACCOUNTING);
+        }
+
+        allocs.end();
+        prof.end();
+        rts.majorFaults = threadMajorFaults() - faultsStart;
+        rts.replayPasses = replayPasses;
+        rts.continuity = continuity;
+    }
+    catch (const std::exception &ex)
+    {
+        rts.error = ex.what();
+    }
+    finishStreamPublisher(rts);
+
+    if (not rts.error.empty()) std::cerr << "Unexpected stream error " << name << rts.error << std::endl;
+    if (not pub.started()) co_return; //it failed before activating
+    std::cout << "deactivate " << name << direction << std::endl;
+    device->deactivateStream(stream);
+}
+
+/***********************************************************************
+ * Timed burst transmit and the search for the smallest sustainable lead
+ **********************************************************************/
+static const size_t BURST_TRIAL_COUNT = 500; //bursts per lead trial
+static const double BURST_MIN_LEAD = 10e-6;
+static const double BURST_MAX_LEAD = 1.0;
+static const int64_t BURST_REPORT_SETTLE_NS = 10000000; //time for a late report after the last burst
+
+//offset from the monotonic clock to the hardware clock, bracketed by two reads
+static long long hardwareTimeOffset(SoapySDR::Device *device)
+{
+    const int64_t before = steadyNs();
+    const long long hwTime = device->getHardwareTime();
+    const int64_t after = steadyNs();
+    return hwTime - (before + after)/2;
+}
+
+struct LeadSearch
+{
+    double good = 0.0; //smallest lead which had no late bursts
+    double bad = 0.0; //largest lead which had late bursts
+
+    bool converged(void) const
+    {
+        if (good == 0.0) return bad >= BURST_MAX_LEAD;
+        if (bad == 0.0) return good <= BURST_MIN_LEAD;
+        return good/bad < 1.1 or good - bad < BURST_MIN_LEAD;
+    }
+
+    //doubles until a lead passes, halves until one fails, then bisects,
+    //after converging every further trial holds the best lead to prove it
+    double next(const double lead, const bool passed)
+    {
+        if (passed) good = (good == 0.0)?lead:std::min(good, lead);
+        else
+        {
+            bad = std::max(bad, lead);
+            if (lead >= good) good = 0.0; //it passed before by luck, search upwards again
+        }
+        if (this->converged()) return (good != 0.0)?good:BURST_MAX_LEAD;
+        if (good == 0.0) return std::min(lead*2, BURST_MAX_LEAD);
+        if (bad == 0.0) return std::max(lead/2, BURST_MIN_LEAD);
+        return (good + bad)/2;
+    }
+};
+
+void runTimedBurstLoop(const SoapySDRRateTestArgs &args, RateTestStream &rts)
+{
+    SoapySDR::Device *device = rts.device;
+    SoapySDR::Stream *stream = rts.stream;
+    const char *name = rts.name.c_str();
+    const size_t numChans = rts.numChans;
+    const size_t elemSize = rts.elemSize;
+    const double rate = rts.sampleRate;
+    StreamPublisher &pub = rts.pub;
+
+    try
+    {
+        //one block per burst on a 50% duty grid, bursts are sent one lead ahead of their time
+        const size_t burstElems = rts.numElems;
+        const size_t numBlocks = (rts.replay != nullptr)?rts.replay->numBlocks():rts.txWaveform->numBuffers();
+        const long long burstPeriodNs = SoapySDR::ticksToTimeNs(2*burstElems, rate);
+        const size_t mtu = device->getStreamMTU(stream);
+        std::vector<const void *> txBuffs(numChans);
+        LeadSearch search;
+        double lead = args.burstLead;
+        unsigned long long totalSamples(0);
+        size_t blockIndex(0);
+        rts.trials.reserve(1024);
+
+        std::cout << "Starting timed bursts " << name << SOAPY_SDR_TX << ": " << burstElems << " elements every "
+            << (burstPeriodNs/1e3) << " us, initial lead " << (lead*1e6) << " us" << std::endl;
+        device->activateStream(stream);
+        startStreamPublisher(rts);
+
+        while (not loopDone)
+        {
+            //each trial resynchronizes the clocks and starts its grid one lead ahead
+            const long long offsetNs = hardwareTimeOffset(device);
+            const long long leadNs = (long long)(lead*1e9);
+            long long burstTimeNs = steadyNs() + offsetNs + leadNs + burstPeriodNs;
+            BurstTrial trial;
+            trial.lead = lead;
+            const uint64_t lateReports = rts.status->timeErrors();
+
+            for (; trial.bursts < BURST_TRIAL_COUNT and not loopDone; trial.bursts++, burstTimeNs += burstPeriodNs)
+            {
+                const int64_t sendAtNs = burstTimeNs - offsetNs - leadNs;
+                while (steadyNs() < sendAtNs) std::this_thread::sleep_for(std::chrono::nanoseconds(sendAtNs - steadyNs()));
+
+                pub.poll();
+                const size_t block = (blockIndex++)%numBlocks;
+                size_t sent(0);
+                while (sent < burstElems and not loopDone)
+                {
+                    for (size_t i = 0; i < numChans; i++)
+                    {
+                        const void *src = (rts.replay != nullptr)?rts.replay->channel(block, i):rts.txWaveform->buffer(block);
+                        txBuffs[i] = static_cast<const char *>(src) + sent*elemSize;
+                    }
+                    //only the write which can take the rest of the burst ends it
+                    int flags = ((sent == 0)?SOAPY_SDR_HAS_TIME:0) | ((burstElems - sent <= mtu)?SOAPY_SDR_END_BURST:0);
+                    const int ret = device->writeStream(stream, txBuffs.data(), burstElems - sent, flags, burstTimeNs);
+                    if (ret == SOAPY_SDR_TIMEOUT) continue;
+                    if (ret == SOAPY_SDR_TIME_ERROR)
+                    {
+                        trial.late++;
+                        break;
+                    }
+                    if (ret < 0)
+                    {
+                        rts.error = SoapySDR::errToStr(ret);
+                        loopDone = true;
+                        break;
+                    }
+                    if (sent == 0)
+                    {
+                        const long long marginNs = burstTimeNs - (steadyNs() + offsetNs);
+                        if (marginNs > 0) rts.burstSlack.record(uint64_t(marginNs));
+                        else trial.hostLate++;
+                    }
+                    sent += ret;
+                }
+                totalSamples += sent;
+                pub.publishSamples(totalSamples);
+            }
+
+            //late reports arrive through the status monitor, give the last burst time to be reported
+            const int64_t settledNs = burstTimeNs - offsetNs + burstPeriodNs + BURST_REPORT_SETTLE_NS;
+            while (steadyNs() < settledNs and not loopDone) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            trial.late += rts.status->timeErrors() - lateReports;
+
+            if (trial.bursts == 0) break;
+            rts.trials.push_back(trial);
+            if (not loopDone) lead = search.next(lead, trial.late == 0);
+        }
+
+        rts.minLead = search.good;
+        rts.leadConverged = search.converged();
+    }
+    catch (const std::exception &ex)
+    {
+        rts.error = ex.what();
+    }
+    finishStreamPublisher(rts);
+
+    if (not rts.error.empty()) std::cerr << "Unexpected stream error " << name << rts.error << std::endl;
+    if (not pub.started()) return; //it failed before activating
+    std::cout << "deactivate " << name << SOAPY_SDR_TX << std::endl;
+    device->deactivateStream(stream);
+}
+
+static void printTimedBurstSummary(const RateTestStream &rts)
+{
+    const char *name = rts.name.c_str();
+    unsigned long long bursts(0), late(0), hostLate(0);
+    printf("  %sDir %d lead search:\n", name, SOAPY_SDR_TX);
+    for (const auto &trial : rts.trials)
+    {
+        printf("    lead %8.1f us: %llu bursts, %llu late (%.2f%%), %llu sent after their time\n",
+            trial.lead*1e6, trial.bursts, trial.late, 100.0*trial.late/trial.bursts, trial.hostLate);
+        bursts += trial.bursts;
+        late += trial.late;
+        hostLate += trial.hostLate;
+    }
+    printf("  %sDir %d timed bursts: %llu sent, %llu late (%.3f%%), %llu written after their time\n", name, SOAPY_SDR_TX,
+        bursts, late, (bursts != 0)?(100.0*late/bursts):0.0, hostLate);
+    const auto &slack = rts.burstSlack;
+    if (slack.count() != 0)
+    {
+        printf("  %sDir %d write slack us: min %.1f  p0.1 %.1f  p50 %.1f\n", name, SOAPY_SDR_TX,
+            slack.percentile(0)/1e3, slack.percentile(0.1)/1e3, slack.percentile(50)/1e3);
+    }
+    if (rts.minLead != 0.0) printf("  %sDir %d minimum sustainable lead: %.1f us%s\n", name, SOAPY_SDR_TX,
+        rts.minLead*1e6, rts.leadConverged?"":" (search not finished)");
+    else printf("  %sDir %d no sustainable lead found\n", name, SOAPY_SDR_TX);
+}
+
+/***********************************************************************
+ * Relay: the TX stream writes the RX blocks straight out of the ring
+ **********************************************************************/
+static const int RELAY_SPIN_YIELDS = 64; //polls of an empty ring before sleeping
+
+void runRelayLoop(const SoapySDRRateTestArgs &args, RateTestStream &rts)
+{
+    SoapySDR::Device *device = rts.device;
+    SoapySDR::Stream *stream = rts.stream;
+    const char *name = rts.name.c_str();
+    const size_t numChans = rts.numChans;
+    const size_t elemSize = rts.elemSize;
+    BlockRing &ring = *rts.rxRing;
+    const size_t consumer = rts.relayConsumer;
+    StreamPublisher &pub = rts.pub;
+
+    try
+    {
+        //with hardware time each block leaves one lead after it arrived, the lead is the air to air latency
+        const bool timed = rts.hardwareTime;
+        const long long leadNs = (long long)(args.relayLead*1e9);
+        std::vector<const void *> txBuffs(numChans);
+        unsigned long long totalSamples(0);
+        int idle(0);
+        SteadyStateAllocations allocs(rts.name + "relay");
+        ThreadProfile prof(rts.name + "relay");
+
+        std::cout << "Starting relay " << name << SOAPY_SDR_TX;
+        if (timed) std::cout << ": lead " << (leadNs/1e3) << " us after the RX time" << std::endl;
+        else std::cout << ": no hardware time, blocks are sent as they arrive" << std::endl;
+        device->activateStream(stream);
+        startStreamPublisher(rts);
+        const long long offsetNs = timed?hardwareTimeOffset(device):0;
+
+        //blocks which arrived before the TX stream started are already late
+        BlockRing::BlockInfo info;
+        while (ring.readSlot(consumer, info) != nullptr) ring.release(consumer);
+
+        while (not loopDone)
+        {
+            prof.lap(PROFILE_SCHEDULING);
+            pub.poll();
+            prof.lap(PROFILE_STATUS_POLL);
+            void * const *slot = ring.readSlot(consumer, info);
+            if (slot == nullptr)
+            {
+                if (++idle < RELAY_SPIN_YIELDS) std::this_thread::yield();
+                else std::this_thread::sleep_for(std::chrono::microseconds(10));
+                prof.lap(PROFILE_IDLE);
+                continue;
+            }
+            idle = 0;
+            prof.lap(PROFILE_HANDOFF);
+
+            const bool hasTime = timed and (info.flags & SOAPY_SDR_HAS_TIME) != 0;
+            const long long txTimeNs = info.timeNs + leadNs;
+            size_t sent(0);
+            while (sent < info.numElems and not loopDone)
+            {
+                for (size_t i = 0; i < numChans; i++) txBuffs[i] = static_cast<const char *>(slot[i]) + sent*elemSize;
+                int flags = (hasTime and sent == 0)?SOAPY_SDR_HAS_TIME:0;
+                const int64_t callStartNs = steadyNs();
+                prof.lap(PROFILE_ACCOUNTING);
+                const int ret = device->writeStream(stream, txBuffs.data(), info.numElems - sent, flags, txTimeNs);
+                prof.lap(PROFILE_STREAM_CALL);
+                const int64_t callEndNs = steadyNs();
+                pub.timing().record(callStartNs, callEndNs);
+                if (ret == SOAPY_SDR_TIMEOUT) continue;
+                if (ret == SOAPY_SDR_UNDERFLOW)
+                {
+                    pub.addUnderflow();
+                    continue;
+                }
+                if (ret < 0)
+                {
+                    rts.error = SoapySDR::errToStr(ret);
+                    break;
+                }
+                if (sent == 0 and hasTime)
+                {
+                    const long long slackNs = txTimeNs - (callEndNs + offsetNs);
+                    if (slackNs > 0) rts.relaySlack.record(uint64_t(slackNs));
+                    else rts.relayLate++;
+                }
+                sent += ret;
+                totalSamples += ret;
+                pub.publishSamples(totalSamples);
+            }
+            rts.relayResidency.record(uint64_t(std::max<int64_t>(0, steadyNs() - info.hostNs)));
+            rts.relayBlocks++;
+            prof.lap(PROFILE_ACCOUNTING);
+            ring.release(consumer);
+            prof.lap(PROFILE_HANDOFF);
+            if (not rts.error.empty() or pub.limitReached(totalSamples)) break;
+            allocs.begin();
+        }
+        allocs.end();
+        prof.end();
+    }
+    catch (const std::exception &ex)
+    {
+        rts.error = ex.what();
+    }
+    finishStreamPublisher(rts);
+
+    if (not rts.error.empty()) std::cerr << "Unexpected stream error " << name << rts.error << std::endl;
+    if (not pub.started()) return; //it failed before activating
+    std::cout << "deactivate " << name << SOAPY_SDR_TX << std::endl;
+    device->deactivateStream(stream);
+}
+
+/***********************************************************************
+ * Reporter thread: the only place stream statistics are printed
+ **********************************************************************/
+static const int64_t REPORT_PERIOD_NS = 5000000000LL;
+static const int64_t RATE_SAMPLE_NS = 1000000000LL;
+static const int64_t SPIN_PERIOD_NS = 300000000LL;
+
+//cpu seconds of a stream thread, the recorded value once it finished
+static double streamCpuTime(const RateTestStream &rts)
+{
+    struct timespec ts;
+    if (not rts.pub.finished() and clock_gettime(rts.cpuClock, &ts) == 0) return ts.tv_sec + ts.tv_nsec*1e-9;
+    return rts.pub.finished()?rts.finalCpu:0.0;
+}
+
+//flow events returned by the stream calls plus those only reported asynchronously
+static uint64_t measuredOverflows(const RateTestStream &rts)
+{
+    return rts.pub.overflows() - rts.baseOverflows + rts.status->overflows() - rts.baseStatusOverflows;
+}
+
+static uint64_t measuredUnderflows(const RateTestStream &rts)
+{
+    return rts.pub.underflows() - rts.baseUnderflows + rts.status->underflows() - rts.baseStatusUnderflows;
+}
+
+//the warmup ends here, everything counted so far becomes the baseline
+static void beginMeasurement(const SoapySDRRateTestArgs &args, RateTestStream &rts, const int64_t nowNs)
+{
+    auto &pub = rts.pub;
+    const bool warmup = (args.warmup > 0.0);
+    rts.measuring = true;
+    rts.measureStartNs = warmup?nowNs:pub.startNs();
+    rts.baseSamples = warmup?pub.samples():0;
+    rts.baseOverflows = warmup?pub.overflows():0;
+    rts.baseUnderflows = warmup?pub.underflows():0;
+    rts.baseLost = warmup?pub.lostSamples():0;
+    rts.baseDropped = warmup?pub.droppedBlocks():0;
+    rts.baseStatusOverflows = warmup?rts.status->overflows():0;
+    rts.baseStatusUnderflows = warmup?rts.status->underflows():0;
+    rts.lastPrintNs = rts.phaseStartNs = rts.measureStartNs;
+    rts.lastPrintSamples = rts.phaseStartSamples = rts.baseSamples;
+    rts.lastPrintOverflows = rts.lastPrintUnderflows = rts.lastPrintLost = 0;
+    rts.lastSampleNs = rts.measureStartNs;
+    rts.lastSampleCount = rts.baseSamples;
+    rts.phaseStartCpu = streamCpuTime(rts);
+    if (warmup)
+    {
+        pub.collectTiming().reset();
+        if (args.numSamples != 0) pub.setLimit(rts.baseSamples + args.numSamples);
+    }
+}
+
+//close the running copy or direct phase and switch to the other path
+static void rotateStreamPath(RateTestStream &rts, const int64_t nowNs, const uint64_t samples, const bool next)
+{
+    const double cpuNow = streamCpuTime(rts);
+    auto &st = rts.pathStats[rts.path];
+    st.samples += samples - rts.phaseStartSamples;
+    st.elapsed += (nowNs - rts.phaseStartNs)/1e9;
+    st.cpuTime += cpuNow - rts.phaseStartCpu;
+    rts.phaseStartNs = nowNs;
+    rts.phaseStartSamples = samples;
+    rts.phaseStartCpu = cpuNow;
+    if (not next) return;
+    rts.path = (rts.path == STREAM_PATH_COPY)?STREAM_PATH_DIRECT:STREAM_PATH_COPY;
+    rts.pub.requestPath(rts.path);
+}
+
+static void reportInterval(RateTestStream &rts, const int64_t nowNs)
+{
+    const char *name = rts.name.c_str();
+    const int direction = rts.direction;
+    auto &pub = rts.pub;
+    const uint64_t samples = pub.samples();
+    const uint64_t overflows = measuredOverflows(rts);
+    const uint64_t underflows = measuredUnderflows(rts);
+    const uint64_t lost = pub.lostSamples() - rts.baseLost;
+    const uint64_t dropped = pub.droppedBlocks() - rts.baseDropped;
+    const double timePassed = (nowNs - rts.measureStartNs)/1e9;
+    const double sampleRate = (samples - rts.baseSamples)/timePassed;
+
+    printf("\b%g Msps\t%g MBps - %sDir %d", sampleRate/1e6, sampleRate*rts.numChans*rts.elemSize/1e6, name, direction);
+    if (overflows != 0) printf("\tOverflows %llu", (unsigned long long)overflows);
+    if (underflows != 0) printf("\tUnderflows %llu", (unsigned long long)underflows);
+    if (lost != 0) printf("\tLost %llu", (unsigned long long)lost);
+    if (rts.numDirectBuffs != 0)
+    {
+        const double phaseTime = (nowNs - rts.phaseStartNs)/1e9;
+        printf("\t%s path %g Msps", streamPathName(rts.path), (samples - rts.phaseStartSamples)/phaseTime/1e6);
+    }
+    if (rts.rxRing != nullptr)
+    {
+        printf("\tRing %zu/%zu", rts.rxRing->highWater(), rts.rxRing->numSlots());
+        if (dropped != 0) printf("\tDropped %llu", (unsigned long long)dropped);
+    }
+    if (rts.capture != nullptr)
+    {
+        printf("\tDisk %g MBps", rts.capture->bytesWritten()/1e6/timePassed);
+    }
+    if (rts.verify != nullptr)
+    {
+        printf("\tVerified %llu", (unsigned long long)rts.verify->checkedBlocks());
+        if (rts.verify->badBlocks() != 0) printf("\tBad %llu", (unsigned long long)rts.verify->badBlocks());
+    }
+    if (rts.convert != nullptr)
+    {
+        printf("\t%s %g Msps", rts.convert->targetFormat().c_str(), rts.convert->convertedSamples()/1e6/timePassed);
+    }
+    if (rts.dsp != nullptr)
+    {
+        printf("\tDSP load %g", rts.dsp->load());
+    }
+    printf("\n");
+
+    auto &interval = pub.collectTiming();
+    printCallTiming(name, direction, "interval", interval);
+    if (rts.reporter != nullptr)
+    {
+        rts.reporter->write(makeRecord("interval", rts, timePassed, (nowNs - rts.lastPrintNs)/1e9,
+            samples - rts.lastPrintSamples, overflows - rts.lastPrintOverflows, underflows - rts.lastPrintUnderflows,
+            lost - rts.lastPrintLost, interval));
+    }
+    rts.timing.merge(interval);
+    interval.reset();
+    rts.lastPrintNs = nowNs;
+    rts.lastPrintSamples = samples;
+    rts.lastPrintOverflows = overflows;
+    rts.lastPrintUnderflows = underflows;
+    rts.lastPrintLost = lost;
+    printf(" ");
+    fflush(stdout);
+
+    //alternate between the copy and direct paths on every print interval
+    if (rts.numDirectBuffs != 0) rotateStreamPath(rts, nowNs, samples, true);
+}
+
+static void runReporterLoop(const SoapySDRRateTestArgs &args, const std::vector<RateTestStream *> &streams, const std::atomic<bool> &done)
+{
+    const bool spinner = (streams.empty() or streams.front()->reporter == nullptr) and isatty(STDOUT_FILENO);
+    int64_t lastSpinNs = steadyNs();
+    int spinIndex(0);
+
+    while (not done)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        const int64_t nowNs = steadyNs();
+
+        for (auto *rts : streams)
+        {
+            if (not rts->pub.started() or rts->pub.finished()) continue;
+            if (not rts->measuring and nowNs - rts->pub.startNs() >= int64_t(args.warmup*1e9)) beginMeasurement(args, *rts, nowNs);
+            if (rts->measuring and nowNs - rts->lastPrintNs >= REPORT_PERIOD_NS) reportInterval(*rts, nowNs);
+            if (rts->measuring and nowNs - rts->lastSampleNs >= RATE_SAMPLE_NS)
+            {
+                const uint64_t samples = rts->pub.samples();
+                rts->rateSamples.push_back((samples - rts->lastSampleCount)/((nowNs - rts->lastSampleNs)/1e9));
+                rts->lastSampleNs = nowNs;
+                rts->lastSampleCount = samples;
+            }
+        }
+
+        if (spinner and nowNs - lastSpinNs >= SPIN_PERIOD_NS)
+        {
+            lastSpinNs = nowNs;
+            static const char spin[] = {"|/-\\"};
+            printf("\b%c", spin[(spinIndex++)%4]);
+            fflush(stdout);
+        }
+    }
+}
+
+static const int64_t STATUS_GROUP_GAP_NS = 10000000; //events of one kind closer than this form one burst
+static const size_t STATUS_TIMELINE_LINES = 20;
+
+//flow events grouped into bursts of one kind, host times are relative to the stream start
+static void printStatusTimeline(const RateTestStream &rts)
+{
+    const char *name = rts.name.c_str();
+    const int direction = rts.direction;
+    const auto &status = *rts.status;
+    if (not status.error().empty()) printf("  %sDir %d status monitor: %s\n", name, direction, status.error().c_str());
+    if (status.numEvents() == 0) return;
+
+    struct EventBurst
+    {
+        const StreamStatusEvent *first;
+        const StreamStatusEvent *last;
+        size_t count;
+        size_t chanMask;
+    };
+    const auto events = status.events();
+    std::vector<EventBurst> bursts;
+    for (const auto &ev : events)
+    {
+        if (not bursts.empty() and bursts.back().first->code == ev.code and ev.hostNs - bursts.back().last->hostNs < STATUS_GROUP_GAP_NS)
+        {
+            auto &b = bursts.back();
+            b.last = &ev;
+            b.count++;
+            b.chanMask |= ev.chanMask;
+        }
+        else bursts.push_back(EventBurst{&ev, &ev, 1, ev.chanMask});
+    }
+
+    printf("  %sDir %d status events: %llu overflows, %llu underflows, %llu late, %zu of %llu kept\n", name, direction,
+        (unsigned long long)status.overflows(), (unsigned long long)status.underflows(),
+        (unsigned long long)status.timeErrors(), events.size(), (unsigned long long)status.numEvents());
+    const size_t skip = (bursts.size() > STATUS_TIMELINE_LINES)?(bursts.size() - STATUS_TIMELINE_LINES):0;
+    if (skip != 0) printf("    ... %zu earlier bursts\n", skip);
+    for (size_t i = skip; i < bursts.size(); i++)
+    {
+        const auto &b = bursts[i];
+        printf("    %+10.3f s  %-10s x%-6zu over %8.3f ms  chans 0x%zx", (b.first->hostNs - rts.pub.startNs())/1e9,
+            SoapySDR::errToStr(b.first->code), b.count, (b.last->hostNs - b.first->hostNs)/1e6, b.chanMask);
+        if ((b.first->flags & SOAPY_SDR_HAS_TIME) != 0) printf("  hw %.6f s", b.first->timeNs/1e9);
+        printf("\n");
+    }
+}
+
+//fold in what is left once the stream thread has been joined
+static void collectStreamTotals(RateTestStream &rts)
+{
+    auto &pub = rts.pub;
+    auto &last = pub.collectTiming();
+
+    //a short run can end before the reporter began measuring, it counts from the stream start
+    if (not rts.measuring and pub.started())
+    {
+        rts.measuring = true;
+        rts.measureStartNs = rts.phaseStartNs = pub.startNs();
+    }
+    if (rts.measuring)
+    {
+        rts.timing.merge(last);
+        rts.totalSamples = pub.samples() - rts.baseSamples;
+        rts.overflows = (unsigned int)measuredOverflows(rts);
+        rts.underflows = (unsigned int)measuredUnderflows(rts);
+        rts.droppedBlocks = pub.droppedBlocks() - rts.baseDropped;
+        rts.lostSamples = pub.lostSamples() - rts.baseLost;
+        rts.elapsed = (pub.stopNs() - rts.measureStartNs)/1e9;
+    }
+    last.reset();
+}
+
+//the totals of a joined stream thread and their printout
+static void finishStreamReport(RateTestStream &rts)
+{
+    const char *name = rts.name.c_str();
+    const int direction = rts.direction;
+    auto &pub = rts.pub;
+    if (not pub.started()) return;
+    collectStreamTotals(rts);
+
+    if (rts.timedBurst)
+    {
+        printTimedBurstSummary(rts);
+        printStatusTimeline(rts);
+        fflush(stdout);
+        return;
+    }
+    printCallTiming(name, direction, "total", rts.timing);
+    if (direction == SOAPY_SDR_RX and rts.hardwareTime)
+    {
+        const auto &ts = rts.continuity;
+        printf("  %sDir %d timestamps: %llu blocks, %llu samples lost in %llu gaps (max %llu), %llu overlaps\n",
+            name, direction, (unsigned long long)ts.blocks(), (unsigned long long)ts.lostSamples(),
+            (unsigned long long)ts.gaps(), (unsigned long long)ts.maxGap(), (unsigned long long)ts.overlaps());
+    }
+    printStatusTimeline(rts);
+    fflush(stdout);
+
+    //side by side summary of the copy and direct access paths
+    if (rts.numDirectBuffs == 0 or not rts.measuring) return;
+    rotateStreamPath(rts, pub.stopNs(), pub.samples(), false);
+    double rates[2] = {0.0, 0.0};
+    printf("\n%sDir %d path comparison (%zu direct buffers):\n", name, direction, rts.numDirectBuffs);
+    for (int p = STREAM_PATH_COPY; p <= STREAM_PATH_DIRECT; p++)
+    {
+        const auto &st = rts.pathStats[p];
+        if (st.elapsed <= 0.0 or st.samples == 0)
+        {
+            printf("  %-6s  no samples\n", streamPathName(p));
+            continue;
+        }
+        rates[p] = st.samples/st.elapsed;
+        printf("  %-6s  %10g Msps  %10g MBps  %8.2f ns/sample cpu  %6.1f%% cpu\n", streamPathName(p),
+            rates[p]/1e6, rates[p]*rts.numChans*rts.elemSize/1e6, 1e9*st.cpuTime/st.samples, 100.0*st.cpuTime/st.elapsed);
+    }
+    if (rates[STREAM_PATH_COPY] > 0.0 and rates[STREAM_PATH_DIRECT] > 0.0)
+    {
+        const auto &copy = rts.pathStats[STREAM_PATH_COPY];
+        const auto &direct = rts.pathStats[STREAM_PATH_DIRECT];
+        printf("  direct vs copy: %+.1f%% throughput, %+.2f ns/sample cpu\n",
+            100.0*(rates[STREAM_PATH_DIRECT]/rates[STREAM_PATH_COPY] - 1.0),
+            1e9*(direct.cpuTime/direct.samples - copy.cpuTime/copy.samples));
+    }
+    fflush(stdout);
+}
+
+/***********************************************************************
+ * Transfer size sweep over element counts and stream arguments
+ **********************************************************************/
+static const double SWEEP_WARMUP = 0.25; //seconds discarded at the start of every trial
+
+struct SweepPoint
+{
+    std::string streamArgs;
+    size_t numElems = 0;
+    double rate = 0.0; //samples per second
+    double cpu = 0.0; //fraction of one core spent in the stream calls
+    double eventRate = 0.0; //overflows or underflows per second
+    double p99 = 0.0; //call latency in ns
+    std::string error;
+};
+
+//count the flow events reported asynchronously, mostly TX underflows
+static unsigned long long drainStreamEvents(SoapySDR::Device *device, SoapySDR::Stream *stream)
+{
+    unsigned long long events(0);
+    size_t chanMask; int flags; long long timeNs;
+    while (true)
+    {
+        const int ret = device->readStreamStatus(stream, chanMask, flags, timeNs, 0);
+        if (ret == SOAPY_SDR_OVERFLOW or ret == SOAPY_SDR_UNDERFLOW) events++;
+        else if (ret != 0) break;
+    }
+    return events;
+}
+
+//one short trial of a fresh stream, numElems of 0 transfers the stream MTU
+static SweepPoint runSweepTrial(
+    const SoapySDRRateTestArgs &args,
+    SoapySDR::Device *device,
+    const int direction,
+    const std::string &format,
+    const std::vector<size_t> &channels,
+    const std::string &streamArgs,
+    const size_t numElems,
+    BufferPool &pool)
+{
+    SweepPoint point;
+    point.streamArgs = streamArgs;
+
+    SoapySDR::Stream *stream(nullptr);
+    try
+    {
+        stream = device->setupStream(direction, format, channels, SoapySDR::KwargsFromString(streamArgs));
+    }
+    catch (const std::exception &ex)
+    {
+        point.numElems = numElems;
+        point.error = ex.what();
+        return point;
+    }
+
+    //the buffers stay zero filled, transmit sends silence
+    point.numElems = (numElems != 0)?numElems:device->getStreamMTU(stream);
+    const auto buffMem = pool.acquire(channels.size(), point.numElems*SoapySDR::formatToSize(format));
+    std::vector<void *> buffs(channels.size());
+    for (size_t i = 0; i < buffs.size(); i++) buffs[i] = buffMem->slice(i);
+
+    LatencyHistogram latency;
+    unsigned long long samples(0), events(0);
+    const int64_t warmupEnd = steadyNs() + int64_t(SWEEP_WARMUP*1e9);
+    int64_t trialStart(0), trialEnd(0);
+    double cpuStart(0.0), cpuTime(0.0);
+    bool measuring(false);
+
+    device->activateStream(stream);
+    while (not loopDone)
+    {
+        int flags(0);
+        long long timeNs(0);
+        const int64_t callStart = steadyNs();
+        if (not measuring and callStart >= warmupEnd)
+        {
+            drainStreamEvents(device, stream);
+            measuring = true;
+            trialStart = callStart;
+            trialEnd = callStart + int64_t(args.sweepTime*1e9);
+            cpuStart = threadCpuTime();
+            samples = events = 0;
+            latency.reset();
+        }
+        if (measuring and callStart >= trialEnd) break;
+
+        const int ret = (direction == SOAPY_SDR_RX)?
+            device->readStream(stream, buffs.data(), point.numElems, flags, timeNs):
+            device->writeStream(stream, buffs.data(), point.numElems, flags, timeNs);
+        latency.record(uint64_t(steadyNs() - callStart));
+        if (ret == SOAPY_SDR_TIMEOUT) continue;
+        if (ret == SOAPY_SDR_OVERFLOW or ret == SOAPY_SDR_UNDERFLOW)
+        {
+            events++;
+            continue;
+        }
+        if (ret < 0)
+        {
+            point.error = SoapySDR::errToStr(ret);
+            break;
+        }
+        samples += ret;
+    }
+    const int64_t stopNs = steadyNs();
+    if (measuring) cpuTime = threadCpuTime() - cpuStart;
+    events += drainStreamEvents(device, stream);
+    device->deactivateStream(stream);
+    device->closeStream(stream);
+
+    const double elapsed = (stopNs - trialStart)/1e9;
+    if (not measuring or elapsed <= 0.0) return point;
+    point.rate = samples/elapsed;
+    point.cpu = cpuTime/elapsed;
+    point.eventRate = events/elapsed;
+    point.p99 = latency.percentile(99);
+    return point;
+}
+
+//the fastest point without flow events, near ties go to the lowest cpu per sample
+static const SweepPoint *bestSweepPoint(const std::vector<SweepPoint> &points)
+{
+    double bestRate(0.0);
+    for (const auto &p : points)
+    {
+        if (p.error.empty() and p.eventRate == 0.0) bestRate = std::max(bestRate, p.rate);
+    }
+    const SweepPoint *best(nullptr);
+    for (const auto &p : points)
+    {
+        if (not p.error.empty() or p.eventRate != 0.0 or p.rate <= 0.0 or p.rate < 0.99*bestRate) continue;
+        if (best == nullptr or p.cpu/p.rate < best->cpu/best->rate) best = &p;
+    }
+    return best;
+}
+
+//true when at least one point streamed
+static bool runTransferSweep(
+    const SoapySDRRateTestArgs &args,
+    const std::vector<size_t> &channels,
+    SoapySDR::Device *device,
+    const std::string &label)
+{
+    bool streamed(false);
+    std::vector<std::string> streamArgsList(args.sweepStreamArgs);
+    if (streamArgsList.empty()) streamArgsList.push_back(args.streamArgs);
+    BufferPool pool(args.hugePages, args.numaNode);
+
+    for (const int direction : {SOAPY_SDR_RX, SOAPY_SDR_TX})
+    {
+        const char *dirName = (direction == SOAPY_SDR_RX)?"RX":"TX";
+        double fullScale(0.0);
+        const auto format = args.formatStr.empty()?device->getNativeStreamFormat(direction, channels.front(), fullScale):args.formatStr;
+        std::vector<SweepPoint> points;
+        for (const auto &streamArgs : streamArgsList)
+        {
+            //without a list the sweep spans the MTU these stream args give
+            std::vector<size_t> elemsList(args.sweepElems);
+            if (elemsList.empty())
+            {
+                size_t mtu(0);
+                try
+                {
+                    auto stream = device->setupStream(direction, format, channels, SoapySDR::KwargsFromString(streamArgs));
+                    mtu = device->getStreamMTU(stream);
+                    device->closeStream(stream);
+                }
+                catch (const std::exception &ex)
+                {
+                    //these stream args are unusable, the other sets still get their trials
+                    SweepPoint point;
+                    point.streamArgs = streamArgs;
+                    point.error = ex.what();
+                    points.push_back(point);
+                    continue;
+                }
+                for (size_t elems = std::max<size_t>(mtu/8, 1); elems <= mtu*4; elems *= 2) elemsList.push_back(elems);
+            }
+            for (const auto numElems : elemsList)
+            {
+                if (loopDone) break;
+                std::cout << "Sweep " << label << " " << dirName << " " << numElems << " elements"
+                    << (streamArgs.empty()?"":(" [" + streamArgs + "]")) << std::endl;
+                points.push_back(runSweepTrial(args, device, direction, format, channels, streamArgs, numElems, pool));
+            }
+        }
+
+        printf("\nTransfer size sweep %s %s %s, %g s trials:\n", label.c_str(), dirName, format.c_str(), args.sweepTime);
+        printf("  %-28s %9s %10s %7s %10s %12s %12s\n", "stream args", "elems", "Msps", "cpu %", "ns/sample",
+            (direction == SOAPY_SDR_RX)?"overflows/s":"underflows/s", "p99 call us");
+        for (const auto &p : points)
+        {
+            const std::string streamArgs = p.streamArgs.empty()?"-":p.streamArgs;
+            if (not p.error.empty())
+            {
+                printf("  %-28.28s %9zu  %s\n", streamArgs.c_str(), p.numElems, p.error.c_str());
+                continue;
+            }
+            printf("  %-28.28s %9zu %10g %7.1f %10.2f %12.2f %12.1f\n", streamArgs.c_str(), p.numElems, p.rate/1e6,
+                100.0*p.cpu, (p.rate > 0.0)?(1e9*p.cpu/p.rate):0.0, p.eventRate, p.p99/1e3);
+        }
+        for (const auto &p : points) streamed = streamed or (p.error.empty() and p.rate > 0.0);
+        const auto best = bestSweepPoint(points);
+        if (best == nullptr) printf("  best %s: no point ran without flow events\n", dirName);
+        else printf("  best %s: --elems=%zu%s%s%s (%g Msps, %.1f%% cpu)\n", dirName, best->numElems,
+            best->streamArgs.empty()?"":" --streamArgs=\"", best->streamArgs.c_str(), best->streamArgs.empty()?"":"\"",
+            best->rate/1e6, 100.0*best->cpu);
+        fflush(stdout);
+    }
+    return streamed;
+}
+
+/***********************************************************************
+ * Throughput map over the probed rates, formats and channel counts
+ **********************************************************************/
+static const double MATRIX_RATE_STEP = 2.0; //ratio between rates tried in a continuous range
+static const double MATRIX_RATE_FRACTION = 0.98; //share of the set rate a sustained trial must move
+
+struct MatrixCell
+{
+    int direction = SOAPY_SDR_RX;
+    std::string format;
+    size_t numChans = 0;
+    size_t numElems = 0;
+    double maxRate = 0.0; //highest set rate which was sustained, 0 when none was
+    SweepPoint best; //the trial at maxRate
+    double failedRate = 0.0; //first set rate which was not sustained, 0 when the range ran out
+    std::string failure;
+};
+
+//discrete rates as they are, continuous ranges as a geometric ladder which ends on the maximum
+static std::vector<double> matrixRates(const SoapySDR::RangeList &ranges, const double startRate)
+{
+    std::vector<double> rates;
+    for (const auto &range : ranges)
+    {
+        if (range.maximum() <= 0.0) continue;
+        double rate = std::max(range.minimum(), startRate);
+        if (range.minimum() == range.maximum() or rate >= range.maximum())
+        {
+            if (rate <= range.maximum()) rates.push_back(range.maximum());
+            continue;
+        }
+        if (rate <= 0.0) rate = range.maximum()/std::pow(MATRIX_RATE_STEP, 10);
+        for (; rate < range.maximum(); rate *= MATRIX_RATE_STEP) rates.push_back(rate);
+        rates.push_back(range.maximum());
+    }
+    std::sort(rates.begin(), rates.end());
+    rates.erase(std::unique(rates.begin(), rates.end()), rates.end());
+    return rates;
+}
+
+//climb the rates of one combination until a trial misses the rate or crosses the flow event threshold
+static MatrixCell runMatrixCell(
+    const SoapySDRRateTestArgs &args,
     SoapySDR::Device *device,
-    SoapySDR::Stream *stream,
     const int direction,
+    const std::string &format,
+    const std::vector<size_t> &channels,
+    const std::vector<double> &rates,
+    BufferPool &pool)
+{
+    const char *dirName = (direction == SOAPY_SDR_RX)?"RX":"TX";
+    MatrixCell cell;
+    cell.direction = direction;
+    cell.format = format;
+    cell.numChans = channels.size();
+    for (const double rate : rates)
+    {
+        if (loopDone) break;
+        SweepPoint point;
+        double setRate(rate);
+        try
+        {
+            for (const auto chan : channels) device->setSampleRate(direction, chan, rate);
+            setRate = device->getSampleRate(direction, channels.front());
+        }
+        catch (const std::exception &ex)
+        {
+            point.error = ex.what();
+        }
+        if (point.error.empty())
+        {
+            std::cout << "Matrix " << dirName << " " << format << " x" << channels.size() << " at " << (setRate/1e6) << " Msps" << std::endl;
+            point = runSweepTrial(args, device, direction, format, channels, args.streamArgs, args.numElems, pool);
+        }
+        cell.numElems = point.numElems;
+
+        const bool sustained = point.error.empty() and point.eventRate <= args.matrixThreshold and point.rate >= MATRIX_RATE_FRACTION*setRate;
+        if (sustained)
+        {
+            cell.maxRate = setRate;
+            cell.best = point;
+            continue;
+        }
+        cell.failedRate = setRate;
+        char failure[128];
+        if (not point.error.empty()) snprintf(failure, sizeof(failure), "%s", point.error.c_str());
+        else if (point.eventRate > args.matrixThreshold) snprintf(failure, sizeof(failure), "%.1f %s/s", point.eventRate,
+            (direction == SOAPY_SDR_RX)?"overflows":"underflows");
+        else snprintf(failure, sizeof(failure), "moved %g Msps", point.rate/1e6);
+        cell.failure = failure;
+        break;
+    }
+    return cell;
+}
+
+//true when at least one combination sustained a rate
+static bool runThroughputMatrix(
+    const SoapySDRRateTestArgs &args,
+    SoapySDR::Device *device,
+    const std::string &label,
+    RateTestReporter *reporter)
+{
+    BufferPool pool(args.hugePages, args.numaNode);
+    std::vector<MatrixCell> cells;
+    for (const int direction : {SOAPY_SDR_RX, SOAPY_SDR_TX})
+    {
+        //the channels from --channels in order, or every channel of the device
+        std::vector<size_t> allChans;
+        for (const auto &pair : SoapySDR::KwargsFromString(args.channelStr)) allChans.push_back(std::stoi(pair.first));
+        if (allChans.empty()) for (size_t chan = 0; chan < device->getNumChannels(direction); chan++) allChans.push_back(chan);
+        if (allChans.empty()) continue;
+        for (const auto chan : allChans)
+        {
+            device->setFrequency(direction, chan, args.frequency);
+            if (args.bandwidth != 0.0) device->setBandwidth(direction, chan, args.bandwidth);
+            device->setGain(direction, chan, (direction == SOAPY_SDR_RX)?args.rxGain:args.txGain);
+        }
+
+        auto formats = device->getStreamFormats(direction, allChans.front());
+        if (not args.formatStr.empty()) formats.assign(1, args.formatStr);
+        const auto rates = matrixRates(device->getSampleRateRange(direction, allChans.front()), args.sampleRate);
+        for (const auto &format : formats)
+        {
+            for (size_t numChans = 1; numChans <= allChans.size() and not loopDone; numChans++)
+            {
+                const std::vector<size_t> channels(allChans.begin(), allChans.begin() + numChans);
+                cells.push_back(runMatrixCell(args, device, direction, format, channels, rates, pool));
+            }
+        }
+    }
+
+    printf("\nThroughput map %s, %g s trials, at most %g flow events/s:\n", label.c_str(), args.sweepTime, args.matrixThreshold);
+    printf("  %-3s %-8s %5s %9s %12s %12s %12s  %s\n", "dir", "format", "chans", "elems", "max Msps", "MBps", "p99 call us", "first failed");
+    bool sustained(false);
+    for (const auto &cell : cells)
+    {
+        sustained = sustained or cell.maxRate > 0.0;
+        const char *dirName = (cell.direction == SOAPY_SDR_RX)?"RX":"TX";
+        const double bytesRate = cell.best.rate*cell.numChans*SoapySDR::formatToSize(cell.format);
+        printf("  %-3s %-8s %5zu %9zu %12g %12g %12.1f  ", dirName, cell.format.c_str(), cell.numChans, cell.numElems,
+            cell.maxRate/1e6, bytesRate/1e6, cell.best.p99/1e3);
+        if (cell.failedRate == 0.0) printf("-, top of the range\n");
+        else printf("%g Msps, %s\n", cell.failedRate/1e6, cell.failure.c_str());
+
+        if (reporter == nullptr) continue;
+        RateTestRecord record;
+        record.type = "matrix";
+        record.device = label;
+        record.direction = dirName;
+        record.format = cell.format;
+        record.numChans = cell.numChans;
+        record.numElems = cell.numElems;
+        record.sampleRate = cell.maxRate;
+        record.rate = cell.best.rate;
+        record.bytesRate = bytesRate;
+        record.latencyP99 = cell.best.p99/1e3;
+        record.pass = int(cell.maxRate > 0.0);
+        reporter->write(record);
+    }
+    fflush(stdout);
+    return sustained;
+}
+
+/***********************************************************************
+ * One device under test with its pair of streams
+ **********************************************************************/
+struct RateTestDevice
+{
+    std::string label;
+    SoapySDR::Device *device = nullptr;
+    std::unique_ptr<TxWaveform> txWaveform;
+    std::unique_ptr<ReplaySource> replay;
+    double replayResident = 0.0; //page cache residency before streaming
+    std::unique_ptr<BlockRing> rxRing;
+    std::string capturePath;
+    std::unique_ptr<CaptureWriter> capture;
+    std::unique_ptr<RxVerifier> verify;
+    std::unique_ptr<ConvertStage> convert;
+    std::unique_ptr<DspStage> dsp;
+    std::unique_ptr<NetSink> net;
+    RateTestStream rx, tx;
+};
+
+static std::vector<SoapySDR::Kwargs> resolveDeviceArgs(const SoapySDRRateTestArgs &args)
+{
+    std::vector<SoapySDR::Kwargs> result;
+    std::vector<std::string> specs(args.deviceArgs);
+    if (specs.empty()) specs.push_back("");
+
+    for (const auto &spec : specs)
+    {
+        const auto specArgs = SoapySDR::KwargsFromString(spec);
+        if (not args.enumerateAll)
+        {
+            result.push_back(specArgs);
+            continue;
+        }
+
+        //every match is opened, the original spec fills in any keys enumerate did not report
+        for (auto found : SoapySDR::Device::enumerate(specArgs))
+        {
+            for (const auto &pair : specArgs) found.insert(pair);
+            result.push_back(found);
+        }
+    }
+    if (result.empty()) throw std::runtime_error("no devices matched the rate test arguments");
+    return result;
+}
+
+static const double RX_RING_SECONDS = 0.25; //pipeline ring depth in time
+static const size_t RX_RING_MAX_BYTES = size_t(1) << 30;
+
+//capture, conversion, verification, DSP, the network sink and the relay are consumers of one ring filled by the RX loop
+static void setupRxPipeline(
+    const SoapySDRRateTestArgs &args,
+    const std::string &rxFormat,
+    const double rxFullScale,
     const size_t numChans,
-    const size_t elemSize,
-    const double frequency,
-    const double sampleRate)
+    RateTestDevice &dev)
+{
+    const bool capture = not dev.capturePath.empty();
+    const bool verify = not args.verifyPattern.empty();
+    const bool convert = args.convertThreads != 0 and not args.formatStr.empty() and args.formatStr != rxFormat;
+    const bool relay = args.relay;
+    const bool dsp = not args.dspKernels.empty();
+    const bool net = not args.netSink.empty();
+    if (not capture and not verify and not convert and not relay and not dsp and not net) return;
+    const char *name = dev.rx.name.c_str();
+    const size_t numElems = transferElems(args, dev.device, dev.rx.stream);
+    const size_t blockBytes = numElems*dev.rx.elemSize*numChans;
+
+    //size the ring in time at the rate the device set, slots are page aligned for O_DIRECT
+    size_t numSlots = size_t(std::ceil(RX_RING_SECONDS*dev.rx.sampleRate/numElems));
+    numSlots = std::max<size_t>(16, std::min(numSlots, RX_RING_MAX_BYTES/blockBytes));
+    const size_t numConsumers = (capture?1:0) + (convert?1:0) + (verify?1:0) + (dsp?1:0) + (net?1:0) + (relay?1:0);
+    dev.rxRing.reset(new BlockRing(numSlots, numChans, numElems*dev.rx.elemSize, numConsumers, *dev.rx.pool, true));
+    dev.rx.rxRing = dev.rxRing.get();
+    const size_t convertConsumer = capture?1:0;
+    const size_t verifyConsumer = convertConsumer + (convert?1:0);
+    const size_t dspConsumer = verifyConsumer + (verify?1:0);
+    const size_t netConsumer = dspConsumer + (dsp?1:0);
+
+    if (relay)
+    {
+        if (convert) throw std::runtime_error("the relay sends the stream format, it cannot be combined with host conversion");
+        dev.tx.relay = true;
+        dev.tx.rxRing = dev.rxRing.get();
+        dev.tx.relayConsumer = numConsumers - 1;
+        std::cout << name << "Relay: RX to TX through a ring of " << numSlots << " x " << numElems << " elements ("
+            << (1e3*numSlots*numElems/dev.rx.sampleRate) << " ms)" << std::endl;
+    }
+
+    if (verify)
+    {
+        if (args.verifyPattern != "tone" and args.verifyPattern != "prbs") throw std::runtime_error("unknown verify pattern " + args.verifyPattern);
+        if (not dev.txWaveform) throw std::runtime_error("RX verification needs the generated TX waveform, not a replay");
+        if (args.timedBurst) throw std::runtime_error("RX verification needs continuous TX, not timed bursts");
+        dev.verify.reset(new RxVerifier(*dev.rxRing, verifyConsumer, numElems, rxFormat, rxFullScale,
+            dev.rx.sampleRate, *dev.txWaveform, dev.tx.format, *dev.rx.pool));
+        dev.rx.verify = dev.verify.get();
+        std::cout << name << "Verify: " << args.verifyPattern << " pattern of " << dev.verify->patternElems() << " elements" << std::endl;
+    }
+    if (convert)
+    {
+        dev.convert.reset(new ConvertStage(*dev.rxRing, convertConsumer, numElems, rxFormat, args.formatStr, rxFullScale, args.convertThreads, *dev.rx.pool));
+        dev.rx.convert = dev.convert.get();
+        std::cout << name << "Convert: " << rxFormat << " -> " << args.formatStr << " on " << dev.convert->numWorkers()
+            << " host thread" << ((dev.convert->numWorkers() == 1)?"":"s") << ", ring of " << numSlots << " x " << numElems << " elements" << std::endl;
+    }
+    if (dsp)
+    {
+        const size_t numThreads = (args.dspThreads != 0)?args.dspThreads:std::max(1u, std::thread::hardware_concurrency());
+        dev.dsp.reset(new DspStage(*dev.rxRing, dspConsumer, numElems, rxFormat, rxFullScale,
+            parseDspKernels(args.dspKernels), numThreads, dev.rx.pub, *dev.rx.pool));
+        dev.rx.dsp = dev.dsp.get();
+        std::cout << name << "DSP: " << dev.dsp->kernelNames() << " on " << dev.dsp->numWorkers() << " work-stealing thread"
+            << ((dev.dsp->numWorkers() == 1)?"":"s") << ", searching for the highest sustained load" << std::endl;
+    }
+    if (net)
+    {
+        dev.net.reset(new NetSink(args.netSink, args.netPayload, *dev.rxRing, netConsumer, dev.rx.elemSize));
+        std::cout << name << "Net sink: UDP to " << dev.net->dest() << ", " << dev.net->payload()
+            << " sample bytes per datagram, ring of " << numSlots << " x " << numElems << " elements" << std::endl;
+    }
+    if (not capture) return;
+
+    dev.capture.reset(new CaptureWriter(dev.capturePath, *dev.rxRing, 0, dev.rx.elemSize));
+    dev.rx.capture = dev.capture.get();
+    SoapySDR::Kwargs info;
+    info["format"] = rxFormat;
+    info["channels"] = std::to_string(numChans);
+    info["blockElems"] = std::to_string(numElems);
+    info["rate"] = std::to_string(dev.rx.sampleRate);
+    info["frequency"] = std::to_string(args.frequency);
+    writeSampleFileInfo(dev.capturePath, info);
+
+    std::cout << name << "Capture: " << dev.capturePath << " (" << (dev.capture->directIO()?"O_DIRECT":"buffered")
+        << "), ring of " << numSlots << " x " << numElems << " elements" << std::endl;
+}
+
+//initialize the frequency and sample rate for all channels
+static void configureChannels(
+    const SoapySDRRateTestArgs &args,
+    const std::vector<size_t> &channels,
+    SoapySDR::Device *device,
+    const std::vector<int> &directions)
+{
+    for (const auto &chan : channels)
+    {
+        for (const int dir : directions) device->setFrequency(dir, chan, args.frequency);
+        for (const int dir : directions) device->setBandwidth(dir, chan, args.bandwidth);
+        for (const int dir : directions) device->setSampleRate(dir, chan, args.sampleRate);
+        for (const int dir : directions) device->setGain(dir, chan, (dir == SOAPY_SDR_RX)?args.rxGain:args.txGain);
+    }
+}
+
+//the copy and direct paths are only compared when the stream feeds nothing else
+static void setupStreamPaths(const SoapySDRRateTestArgs &args, RateTestStream &rts)
+{
+    const char *name = rts.name.c_str();
+    const int direction = rts.direction;
+    rts.timedBurst = (args.timedBurst and direction == SOAPY_SDR_TX and rts.hardwareTime);
+    if (args.timedBurst and direction == SOAPY_SDR_TX and not rts.hardwareTime)
+    {
+        std::cerr << name << "No hardware time, timed bursts disabled" << std::endl;
+    }
+    if (not args.directAccess or rts.timedBurst) return;
+
+    if (rts.rxRing != nullptr or rts.replay != nullptr)
+    {
+        const char *reason = rts.relay?" relays the RX stream":(rts.rxRing != nullptr)?" feeds the RX pipeline":" replays from a file";
+        std::cerr << name << "Direct buffer access disabled - Dir " << direction << reason << std::endl;
+        return;
+    }
+    rts.numDirectBuffs = rts.device->getNumDirectAccessBuffers(rts.stream);
+    if (rts.numDirectBuffs == 0)
+    {
+        std::cerr << "Direct buffer access not supported - " << name << "Dir " << direction << ", using copy path only" << std::endl;
+    }
+}
+
+//the rate test opens both directions, the rate search only the ones it searches
+static void setupRateTestDevice(
+    const SoapySDRRateTestArgs &args,
+    const std::vector<size_t> &channels,
+    RateTestDevice &dev,
+    const std::vector<int> &directions)
+{
+    auto device = dev.device;
+    const bool withRx = std::find(directions.begin(), directions.end(), SOAPY_SDR_RX) != directions.end();
+    const bool withTx = std::find(directions.begin(), directions.end(), SOAPY_SDR_TX) != directions.end();
+    configureChannels(args, channels, device, directions);
+    const auto streamArgs = SoapySDR::KwargsFromString(args.streamArgs);
+    for (auto *rts : {&dev.rx, &dev.tx})
+    {
+        rts->device = device;
+        rts->numChans = channels.size();
+        rts->hardwareTime = device->hasHardwareTime();
+    }
+    dev.rx.direction = SOAPY_SDR_RX;
+    dev.tx.direction = SOAPY_SDR_TX;
+
+    //create the stream, use the native format, each stream is owned by dev as soon as it exists
+    double rxFullScale(0.0);
+    std::string rxFormat;
+    if (withRx)
+    {
+        const auto rxNative = device->getNativeStreamFormat(SOAPY_SDR_RX, channels.front(), rxFullScale);
+        const bool hostConvert = args.convertThreads != 0 and not args.formatStr.empty() and args.formatStr != rxNative;
+        rxFormat = (args.formatStr.empty() or hostConvert) ? rxNative : args.formatStr;
+        if (args.convertThreads != 0 and not hostConvert)
+        {
+            std::cerr << dev.rx.name << "Host conversion disabled - RX streams " << rxFormat << " natively" << std::endl;
+        }
+        if (rxFormat != rxNative or rxFullScale <= 0.0) rxFullScale = defaultFullScale(rxFormat);
+        dev.rx.format = rxFormat;
+        dev.rx.elemSize = SoapySDR::formatToSize(rxFormat);
+        dev.rx.stream = device->setupStream(SOAPY_SDR_RX, rxFormat, channels, streamArgs);
+        dev.rx.sampleRate = device->getSampleRate(SOAPY_SDR_RX, channels.front());
+        dev.rx.numElems = transferElems(args, device, dev.rx.stream);
+    }
+
+    //a replay file is sent in its recorded format unless one is forced
+    double fullScale(0.0);
+    if (withTx)
+    {
+        const auto txNative = device->getNativeStreamFormat(SOAPY_SDR_TX, channels.front(), fullScale);
+        std::string replayFormat;
+        if (not args.replayPath.empty())
+        {
+            const auto info = readSampleFileInfo(args.replayPath);
+            if (info.count("format") != 0) replayFormat = info.at("format");
+        }
+        if (args.relay and (not args.replayPath.empty() or not args.verifyPattern.empty() or args.timedBurst))
+        {
+            throw std::runtime_error("the relay transmits the RX samples, it cannot replay, verify or send timed bursts");
+        }
+        const auto txFormat = args.relay ? rxFormat : not args.formatStr.empty() ? args.formatStr : not replayFormat.empty() ? replayFormat : txNative;
+        if (not replayFormat.empty() and replayFormat != txFormat)
+        {
+            throw std::runtime_error("replay file is " + replayFormat + ", the TX stream is " + txFormat);
+        }
+        dev.tx.format = txFormat;
+        dev.tx.elemSize = SoapySDR::formatToSize(txFormat);
+        dev.tx.stream = device->setupStream(SOAPY_SDR_TX, txFormat, channels, streamArgs);
+        dev.tx.sampleRate = device->getSampleRate(SOAPY_SDR_TX, channels.front());
+        dev.tx.numElems = transferElems(args, device, dev.tx.stream);
+
+        //the driver full scale only applies to its native format
+        if (txFormat != txNative or fullScale <= 0.0) fullScale = defaultFullScale(txFormat);
+        if (not args.replayPath.empty())
+        {
+            dev.replay.reset(new ReplaySource(args.replayPath, dev.tx.elemSize, channels.size(), dev.tx.numElems));
+            dev.replayResident = dev.replay->residentFraction();
+        }
+        else if (not args.relay)
+        {
+            //the tone and ring follow the rate the device actually set
+            const double tone = (args.toneFreq != 0.0)?args.toneFreq:(dev.tx.sampleRate/16);
+            const auto pattern = (args.verifyPattern == "prbs")?TX_PATTERN_PRBS:TX_PATTERN_TONE;
+            dev.txWaveform.reset(new TxWaveform(txFormat, fullScale, dev.tx.numElems, tone, dev.tx.sampleRate, args.hugePages, args.numaNode, pattern));
+        }
+        dev.tx.txWaveform = dev.txWaveform.get();
+        dev.tx.replay = dev.replay.get();
+    }
+
+    const char *name = dev.rx.name.c_str();
+    std::cout << name << "RX format: " << (withRx?dev.rx.format:"-") << " TX format: " << (withTx?dev.tx.format:"-") << std::endl;
+    std::cout << name << "Num channels: " << channels.size() << std::endl;
+    std::cout << name << "RX Element size: " << dev.rx.elemSize << " bytes" << "TX Element size: " << dev.tx.elemSize << " bytes" << std::endl;
+    if (dev.replay)
+    {
+        std::cout << name << "TX replay: " << args.replayPath << ", " << dev.replay->numBlocks() << " blocks x "
+            << dev.replay->blockElems() << " elements, " << (100.0*dev.replayResident) << "% in page cache" << std::endl;
+    }
+    else if (withTx and args.relay)
+    {
+        std::cout << name << "TX relay: the RX samples";
+        if (device->hasHardwareTime()) std::cout << ", " << (args.relayLead*1e6) << " us after their RX time";
+        std::cout << std::endl;
+    }
+    else if (dev.txWaveform and dev.txWaveform->pattern() == TX_PATTERN_PRBS)
+    {
+        std::cout << name << "TX PRBS: full-scale " << fullScale
+            << ", ring of " << dev.txWaveform->numBuffers() << " x " << dev.txWaveform->numElems() << " elements" << std::endl;
+    }
+    else if (dev.txWaveform)
+    {
+        std::cout << name << "TX tone: " << (dev.txWaveform->toneFrequency()/1e3) << " kHz, full-scale " << fullScale
+            << ", ring of " << dev.txWaveform->numBuffers() << " x " << dev.txWaveform->numElems() << " elements" << std::endl;
+    }
+    if (withRx)
+    {
+        setupRxPipeline(args, rxFormat, rxFullScale, channels.size(), dev);
+        setupStreamPaths(args, dev.rx);
+    }
+    if (withTx) setupStreamPaths(args, dev.tx);
+    if (args.numaNode >= 0 and dev.txWaveform)
+    {
+        const auto &err = dev.txWaveform->numaError();
+        std::cout << name << "Buffer memory: NUMA node " << args.numaNode << (err.empty()?"":(" (" + err + ")")) << std::endl;
+    }
+}
+
+static int pickCpu(const std::vector<int> &cpus, const size_t index)
+{
+    return cpus.empty()?-1:cpus[index%cpus.size()];
+}
+
+//pin and prioritize a stream or engine thread, returns the description for the log
+static std::string scheduleThread(const SoapySDRRateTestArgs &args, std::thread &thread, const int cpu)
+{
+    std::string sched = "cpu any";
+    if (cpu >= 0)
+    {
+        const auto err = setThreadAffinity(thread, cpu);
+        sched = "cpu " + std::to_string(cpu) + (err.empty()?"":(" (" + err + ")"));
+    }
+    if (args.priority > 0)
+    {
+        const auto err = setThreadRealtime(thread, args.priority);
+        sched += ", SCHED_FIFO " + std::to_string(args.priority) + (err.empty()?"":(" (" + err + ")"));
+    }
+    return sched;
+}
+
+static void prepareStreamStart(const SoapySDRRateTestArgs &args, RateTestStream &rts)
+{
+    //flow events are collected by the monitor from before activation until the stream closes
+    rts.status.reset(new StreamStatusMonitor(rts.device, rts.stream));
+
+    //without a warmup the limit holds from the first sample
+    if (args.warmup <= 0.0 and args.numSamples != 0) rts.pub.setLimit(args.numSamples);
+}
+
+static std::thread startStreamThread(const SoapySDRRateTestArgs &args, RateTestStream &rts, const int cpu)
 {
-    //allocate buffers for the stream read/write
-    const size_t numElems = device->getStreamMTU(stream);
-    std::vector<std::vector<char>> buffMem(numChans, std::vector<char>(elemSize*numElems));
+    //the loop waits for its scheduling to be applied so buffers get touched on the right core
+    std::promise<void> ready;
+    std::shared_future<void> scheduled(ready.get_future());
+    prepareStreamStart(args, rts);
+    std::thread thread([&args, &rts, scheduled]() {
+        scheduled.wait();
+        try
+        {
+            if (rts.timedBurst) runTimedBurstLoop(args, rts);
+            else if (rts.relay) runRelayLoop(args, rts);
+            else
+            {
+                EngineSlot slot;
+                auto task = runRateTestStreamLoop(args, rts, slot);
+                task.resume();
+                if (task.error()) std::rethrow_exception(task.error());
+            }
+        }
+        catch (const std::exception &ex)
+        {
+            //only the deactivation is left to throw, the loops keep their own errors
+            std::cerr << "Stream thread failed: " << ex.what() << std::endl;
+            if (rts.error.empty()) rts.error = ex.what();
+        }
+        rts.threadStats = currentThreadStats();
+        rts.threadStats.streams = 1;
+    });
 
-    //generate some samples
-    int nbits = 16;
-    double amplitude = 1.0;
-    const double omega = 2 * std::numbers::pi * frequency / sampleRate;
-    std::cout << "omega " << omega << std::endl;
-    double phi = 0.0;
-    for(size_t i=0; i<numElems; i++) {
-        double re = std::cos(phi) * amplitude * std::exp2(elemSize*4 - 1);
-        double im = std::sin(phi) * amplitude * std::exp2(elemSize*4 - 1);
+    const auto sched = scheduleThread(args, thread, cpu);
+    std::cout << rts.name << ((rts.direction == SOAPY_SDR_RX)?"RX":"TX") << " thread: " << sched << std::endl;
 
-        std::cout << "double re " << re << " double im " << im << std::endl;
+    ready.set_value();
+    return thread;
+}
 
-        //std::cout << "re " << re << " im " << im << std::endl;
+//the engine threads take the RX cores, tasks are placed on them as the streams start
+static std::unique_ptr<StreamEngine> startStreamEngine(const SoapySDRRateTestArgs &args)
+{
+    std::unique_ptr<StreamEngine> engine(new StreamEngine(args.engineThreads));
+    for (size_t i = 0; i < engine->numThreads(); i++)
+    {
+        const auto sched = scheduleThread(args, engine->thread(i), pickCpu(args.rxCpus, i));
+        std::cout << "Engine thread " << i << ": " << sched << std::endl;
+    }
+    return engine;
+}
 
-        float *dst_cf32 = reinterpret_cast<float*>(&buffMem[0][i]);
-        dst_cf32[0] = re;
-        dst_cf32[1] = im;
+static void spawnStreamTask(const SoapySDRRateTestArgs &args, StreamEngine &engine, RateTestStream &rts)
+{
+    prepareStreamStart(args, rts);
+    engine.spawn([&args, &rts](EngineSlot &slot)
+    {
+        return runRateTestStreamLoop(args, rts, slot);
+    });
+}
 
-        std::cout << "float re " << dst_cf32[0] << " float im " << dst_cf32[1] << std::endl;
+/*!
+ * The reporter and stream threads of one run, joined on every way out of it.
+ * A run which throws before joining them ends the stream loops first.
+ */
+struct RateTestThreads
+{
+    std::atomic<bool> reporterDone{false};
+    std::thread reporter;
+    std::vector<std::thread> streams;
+    std::unique_ptr<StreamEngine> engine;
 
+    //wait for the stream loops to return, then stop the reporter
+    void join(void)
+    {
+        for (auto &thread : streams) if (thread.joinable()) thread.join();
+        if (engine) engine->stop();
+        reporterDone = true;
+        if (reporter.joinable()) reporter.join();
+    }
 
-        dst_cf32 = reinterpret_cast<float*>(&buffMem[1][i]);
-        dst_cf32[0] = re;
-        dst_cf32[1] = im;
+    ~RateTestThreads(void)
+    {
+        if (reporter.joinable()) loopDone = true;
+        this->join();
+    }
+};
 
-        phi += omega;
+//the status monitors read from the streams, they stop before the streams close
+static void closeRateTestStreams(RateTestDevice &dev)
+{
+    for (auto *rts : {&dev.rx, &dev.tx})
+    {
+        if (rts->stream == nullptr) continue;
+        if (rts->status) rts->status->stop();
+        dev.device->closeStream(rts->stream);
+        rts->stream = nullptr;
     }
+}
 
-    std::vector<void *> buffs(numChans);
-    for (size_t i = 0; i < numChans; i++) buffs[i] = buffMem[i].data();
+static void printReplaySummary(const SoapySDRRateTestArgs &args, const RateTestDevice &dev)
+{
+    const auto &tx = dev.tx;
+    const double rate = (tx.elapsed > 0.0)?(tx.totalSamples/tx.elapsed):0.0;
+    const double pageMB = sysconf(_SC_PAGESIZE)/1e6;
+    printf("  replay %s: %llu passes, %.0f%% cached before, %.0f%% after, %ld major faults (>= %g MB read from storage)\n",
+        args.replayPath.c_str(), tx.replayPasses, 100.0*dev.replayResident, 100.0*dev.replay->residentFraction(),
+        tx.majorFaults, tx.majorFaults*pageMB);
 
-    //state collected in this loop
-    unsigned int overflows(0);
-    unsigned int underflows(0);
-    unsigned long long totalSamples(0);
-    const auto startTime = std::chrono::high_resolution_clock::now();
-    auto timeLastPrint = std::chrono::high_resolution_clock::now();
-    auto timeLastSpin = std::chrono::high_resolution_clock::now();
-    auto timeLastStatus = std::chrono::high_resolution_clock::now();
-    int spinIndex(0);
+    //faults stall the writing thread, so a shortfall with faults is the storage behind the page cache
+    const char *verdict = "none, the replay kept up with the device";
+    if (rate < 0.99*args.sampleRate or tx.underflows != 0)
+    {
+        verdict = (tx.majorFaults != 0)?"page cache, file reads stalled the TX thread":"device, the file was served from the page cache";
+    }
+    printf("  replay bottleneck: %s\n", verdict);
+}
 
-    std::cout << "Starting stream " << direction << std::endl;
-    device->activateStream(stream);
-    
-    while (not loopDone)
+static void printVerifySummary(const RateTestDevice &dev)
+{
+    const auto &verify = *dev.verify;
+    const double fs2 = verify.fullScale()*verify.fullScale();
+    printf("  verify %s: %llu blocks checked, %llu skipped\n", dev.label.c_str(),
+        (unsigned long long)verify.checkedBlocks(), (unsigned long long)verify.skippedBlocks());
+    const auto &chans = verify.channels();
+    for (size_t c = 0; c < chans.size(); c++)
     {
-        int ret(0);
-        int flags(0);
-        long long timeNs(0);
-        switch(direction)
+        const auto &ch = chans[c];
+        if (not ch.locked)
         {
-        case SOAPY_SDR_RX:
-            //std::cout << "Read stream " << std::endl;
-            ret = device->readStream(stream, buffs.data(), numElems, flags, timeNs);
-            break;
-        case SOAPY_SDR_TX:
-            //std::cout << "Write stream " << std::endl;
-            ret = device->writeStream(stream, buffs.data(), numElems, flags, timeNs);
-            break;
+            printf("    ch%zu: pattern never found\n", c);
+            continue;
         }
+        const double n = double(ch.samples);
+        const double dc = std::hypot(ch.sumRe/n, ch.sumIm/n);
+        printf("    ch%zu: %llu blocks, %llu corrupted, %llu slips (%lld samples), %llu trailing, "
+            "power %.1f dBFS, DC %.1f dBFS, clipped %.3f%%, min correlation %.3f\n", c,
+            (unsigned long long)ch.blocks, (unsigned long long)ch.corrupted, (unsigned long long)ch.slips,
+            (long long)ch.slipSamples, (unsigned long long)ch.trailing, 10*std::log10(ch.power/n/fs2),
+            20*std::log10(dc/verify.fullScale()), 100.0*ch.clipped/n, ch.minCorrelation);
+    }
+    if (dev.tx.underflows != 0) printf("    slips may come from the %u TX underflows\n", dev.tx.underflows);
+}
 
-        if (ret == SOAPY_SDR_TIMEOUT) continue;
-        if (ret == SOAPY_SDR_OVERFLOW)
+//with hardware time the lead is the air to air latency, the slack says how much of it was spare
+static void printRelaySummary(const SoapySDRRateTestArgs &args, const RateTestDevice &dev)
+{
+    const auto &tx = dev.tx;
+    const auto &res = tx.relayResidency;
+    printf("  relay %s: %llu blocks, ring high water %zu/%zu, %llu RX blocks dropped, %u TX underflows\n", dev.label.c_str(),
+        tx.relayBlocks, dev.rxRing->highWater(), dev.rxRing->numSlots(), dev.rx.droppedBlocks, tx.underflows);
+    if (res.count() != 0)
+    {
+        printf("    host residency us: p50 %.1f  p99 %.1f  p99.9 %.1f  max %.1f\n",
+            res.percentile(50)/1e3, res.percentile(99)/1e3, res.percentile(99.9)/1e3, res.max()/1e3);
+    }
+    if (not tx.hardwareTime)
+    {
+        printf("    no hardware time, the air to air latency is the residency plus the driver buffering\n");
+        return;
+    }
+    printf("    air to air latency %.1f us, %llu blocks written after their TX time, %llu late reports\n",
+        args.relayLead*1e6, tx.relayLate, (unsigned long long)tx.status->timeErrors());
+    const auto &slack = tx.relaySlack;
+    if (slack.count() == 0) return;
+    const double spare = slack.percentile(0)/1e9;
+    printf("    write slack us: min %.1f  p0.1 %.1f  p50 %.1f, a lead of about %.1f us keeps the smallest margin\n",
+        slack.percentile(0)/1e3, slack.percentile(0.1)/1e3, slack.percentile(50)/1e3,
+        std::max(0.0, args.relayLead - spare)*1e6);
+}
+
+static const double CONVERT_SOLO_SECONDS = 0.2;
+
+//capacity is what each worker converted per second spent converting, the gain is over one uncontended thread
+static void printConvertSummary(const RateTestDevice &dev)
+{
+    const auto &convert = *dev.convert;
+    const auto &rx = dev.rx;
+    const double rate = (rx.elapsed > 0.0)?(rx.totalSamples/rx.elapsed):0.0;
+    printf("  convert %s: %s -> %s, %zu channel%s, %llu of %llu samples converted, %llu dropped blocks\n",
+        dev.label.c_str(), convert.sourceFormat().c_str(), convert.targetFormat().c_str(), rx.numChans,
+        (rx.numChans == 1)?"":"s", (unsigned long long)convert.convertedSamples(), rx.totalSamples, rx.droppedBlocks);
+
+    double capacity(0.0);
+    for (size_t i = 0; i < convert.numWorkers(); i++)
+    {
+        uint64_t samples;
+        double busy;
+        convert.workerStats(i, samples, busy);
+        const double workerRate = (busy > 0.0)?(samples/busy):0.0;
+        capacity += workerRate;
+        printf("    worker %zu: %llu samples, %.1f%% busy, %g Msps capacity\n", i, (unsigned long long)samples,
+            (rx.elapsed > 0.0)?(100.0*busy/rx.elapsed):0.0, workerRate/1e6);
+    }
+    const double solo = convert.soloRate(CONVERT_SOLO_SECONDS);
+    printf("    capacity %g Msps on %zu thread%s, one thread alone %g Msps, gain %.2fx, %.2fx the stream rate\n",
+        capacity/1e6, convert.numWorkers(), (convert.numWorkers() == 1)?"":"s", solo/1e6,
+        (solo > 0.0)?(capacity/solo):0.0, (rate > 0.0)?(capacity/rate):0.0);
+}
+
+//the highest load held at the stream rate, in kernel passes and in worker time per sample
+static void printDspSummary(const RateTestDevice &dev)
+{
+    const auto &dsp = *dev.dsp;
+    const auto steps = dsp.steps();
+    const double good = dsp.sustainedLoad();
+    double cpuPerPass(0.0);
+    for (const auto &step : steps)
+    {
+        if (step.sustained and step.load == good) cpuPerPass = step.cpuPerSample/step.load;
+    }
+    const double channelRate = dev.rx.sampleRate*dev.rx.numChans;
+    printf("  DSP %s on %zu thread%s, %llu steals: ", dsp.kernelNames().c_str(), dsp.numWorkers(), (dsp.numWorkers() == 1)?"":"s",
+        (unsigned long long)dsp.steals());
+    if (steps.empty()) printf("no load step completed\n");
+    else if (good == 0.0) printf("not even load %g was sustained\n", dsp.failedLoad());
+    else
+    {
+        printf("%s load %g (%.1f ns per channel sample, %.2f cores at %g Msps x %zu), ", dsp.converged()?"highest sustained":"sustained",
+            good, good*cpuPerPass, good*cpuPerPass*channelRate/1e9, dev.rx.sampleRate/1e6, dev.rx.numChans);
+        if (dsp.failedLoad() != 0.0) printf("failed at %g\n", dsp.failedLoad());
+        else printf("no failure within the run\n");
+    }
+    printf("    %10s %10s %12s %16s\n", "load", "result", "ring peak", "ns per sample");
+    for (const auto &step : steps)
+    {
+        printf("    %10g %10s %7zu/%-4zu %16.1f\n", step.load, step.sustained?"held":"dropped", step.ringPeak,
+            dev.rxRing->numSlots(), step.cpuPerSample);
+    }
+}
+
+//what left the host and what the peer made of it, the rate is end to end when the peer reported
+static void printNetSummary(const RateTestDevice &dev)
+{
+    const auto &net = *dev.net;
+    const double mbytes = net.bytesSent()/1e6;
+    printf("  net sink %s: %llu packets in %llu batches, %g MB, %g MBps, send errors %llu, ring p99 %.1f us",
+        net.dest().c_str(), (unsigned long long)net.packetsSent(), (unsigned long long)net.batches(), mbytes,
+        (dev.rx.elapsed > 0.0)?(mbytes/dev.rx.elapsed):0.0, (unsigned long long)net.sendErrors(), net.residency().percentile(99)/1e3);
+    const auto error = net.error();
+    if (not error.empty()) printf(", error: %s", error.c_str());
+    printf("\n");
+
+    NetPeerReport report;
+    if (not net.peerReport(report))
+    {
+        printf("    no report from the peer\n");
+        return;
+    }
+    const uint64_t span = report.expected - report.firstSeq;
+    const uint64_t lost = (span > report.received)?(span - report.received):0;
+    const double channelBytes = double(dev.rx.numChans*dev.rx.elemSize);
+    printf("    peer: %llu of %llu packets, lost %llu (%.4f%%), reordered %llu, %g Msps end to end, network us p50 %.1f p99 %.1f max %.1f, socket p99 %.1f us\n",
+        (unsigned long long)report.received, (unsigned long long)span, (unsigned long long)lost, (span != 0)?(100.0*lost/span):0.0,
+        (unsigned long long)report.reordered, (report.elapsed > 0.0)?(report.bytes/report.elapsed/channelBytes/1e6):0.0,
+        report.networkP50Ns/1e3, report.networkP99Ns/1e3, report.networkMaxNs/1e3, report.socketP99Ns/1e3);
+}
+
+//every channel found the pattern, no block was corrupt and none was out of place unless TX underflowed
+static bool verifyPassed(const RateTestDevice &dev)
+{
+    if (not dev.verify) return true;
+    for (const auto &ch : dev.verify->channels())
+    {
+        if (not ch.locked or ch.corrupted != 0) return false;
+        if (ch.slips != 0 and dev.tx.underflows == 0) return false;
+    }
+    return true;
+}
+
+//what the streams cost their threads, the same line for either engine so runs can be compared
+static void printEngineSummary(const std::vector<RateTestDevice> &devs, const StreamEngine *engine)
+{
+    std::vector<EngineThreadStats> threads;
+    double channelSamples(0.0);
+    for (const auto &dev : devs)
+    {
+        for (const auto *rts : {&dev.rx, &dev.tx})
         {
-            overflows++;
-            continue;
+            channelSamples += double(rts->totalSamples)*rts->numChans;
+            if (not engine) threads.push_back(rts->threadStats);
         }
-        if (ret == SOAPY_SDR_UNDERFLOW)
+    }
+    if (engine) for (size_t i = 0; i < engine->numThreads(); i++) threads.push_back(engine->stats(i));
+
+    EngineThreadStats total;
+    for (const auto &st : threads)
+    {
+        total.streams += st.streams;
+        total.cpuTime += st.cpuTime;
+        total.voluntarySwitches += st.voluntarySwitches;
+        total.involuntarySwitches += st.involuntarySwitches;
+        total.passes += st.passes;
+        total.idlePasses += st.idlePasses;
+    }
+    printf("  engine %s: %zu stream%s on %zu thread%s, cpu %.3f s, %.2f ns per channel sample, context switches %ld voluntary %ld involuntary",
+        engine?"coroutines":"threads", total.streams, (total.streams == 1)?"":"s", threads.size(), (threads.size() == 1)?"":"s",
+        total.cpuTime, (channelSamples > 0.0)?(total.cpuTime*1e9/channelSamples):0.0, total.voluntarySwitches, total.involuntarySwitches);
+    if (engine) printf(", idle passes %.1f%% of %llu", (total.passes != 0)?(100.0*total.idlePasses/total.passes):0.0, (unsigned long long)total.passes);
+    printf("\n");
+    if (engine and threads.size() > 1) for (size_t i = 0; i < threads.size(); i++)
+    {
+        const auto &st = threads[i];
+        printf("    thread %zu: %zu stream%s, cpu %.3f s, context switches %ld voluntary %ld involuntary, idle passes %.1f%% of %llu\n",
+            i, st.streams, (st.streams == 1)?"":"s", st.cpuTime, st.voluntarySwitches, st.involuntarySwitches,
+            (st.passes != 0)?(100.0*st.idlePasses/st.passes):0.0, (unsigned long long)st.passes);
+    }
+    fflush(stdout);
+}
+
+static void printRateTestSummary(const SoapySDRRateTestArgs &args, const std::vector<RateTestDevice> &devs)
+{
+    printf("\nRate test summary (%zu device%s):\n", devs.size(), (devs.size() == 1)?"":"s");
+    printf("  %-32s %-3s %12s %12s %10s %10s\n", "device", "dir", "Msps", "MBps", "overflows", "underflows");
+    double totalRate[2] = {0.0, 0.0};
+    double totalBytes[2] = {0.0, 0.0};
+    unsigned long long totalOverflows[2] = {0, 0};
+    unsigned long long totalUnderflows[2] = {0, 0};
+    for (const auto &dev : devs)
+    {
+        for (const auto *rts : {&dev.rx, &dev.tx})
         {
-            underflows++;
-            continue;
+            const double rate = (rts->elapsed > 0.0)?(rts->totalSamples/rts->elapsed):0.0;
+            const double bytes = rate*rts->numChans*rts->elemSize;
+            totalRate[rts->direction] += rate;
+            totalBytes[rts->direction] += bytes;
+            totalOverflows[rts->direction] += rts->overflows;
+            totalUnderflows[rts->direction] += rts->underflows;
+            printf("  %-32.32s %-3s %12g %12g %10u %10u\n", dev.label.c_str(), (rts->direction == SOAPY_SDR_RX)?"RX":"TX",
+                rate/1e6, bytes/1e6, rts->overflows, rts->underflows);
         }
-        if (ret < 0)
+    }
+    if (devs.size() > 1)
+    {
+        for (const int dir : {SOAPY_SDR_RX, SOAPY_SDR_TX})
         {
-            std::cerr << "Unexpected stream error " << SoapySDR::errToStr(ret) << std::endl;
-            break;
+            printf("  %-32s %-3s %12g %12g %10llu %10llu\n", "aggregate", (dir == SOAPY_SDR_RX)?"RX":"TX",
+                totalRate[dir]/1e6, totalBytes[dir]/1e6, totalOverflows[dir], totalUnderflows[dir]);
         }
-        totalSamples += ret;
+    }
+
+    for (const auto &dev : devs)
+    {
+        if (dev.replay) printReplaySummary(args, dev);
+        if (dev.verify) printVerifySummary(dev);
+        if (dev.convert) printConvertSummary(dev);
+        if (dev.dsp) printDspSummary(dev);
+        if (dev.net) printNetSummary(dev);
+        if (dev.tx.relay) printRelaySummary(args, dev);
+        if (not dev.capture) continue;
+        const auto &cap = *dev.capture;
+        const double mbytes = cap.bytesWritten()/1e6;
+        const char *mode = not cap.openedDirect()?"buffered":cap.directIO()?"O_DIRECT throughout":"O_DIRECT until a short block, then buffered";
+        printf("  capture %s (%s): %g MB, %g MBps sustained, %g MBps while writing, ring high water %zu/%zu, dropped blocks %llu%s%s\n",
+            dev.capturePath.c_str(), mode, mbytes, (dev.rx.elapsed > 0.0)?(mbytes/dev.rx.elapsed):0.0,
+            (cap.writeTime() > 0.0)?(mbytes/cap.writeTime()):0.0, dev.rxRing->highWater(), dev.rxRing->numSlots(),
+            dev.rx.droppedBlocks, cap.error().empty()?"":", error: ", cap.error().c_str());
+    }
+    fflush(stdout);
+}
 
-        const auto now = std::chrono::high_resolution_clock::now();
-        if (timeLastSpin + std::chrono::milliseconds(300) < now)
+//wall time of every profiled loop split by phase, then the perf counters of its thread
+static void printProfileSummary(const SoapySDRRateTestArgs &args)
+{
+    const double ticksPerSec = profileTicksPerSecond();
+    printf("  profile: %.3f GHz cycle counter, %s\n", ticksPerSec/1e9,
+        (args.engineThreads != 0)?"perf counters cover each engine thread":"perf counters per thread");
+    for (const auto &prof : threadProfiles())
+    {
+        uint64_t total(0);
+        for (int p = 0; p < NUM_PROFILE_PHASES; p++) total += prof.ticks[p];
+        printf("    %s: %.3f s\n", prof.thread.c_str(), total/ticksPerSec);
+        for (int p = 0; p < NUM_PROFILE_PHASES; p++)
         {
-            timeLastSpin = now;
-            static const char spin[] = {"|/-\\"};
-            printf("\b%c", spin[(spinIndex++)%4]);
-            fflush(stdout);
+            if (prof.laps[p] == 0) continue;
+            printf("      %-14s %10.3f ms %6.1f%% %12llu laps %10.1f ns/lap\n", profilePhaseName(p),
+                prof.ticks[p]*1e3/ticksPerSec, (total != 0)?(100.0*prof.ticks[p]/total):0.0,
+                (unsigned long long)prof.laps[p], prof.ticks[p]*1e9/ticksPerSec/prof.laps[p]);
+        }
+        printf("      perf:");
+        for (int c = 0; c < NUM_PERF_COUNTERS; c++)
+        {
+            if (not prof.perfValid[c]) continue;
+            printf(" %s %llu%s", perfCounterName(c), (unsigned long long)prof.perf[c], prof.perfUserOnly[c]?" (user)":"");
         }
-        //occasionally read out the stream status (non blocking)
-        if (timeLastStatus + std::chrono::seconds(1) < now)
+        if (not prof.perfError.empty()) printf(" (%s)", prof.perfError.c_str());
+        printf("\n");
+    }
+    fflush(stdout);
+}
+
+//buffer reuse, and with the allocation check every steady state loop, false when any of them allocated
+static bool printMemorySummary(const SoapySDRRateTestArgs &args, const BufferPool &pool)
+{
+    const auto numaError = pool.numaError();
+    printf("  buffer pool: %zu leases, %zu reused, %g MB mapped%s", pool.acquired(), pool.reused(), pool.mappedBytes()/1e6,
+        pool.hugePages()?", huge pages requested":"");
+    if (pool.numaNode() >= 0) printf(", NUMA node %d%s%s", pool.numaNode(), numaError.empty()?"":" ", numaError.c_str());
+    printf("\n");
+    if (not args.allocCheck)
+    {
+        fflush(stdout);
+        return true;
+    }
+
+    bool passed(true);
+    printf("  %-32s %14s %14s\n", "steady state loop", "allocations", "bytes");
+    for (const auto &loop : steadyStateAllocations())
+    {
+        if (not loop.steady) printf("  %-32.32s %14s %14s\n", loop.loop.c_str(), "not steady", "-");
+        else printf("  %-32.32s %14llu %14llu\n", loop.loop.c_str(), (unsigned long long)loop.allocations, (unsigned long long)loop.bytes);
+        passed = passed and loop.allocations == 0;
+    }
+    printf("Allocation check: %s\n", passed?"PASS, no heap allocations in the steady state loops":"FAIL");
+    fflush(stdout);
+    return passed;
+}
+
+/***********************************************************************
+ * Results store and the comparison against earlier runs
+ **********************************************************************/
+static const double COMPARE_ALPHA = 0.01;
+static const double COMPARE_MIN_CHANGE = 0.02; //smaller relative changes are not reported however certain
+
+static std::vector<StoredStream> storedStreams(const std::vector<RateTestDevice> &devs, const StoredRun &run)
+{
+    std::vector<StoredStream> result;
+    for (const auto &dev : devs)
+    {
+        const auto driver = dev.device->getDriverKey();
+        const auto hardware = dev.device->getHardwareKey();
+        const auto hardwareInfo = SoapySDR::KwargsToString(dev.device->getHardwareInfo());
+        for (const auto *rts : {&dev.rx, &dev.tx})
         {
-            timeLastStatus = now;
-            while (true)
+            if (rts->elapsed <= 0.0) continue;
+            StoredStream s;
+            s.run = run.id;
+            s.device = dev.label;
+            s.driver = driver;
+            s.hardware = hardware;
+            s.hardwareInfo = hardwareInfo;
+            s.direction = (rts->direction == SOAPY_SDR_RX)?"RX":"TX";
+            s.format = rts->format;
+            s.numChans = rts->numChans;
+            s.numElems = rts->numElems;
+            s.sampleRate = rts->sampleRate;
+            s.rate = rts->totalSamples/rts->elapsed;
+            s.overflows = rts->overflows;
+            s.underflows = rts->underflows;
+            const auto &lat = rts->timing.latency;
+            if (lat.count() != 0)
             {
-                size_t chanMask; int flags; long long timeNs;
-                ret = device->readStreamStatus(stream, chanMask, flags, timeNs, 0);
-                if (ret == SOAPY_SDR_OVERFLOW) overflows++;
-                else if (ret == SOAPY_SDR_UNDERFLOW) underflows++;
-                else if (ret == SOAPY_SDR_TIME_ERROR) {}
-                else break;
+                s.latencyP50 = lat.percentile(50)/1e3;
+                s.latencyP99 = lat.percentile(99)/1e3;
+                s.latencyP999 = lat.percentile(99.9)/1e3;
+                s.latencyMax = lat.max()/1e3;
             }
+            s.rateSamples = rts->rateSamples;
+            result.push_back(s);
+        }
+    }
+    return result;
+}
+
+//every stream against the same stream of the latest stored runs, false when one regressed significantly
+static bool printComparison(const SoapySDRRateTestArgs &args, const ResultsStore &store, const StoredRun &run, const std::vector<StoredStream> &streams)
+{
+    std::vector<StoredRun> runs;
+    std::vector<StoredStream> stored;
+    store.load(runs, stored);
+    std::map<std::string, const StoredRun *> runById;
+    for (const auto &r : runs) runById[r.id] = &r;
+
+    bool regressed(false);
+    printf("\nComparison against %s, p < %g and at least %g%% change:\n", store.path().c_str(), COMPARE_ALPHA, 100*COMPARE_MIN_CHANGE);
+    for (const auto &s : streams)
+    {
+        const auto key = s.key(run);
+        std::vector<const StoredStream *> baseline;
+        for (const auto &old : stored)
+        {
+            const auto it = runById.find(old.run);
+            if (it != runById.end() and old.key(*it->second) == key) baseline.push_back(&old);
+        }
+        if (args.compareRuns != 0 and baseline.size() > args.compareRuns) baseline.erase(baseline.begin(), baseline.end() - args.compareRuns);
+
+        printf("  %s %s %s x%zu at %g Msps: ", s.device.c_str(), s.direction.c_str(), s.format.c_str(), s.numChans, s.sampleRate/1e6);
+        if (baseline.empty())
+        {
+            printf("no stored run to compare with\n");
+            continue;
         }
-        if (timeLastPrint + std::chrono::seconds(5) < now)
+        printf("%zu stored run%s\n", baseline.size(), (baseline.size() == 1)?"":"s");
+
+        //an upgrade since the latest stored run is the usual suspect
+        const auto &last = *runById.at(baseline.back()->run);
+        std::string changed;
+        if (last.kernel != run.kernel) changed += ", kernel " + last.kernel + " -> " + run.kernel;
+        if (last.libVersion != run.libVersion) changed += ", SoapySDR " + last.libVersion + " -> " + run.libVersion;
+        if (last.cpu != run.cpu) changed += ", cpu " + last.cpu + " -> " + run.cpu;
+        if (baseline.back()->hardwareInfo != s.hardwareInfo) changed += ", hardware " + baseline.back()->hardwareInfo + " -> " + s.hardwareInfo;
+        if (not changed.empty()) printf("    changed since %s: %s\n", last.id.c_str(), changed.c_str() + 2);
+
+        for (const auto &c : compareStream(s, baseline, COMPARE_ALPHA, COMPARE_MIN_CHANGE))
         {
-            timeLastPrint = now;
-            const auto timePassed = std::chrono::duration_cast<std::chrono::microseconds>(now - startTime);
-            const auto sampleRate = double(totalSamples)/timePassed.count();
-            printf("\b%g Msps\t%g MBps - Dir %d", sampleRate, sampleRate*numChans*elemSize, direction);
-            if (overflows != 0) printf("\tOverflows %u", overflows);
-            if (underflows != 0) printf("\tUnderflows %u", underflows);
-            printf("\n ");
+            char p[32] = "n/a";
+            if (c.p >= 0.0) snprintf(p, sizeof(p), "%.3g", c.p);
+            printf("    %-14s %12.3f -> %12.3f %+8.1f%%  p %-8s%s\n", c.metric.c_str(), c.baseline, c.current, 100*c.change, p,
+                not c.significant?"":c.worse?"  regression":"  improvement");
+            regressed = regressed or (c.significant and c.worse);
         }
+    }
+    fflush(stdout);
+    return not regressed;
+}
+
+/***********************************************************************
+ * Search for the highest sample rate which streams clean
+ **********************************************************************/
+static const double SEARCH_WARMUP = 1.0; //seconds before a soak counts, unless the warmup is longer
+static const double SEARCH_PRECISION = 0.01; //a continuous search ends once the clean and failed rates are this close
+static const double SEARCH_RATE_FRACTION = 0.99; //share of the set rate a clean trial must move
+static const size_t SEARCH_MAX_TRIALS = 24;
 
+struct SearchTrial
+{
+    double request = 0.0; //the rate asked for
+    double rate = 0.0; //the rate the device set
+    double measured[2] = {0.0, 0.0}; //samples per second, indexed by direction
+    unsigned long long overflows = 0;
+    unsigned long long underflows = 0;
+    unsigned long long lostSamples = 0; //missing from the RX timestamps, with hardware time
+    std::string failure; //empty when the trial was clean
+};
+
+//the highest rate at or below the given one the ranges allow, 0 when there is none
+static double allowedRate(const SoapySDR::RangeList &ranges, const double rate)
+{
+    double best(0.0);
+    for (const auto &range : ranges)
+    {
+        if (range.minimum() > rate) continue;
+        double r = std::min(rate, range.maximum());
+        if (range.step() > 0.0) r = range.minimum() + std::floor((r - range.minimum())/range.step())*range.step();
+        best = std::max(best, r);
     }
+    return best;
+}
 
-    std::cout << "deactivate " << direction << std::endl;
-    device->deactivateStream(stream);
+//the next rate strictly between a clean and a failed one, 0 once there is none worth a trial:
+//the middle of the listed rates when the device only has discrete rates, else geometric bisection
+static double bisectRate(const SoapySDR::RangeList &ranges, const double good, const double bad)
+{
+    const bool continuous = std::any_of(ranges.begin(), ranges.end(), [](const SoapySDR::Range &r){return r.minimum() != r.maximum();});
+    if (not continuous)
+    {
+        std::vector<double> between;
+        for (const auto &range : ranges)
+        {
+            if (range.minimum() > good and range.minimum() < bad) between.push_back(range.minimum());
+        }
+        if (between.empty()) return 0.0;
+        std::sort(between.begin(), between.end());
+        return between[between.size()/2];
+    }
+    if (bad/good < 1.0 + SEARCH_PRECISION) return 0.0;
+    const double mid = allowedRate(ranges, std::sqrt(good*bad));
+    return (mid > good and mid < bad)?mid:0.0;
+}
+
+//one soak of fresh streams at one rate, counted by the rate test loop and its reporter
+static SearchTrial runSearchTrial(
+    const SoapySDRRateTestArgs &args,
+    SoapySDR::Device *device,
+    const std::string &label,
+    const std::vector<size_t> &channels,
+    const std::vector<int> &directions,
+    const double rate,
+    BufferPool &pool)
+{
+    //only the streams themselves, the pipeline stages and path comparison are left out
+    SoapySDRRateTestArgs trialArgs(args);
+    trialArgs.sampleRate = rate;
+    trialArgs.warmup = std::max(args.warmup, SEARCH_WARMUP);
+    trialArgs.numSamples = 0;
+    trialArgs.directAccess = false;
+    trialArgs.convertThreads = 0;
+    trialArgs.verifyPattern.clear();
+    trialArgs.dspKernels.clear();
+    trialArgs.netSink.clear();
+
+    SearchTrial trial;
+    trial.request = trial.rate = rate;
+    RateTestDevice dev;
+    dev.label = dev.rx.label = dev.tx.label = label;
+    dev.device = device;
+    dev.rx.pool = dev.tx.pool = &pool;
+    try
+    {
+        setupRateTestDevice(trialArgs, channels, dev, directions);
+    }
+    catch (const std::exception &ex)
+    {
+        trial.failure = ex.what();
+        closeRateTestStreams(dev);
+        return trial;
+    }
+    trial.rate = (directions.front() == SOAPY_SDR_RX)?dev.rx.sampleRate:dev.tx.sampleRate;
+    std::vector<RateTestStream *> streams;
+    for (const int direction : directions) streams.push_back((direction == SOAPY_SDR_RX)?&dev.rx:&dev.tx);
+    std::cout << "Search " << label << " trial at " << (trial.rate/1e6) << " Msps, "
+        << trialArgs.warmup << " s warmup and " << args.soakTime << " s soak" << std::endl;
+
+    RateTestThreads threads;
+    threads.reporter = std::thread(runReporterLoop, std::cref(trialArgs), std::cref(streams), std::cref(threads.reporterDone));
+    if (args.engineThreads != 0) threads.engine = startStreamEngine(trialArgs);
+    for (auto *rts : streams)
+    {
+        const auto &cpus = (rts->direction == SOAPY_SDR_RX)?args.rxCpus:args.txCpus;
+        if (threads.engine) spawnStreamTask(trialArgs, *threads.engine, *rts);
+        else threads.streams.push_back(startStreamThread(trialArgs, *rts, pickCpu(cpus, 0)));
+    }
+
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::duration<double>(trialArgs.warmup + args.soakTime);
+    while (not loopDone and std::chrono::steady_clock::now() < deadline)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    loopDone = true;
+    threads.join();
+    closeRateTestStreams(dev);
+
+    //the next trial streams again unless this one was interrupted
+    loopDone = interrupted.load();
+    for (auto *rts : streams)
+    {
+        if (rts->pub.started()) collectStreamTotals(*rts);
+        trial.measured[rts->direction] = (rts->elapsed > 0.0)?(rts->totalSamples/rts->elapsed):0.0;
+        trial.overflows += rts->overflows;
+        trial.underflows += rts->underflows;
+        trial.lostSamples += rts->lostSamples;
+        if (trial.failure.empty() and not rts->error.empty()) trial.failure = "stream error " + rts->error;
+    }
+
+    //clean means no flow event, no gap in the RX timestamps and every stream near the set rate,
+    //give or take the one transfer a short soak at a low rate may end on
+    double slowest(trial.rate);
+    bool slow(false);
+    for (const auto *rts : streams)
+    {
+        const double measured = trial.measured[rts->direction];
+        const double grain = (rts->elapsed > 0.0)?(rts->numElems/rts->elapsed):0.0;
+        slowest = std::min(slowest, measured);
+        slow = slow or measured + grain < SEARCH_RATE_FRACTION*trial.rate;
+    }
+    char failure[128];
+    failure[0] = '\0';
+    if (interrupted) snprintf(failure, sizeof(failure), "interrupted");
+    else if (trial.overflows != 0) snprintf(failure, sizeof(failure), "%llu overflows", trial.overflows);
+    else if (trial.underflows != 0) snprintf(failure, sizeof(failure), "%llu underflows", trial.underflows);
+    else if (trial.lostSamples != 0) snprintf(failure, sizeof(failure), "%llu samples missing from the timestamps", trial.lostSamples);
+    else if (slow) snprintf(failure, sizeof(failure), "moved %g Msps", slowest/1e6);
+    if (trial.failure.empty() and failure[0] != '\0') trial.failure = failure;
+    std::cout << "Search " << label << " trial at " << (trial.rate/1e6) << " Msps: "
+        << (trial.failure.empty()?"clean":trial.failure) << std::endl;
+    return trial;
+}
+
+//the top of the range first, then the bottom, then bisect between the highest clean and the lowest failed rate
+static bool runRateSearch(
+    const SoapySDRRateTestArgs &args,
+    const std::vector<size_t> &channels,
+    SoapySDR::Device *device,
+    const std::string &label,
+    RateTestReporter *reporter)
+{
+    std::vector<int> directions;
+    if (args.search == "rx" or args.search == "duplex") directions.push_back(SOAPY_SDR_RX);
+    if (args.search == "tx" or args.search == "duplex") directions.push_back(SOAPY_SDR_TX);
+    if (directions.empty()) throw std::runtime_error("unknown search mode " + args.search + ", expected rx, tx or duplex");
+    if (args.timedBurst or args.relay) throw std::runtime_error("the rate search needs continuous streams, not timed bursts or the relay");
+    const char *mode = (directions.size() == 2)?"full duplex":(directions.front() == SOAPY_SDR_RX)?"RX":"TX";
+
+    //bounds of the first direction, full duplex stops at the lower of both maxima, --rate caps the search
+    const auto ranges = device->getSampleRateRange(directions.front(), channels.front());
+    if (ranges.empty()) throw std::runtime_error("the device reports no sample rate range");
+    double lowest(std::numeric_limits<double>::infinity()), highest(0.0);
+    for (const auto &range : ranges)
+    {
+        if (range.maximum() <= 0.0) continue;
+        lowest = std::min(lowest, std::max(range.minimum(), 1.0));
+        highest = std::max(highest, range.maximum());
+    }
+    if (directions.size() == 2)
+    {
+        double txHighest(0.0);
+        for (const auto &range : device->getSampleRateRange(SOAPY_SDR_TX, channels.front())) txHighest = std::max(txHighest, range.maximum());
+        if (txHighest > 0.0) highest = std::min(highest, txHighest);
+    }
+    if (args.sampleRate > 0.0) highest = std::min(highest, args.sampleRate);
+    highest = allowedRate(ranges, highest);
+    lowest = allowedRate(ranges, lowest);
+    if (highest <= 0.0 or lowest <= 0.0) throw std::runtime_error("no sample rate to search");
+    std::cout << "Search " << label << " " << mode << " from " << (lowest/1e6) << " to " << (highest/1e6) << " Msps" << std::endl;
+
+    BufferPool pool(args.hugePages, args.numaNode);
+    std::vector<SearchTrial> trials;
+    const SearchTrial *good(nullptr), *bad(nullptr);
+    trials.reserve(SEARCH_MAX_TRIALS);
+    double next = highest;
+    while (next > 0.0 and trials.size() < SEARCH_MAX_TRIALS and not interrupted)
+    {
+        trials.push_back(runSearchTrial(args, device, label, channels, directions, next, pool));
+        const auto &trial = trials.back();
+        if (interrupted) break;
+        if (trial.failure.empty()) good = &trial;
+        else bad = &trial;
+
+        if (good == nullptr) next = (trials.size() == 1 and lowest < highest)?lowest:0.0;
+        else if (bad == nullptr) next = 0.0;
+        else next = bisectRate(ranges, good->request, bad->request);
+    }
+
+    printf("\nRate search %s %s x%zu, %g s soaks:\n", label.c_str(), mode, channels.size(), args.soakTime);
+    printf("  %12s %12s %12s %10s %10s %10s  %s\n", "set Msps", "RX Msps", "TX Msps", "overflows", "underflows", "lost", "result");
+    for (const auto &trial : trials)
+    {
+        printf("  %12g %12g %12g %10llu %10llu %10llu  %s\n", trial.rate/1e6, trial.measured[SOAPY_SDR_RX]/1e6,
+            trial.measured[SOAPY_SDR_TX]/1e6, trial.overflows, trial.underflows, trial.lostSamples,
+            trial.failure.empty()?"clean":trial.failure.c_str());
+    }
+    if (good == nullptr) printf("  no rate streamed clean\n");
+    else
+    {
+        printf("  highest clean rate: %g Msps", good->rate/1e6);
+        if (bad == nullptr) printf(", the top of the range\n");
+        else printf(", %g Msps failed with %s%s\n", bad->rate/1e6, bad->failure.c_str(),
+            (next > 0.0)?" (search not finished)":"");
+    }
+    fflush(stdout);
+
+    for (const int direction : directions)
+    {
+        if (reporter == nullptr) continue;
+        RateTestRecord record;
+        record.type = "search";
+        record.device = label;
+        record.direction = (direction == SOAPY_SDR_RX)?"RX":"TX";
+        record.numChans = channels.size();
+        record.sampleRate = (good != nullptr)?good->rate:0.0;
+        record.rate = (good != nullptr)?good->measured[direction]:0.0;
+        record.pass = int(good != nullptr);
+        reporter->write(record);
+    }
+    return good != nullptr;
 }
 
-int SoapySDRRateTest(
-    const std::string &argStr,
-    const double frequency,
-    const double bandwidth,
-    const double sampleRate,
-    const double rxGain,
-    const double txGain,
-    const std::string &formatStr,
-    const std::string &channelStr)
+//every stream must run without a stream error and reach the target rate when one is set
+//checkFailed names a failed check beyond the streams themselves, nullptr when there was none
+static bool judgeRateTest(const SoapySDRRateTestArgs &args, const std::vector<RateTestDevice> &devs, const char *checkFailed, RateTestReporter *reporter)
 {
-    SoapySDR::Device *device(nullptr);
+    const double target = (args.targetRate < 0.0)?(0.99*args.sampleRate):args.targetRate;
+    bool passed(true);
+    bool verified(true);
+    double minRate(std::numeric_limits<double>::infinity());
+    for (const auto &dev : devs)
+    {
+        verified = verified and verifyPassed(dev);
+        for (const auto *rts : {&dev.rx, &dev.tx})
+        {
+            //timed bursts move a fraction of the rate by design, they pass on finding a sustainable lead,
+            //every other stream has to move samples even when no target rate was asked for
+            const double rate = (rts->elapsed > 0.0)?(rts->totalSamples/rts->elapsed):0.0;
+            const bool rateOk = rts->timedBurst?(rts->minLead != 0.0):(rts->totalSamples > 0 and rate >= target);
+            const bool ok = rts->error.empty() and rateOk and (rts != &dev.rx or verifyPassed(dev));
+            passed = passed and ok;
+            if (not rts->timedBurst) minRate = std::min(minRate, rate);
+            if (reporter == nullptr) continue;
+            auto record = makeRecord("final", *rts, rts->elapsed, rts->elapsed, rts->totalSamples,
+                rts->overflows, rts->underflows, rts->lostSamples, rts->timing);
+            record.pass = (target > 0.0 or not ok)?int(ok):-1;
+            reporter->write(record);
+        }
+    }
+
+    passed = passed and checkFailed == nullptr;
+    if (target > 0.0) printf("Target %g Msps, slowest stream %g Msps: %s\n", target/1e6, minRate/1e6, passed?"PASS":"FAIL");
+    else if (not passed) printf("Rate test FAIL: %s\n", not verified?"RX verification":(checkFailed == nullptr)?"stream error, no samples or no sustainable burst lead":checkFailed);
+    if (target > 0.0 and not verified) printf("RX verification FAIL\n");
+    fflush(stdout);
+    if (reporter != nullptr)
+    {
+        RateTestRecord record;
+        record.type = "result";
+        record.device = "all";
+        record.sampleRate = args.sampleRate;
+        record.rate = minRate;
+        record.pass = int(passed);
+        reporter->write(record);
+    }
+    return passed;
+}
+
+int SoapySDRRateTest(const SoapySDRRateTestArgs &args)
+{
+    std::vector<SoapySDR::Device *> devices;
+    std::unique_ptr<RateTestReporter> reporter;
+    std::vector<RateTestDevice> devs;
 
     try
     {
-        device = SoapySDR::Device::make(argStr);
+        //records own stdout, the human readable progress moves over to stderr
+        if (not args.outputFormat.empty())
+        {
+            if (not rateTestOutputSupported(args.outputFormat)) throw std::runtime_error("unknown output format " + args.outputFormat);
+            std::cout.flush();
+            fflush(stdout);
+            FILE *records = fdopen(dup(STDOUT_FILENO), "w");
+            dup2(STDERR_FILENO, STDOUT_FILENO);
+            reporter.reset(new RateTestReporter(args.outputFormat, records));
+        }
+        if (args.compare and args.resultsPath.empty()) throw std::runtime_error("--compare reads the stored runs from --results");
+        if (args.engineThreads != 0 and (args.timedBurst or args.relay))
+        {
+            throw std::runtime_error("the coroutine engine drives the continuous stream loop, not timed bursts or the relay");
+        }
+
+        const auto deviceArgs = resolveDeviceArgs(args);
+        if (args.allocCheck) enableAllocationCheck();
+        if (args.profile) enableProfile();
+        BufferPool pool(args.hugePages, args.numaNode);
 
         //build channels list, using KwargsFromString is a easy parsing hack
         std::vector<size_t> channels;
-        for (const auto &pair : SoapySDR::KwargsFromString(channelStr))
+        for (const auto &pair : SoapySDR::KwargsFromString(args.channelStr))
         {
             channels.push_back(std::stoi(pair.first));
         }
         if (channels.empty()) channels.push_back(0);
 
-        //initialize the frequency and sample rate for all channels
-        for (const auto &chan : channels)
-        {
-            device->setFrequency(SOAPY_SDR_RX, chan, frequency);
-            device->setFrequency(SOAPY_SDR_TX, chan, frequency);
+        //devices are opened in parallel by the factory
+        std::cout << "Make " << deviceArgs.size() << " device(s)" << std::endl;
+        devices = SoapySDR::Device::make(deviceArgs);
 
-            device->setBandwidth(SOAPY_SDR_RX, chan, bandwidth);
-            device->setBandwidth(SOAPY_SDR_TX, chan, bandwidth);
-            
-            device->setSampleRate(SOAPY_SDR_RX, chan, sampleRate);
-            device->setSampleRate(SOAPY_SDR_TX, chan, sampleRate);
+        //the sweep runs its own short trials one device at a time
+        if (args.sweep)
+        {
+            signal(SIGINT, sigIntHandler);
+            bool streamed(true);
+            for (size_t i = 0; i < devices.size(); i++)
+            {
+                const auto it = deviceArgs[i].find("label");
+                const auto label = std::to_string(i) + ": " + ((it != deviceArgs[i].end())?it->second:SoapySDR::KwargsToString(deviceArgs[i]));
+                configureChannels(args, channels, devices[i], {SOAPY_SDR_RX, SOAPY_SDR_TX});
+                streamed = runTransferSweep(args, channels, devices[i], label) and streamed;
+            }
+            SoapySDR::Device::unmake(devices);
+            return streamed?EXIT_SUCCESS:EXIT_FAILURE;
+        }
 
-            device->setGain(SOAPY_SDR_RX, chan, rxGain);
-            device->setGain(SOAPY_SDR_TX, chan, txGain);
+        //and the rate search, which runs the rate test streams over and over at one device
+        if (not args.search.empty())
+        {
+            signal(SIGINT, sigIntHandler);
+            bool found(true);
+            for (size_t i = 0; i < devices.size() and not interrupted; i++)
+            {
+                const auto it = deviceArgs[i].find("label");
+                const auto label = std::to_string(i) + ": " + ((it != deviceArgs[i].end())?it->second:SoapySDR::KwargsToString(deviceArgs[i]));
+                found = runRateSearch(args, channels, devices[i], label, reporter.get()) and found;
+            }
+            SoapySDR::Device::unmake(devices);
+            return found?EXIT_SUCCESS:EXIT_FAILURE;
         }
 
-        //create the stream, use the native format
-        double fullScale(0.0);
-        const auto rxFormat = formatStr.empty() ? device->getNativeStreamFormat(SOAPY_SDR_RX, channels.front(), fullScale) : formatStr;
-        const size_t rxElemSize = SoapySDR::formatToSize(rxFormat);
-        auto rxStream = device->setupStream(SOAPY_SDR_RX, rxFormat, channels);
+        //so does the matrix, over every rate, format and channel count the device reports
+        if (args.matrix)
+        {
+            signal(SIGINT, sigIntHandler);
+            bool sustained(true);
+            for (size_t i = 0; i < devices.size(); i++)
+            {
+                const auto it = deviceArgs[i].find("label");
+                const auto label = std::to_string(i) + ": " + ((it != deviceArgs[i].end())?it->second:SoapySDR::KwargsToString(deviceArgs[i]));
+                sustained = runThroughputMatrix(args, devices[i], label, reporter.get()) and sustained;
+            }
+            SoapySDR::Device::unmake(devices);
+            return sustained?EXIT_SUCCESS:EXIT_FAILURE;
+        }
 
-        const auto txFormat = formatStr.empty() ? device->getNativeStreamFormat(SOAPY_SDR_RX, channels.front(), fullScale) : formatStr;
-        const size_t txElemSize = SoapySDR::formatToSize(txFormat);
-        auto txStream = device->setupStream(SOAPY_SDR_TX, txFormat, channels);
+        devs = std::vector<RateTestDevice>(devices.size());
+        for (size_t i = 0; i < devs.size(); i++)
+        {
+            auto &dev = devs[i];
+            const auto it = deviceArgs[i].find("label");
+            dev.label = std::to_string(i) + ": " + ((it != deviceArgs[i].end())?it->second:SoapySDR::KwargsToString(deviceArgs[i]));
+            dev.rx.label = dev.tx.label = dev.label;
+            dev.rx.reporter = dev.tx.reporter = reporter.get();
+            dev.rx.pool = dev.tx.pool = &pool;
+            dev.device = devices[i];
+            if (devs.size() > 1) dev.rx.name = dev.tx.name = "Dev " + std::to_string(i) + " ";
+            if (not args.capturePath.empty()) dev.capturePath = args.capturePath + ((devs.size() > 1)?("." + std::to_string(i)):"");
+            setupRateTestDevice(args, channels, dev, {SOAPY_SDR_RX, SOAPY_SDR_TX});
+        }
 
         //run the rate test one setup is complete
-        std::cout << "RX format: " << rxFormat << " TX format: " << txFormat << std::endl;
-        std::cout << "Num channels: " << channels.size() << std::endl;
-        std::cout << "RX Element size: " << rxElemSize << " bytes" << "TX Element size: " << txElemSize << " bytes" << std::endl;
-        std::cout << "Begin rate test at " << (sampleRate/1e6) << " Msps" << std::endl;
+        std::cout << "Begin rate test at " << (args.sampleRate/1e6) << " Msps" << std::endl;
 
         signal(SIGINT, sigIntHandler);
 
         SoapySDR::setLogLevel(SoapySDR::LogLevel::SOAPY_SDR_INFO);
 
+        //statistics are printed from here, the stream threads only publish counters
+        std::vector<RateTestStream *> streams;
+        for (auto &dev : devs)
+        {
+            streams.push_back(&dev.rx);
+            streams.push_back(&dev.tx);
+        }
+        RateTestThreads threads;
+        threads.reporter = std::thread(runReporterLoop, std::cref(args), std::cref(streams), std::cref(threads.reporterDone));
+
+        if (args.engineThreads != 0) threads.engine = startStreamEngine(args);
+        auto *engine = threads.engine.get();
         std::cout << "Create rxThread " << std::endl;
-        auto rxThread = std::thread([device, rxStream, channels, rxElemSize, frequency, sampleRate]() {
-            runRateTestStreamLoop(device, rxStream, SOAPY_SDR_RX, channels.size(), rxElemSize, frequency, sampleRate);
-        });
+        for (size_t i = 0; i < devs.size(); i++)
+        {
+            if (engine) spawnStreamTask(args, *engine, devs[i].rx);
+            else threads.streams.push_back(startStreamThread(args, devs[i].rx, pickCpu(args.rxCpus, i)));
+        }
+
+        //the relay starts consuming at once, everything else gives RX time to settle
+        if (not args.relay) sleep(2);
 
-        sleep(2);
-        
         std::cout << "Create txThread " << std::endl;
-        auto txThread = std::thread([device, txStream, channels, txElemSize, frequency, sampleRate]() {
-            runRateTestStreamLoop(device, txStream, SOAPY_SDR_TX, channels.size(), txElemSize, frequency, sampleRate);
-        });
+        for (size_t i = 0; i < devs.size(); i++)
+        {
+            if (engine) spawnStreamTask(args, *engine, devs[i].tx);
+            else threads.streams.push_back(startStreamThread(args, devs[i].tx, pickCpu(args.txCpus, i)));
+        }
+
+        //a fixed length run ends on its own, the warmup does not count towards it
+        if (args.duration > 0.0)
+        {
+            const auto deadline = std::chrono::steady_clock::now() + std::chrono::duration<double>(args.warmup + args.duration);
+            while (not loopDone and std::chrono::steady_clock::now() < deadline)
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            }
+            loopDone = true;
+        }
 
         std::cout << "Join rxThread " << std::endl;
-        rxThread.join();
-        txThread.join();
+        threads.join();
+        for (auto *rts : streams) rts->status->stop();
+        printf("\n");
+        for (auto *rts : streams) finishStreamReport(*rts);
+        for (auto &dev : devs)
+        {
+            if (dev.capture) dev.capture->stop();
+            if (dev.verify) dev.verify->stop();
+            if (dev.convert) dev.convert->stop();
+            if (dev.dsp) dev.dsp->stop();
+            if (dev.net) dev.net->stop();
+        }
 
         //cleanup stream and device
-        device->closeStream(rxStream);
-        device->closeStream(txStream);
-        SoapySDR::Device::unmake(device);
+        for (auto &dev : devs) closeRateTestStreams(dev);
+        printRateTestSummary(args, devs);
+        printEngineSummary(devs, engine);
+        if (args.profile) printProfileSummary(args);
+        const char *checkFailed = printMemorySummary(args, pool)?nullptr:"steady state allocations";
+        if (not args.resultsPath.empty())
+        {
+            const ResultsStore store(args.resultsPath);
+            const auto run = currentStoredRun();
+            const auto stored = storedStreams(devs, run);
+            if (args.compare and not printComparison(args, store, run, stored) and checkFailed == nullptr) checkFailed = "regression against the stored runs";
+            store.append(run, stored);
+            std::cout << "Stored run " << run.id << " in " << store.path() << std::endl;
+        }
+        const bool passed = judgeRateTest(args, devs, checkFailed, reporter.get());
+        SoapySDR::Device::unmake(devices);
+        return passed?EXIT_SUCCESS:EXIT_FAILURE;
     }
     catch (const std::exception &ex)
     {
         std::cerr << "Error in rate test: " << ex.what() << std::endl;
-        SoapySDR::Device::unmake(device);
+        for (auto &dev : devs) closeRateTestStreams(dev);
+        SoapySDR::Device::unmake(devices);
         return EXIT_FAILURE;
     }
-    return EXIT_FAILURE;
 }
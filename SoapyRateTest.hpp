@@ -0,0 +1,146 @@
+// Copyright (c) 2026 SoapySDR contributors
+// SPDX-License-Identifier: BSL-1.0
+
+#pragma once
+#include <string>
+#include <vector>
+
+/*!
+ * Options for SoapySDRRateTest, filled in from the command line.
+ */
+struct SoapySDRRateTestArgs
+{
+    //! One device argument string per device under test
+    std::vector<std::string> deviceArgs;
+
+    //! Open every device returned by enumerating each entry of deviceArgs
+    bool enumerateAll = false;
+
+    double frequency = 0.0;
+    double bandwidth = 0.0;
+    double sampleRate = 0.0; //with matrix the lowest rate tried, with search the highest, 0 spans the whole range
+    double rxGain = 40.0;
+    double txGain = -30.0;
+    bool rxGainGiven = false; //--rxGain was passed, not the default
+    std::string formatStr;
+    std::string channelStr;
+
+    //! Stream arguments passed to setupStream
+    std::string streamArgs;
+
+    //! Elements per stream call, 0 uses the stream MTU
+    size_t numElems = 0;
+
+    //! TX tone offset in Hz, 0 means sampleRate/16
+    double toneFreq = 0.0;
+
+    //! Alternate between the copy and direct buffer access paths
+    bool directAccess = false;
+
+    //! Back stream buffers with huge pages
+    bool hugePages = false;
+
+    //! Cores for the RX and TX stream threads, assigned round robin, empty for any
+    std::vector<int> rxCpus;
+    std::vector<int> txCpus;
+
+    //! SCHED_FIFO priority for the stream threads, 0 leaves the default policy
+    int priority = 0;
+
+    //! Bind stream buffer memory to this NUMA node, -1 for the default policy
+    int numaNode = -1;
+
+    //! Record RX to this file, several devices get a ".N" suffix
+    std::string capturePath;
+
+    //! Check RX against the TX pattern of a loopback setup: "tone" or "prbs", empty to skip
+    std::string verifyPattern;
+
+    //! Open RX in its native format and convert to formatStr on this many host threads, 0 converts in the driver
+    size_t convertThreads = 0;
+
+    //! Run these synthetic kernels on every RX block and search for the highest sustained load, empty to skip
+    std::string dspKernels;
+
+    //! Worker threads for the DSP kernels, 0 uses one per core
+    size_t dspThreads = 0;
+
+    //! Transmit this sample file instead of the tone
+    std::string replayPath;
+
+    //! Passes over the replay file before the test stops, 0 loops forever
+    unsigned long long replayLoops = 0;
+
+    //! Transmit time tagged bursts and search for the smallest lead without late bursts
+    bool timedBurst = false;
+
+    //! Initial lead time in seconds for the timed burst search
+    double burstLead = 10e-3;
+
+    //! Transmit the received blocks instead of the tone, each one lead after its RX time with hardware time
+    bool relay = false;
+    double relayLead = 10e-3;
+
+    //! Forward the received blocks over UDP to this host:port, a peer in --netSource mode, empty to skip
+    std::string netSink;
+
+    //! Most sample bytes per datagram of the network sink
+    size_t netPayload = 1400;
+
+    //! Multiplex every stream as a coroutine over this many threads with non-blocking calls, 0 gives each stream its own thread
+    size_t engineThreads = 0;
+
+    //! Count heap allocations in the steady state stream and pipeline loops and fail the run on any
+    bool allocCheck = false;
+
+    //! Count cycles per phase of the stream and pipeline loops, with the perf counters of their threads
+    bool profile = false;
+
+    //! Run short trials over transfer sizes and stream arguments instead of the rate test
+    bool sweep = false;
+
+    //! Element counts for the sweep, empty spans a range around the stream MTU
+    std::vector<size_t> sweepElems;
+
+    //! Stream argument sets for the sweep, empty uses streamArgs
+    std::vector<std::string> sweepStreamArgs;
+
+    //! Measured seconds per sweep and matrix trial
+    double sweepTime = 2.0;
+
+    //! Map the highest sustained rate of every probed format and channel count instead of the rate test
+    bool matrix = false;
+
+    //! Flow events per second a matrix trial may see and still count as sustained
+    double matrixThreshold = 0.0;
+
+    //! Bisect for the highest sample rate which streams clean instead of the rate test: "rx", "tx", "duplex", or empty
+    std::string search;
+
+    //! Seconds each search trial must stream without flow events or timestamp gaps after its warmup
+    double soakTime = 5.0;
+
+    //! Stop after this many seconds of measurement, 0 runs until SIGINT
+    double duration = 0.0;
+
+    //! Stop each stream after this many measured samples, 0 for no limit
+    unsigned long long numSamples = 0;
+
+    //! Seconds at the start of each stream excluded from the statistics
+    double warmup = 0.0;
+
+    //! Structured records on stdout: "json", "csv", or empty for text only
+    std::string outputFormat;
+
+    //! Append the results and host metadata of the run to this file, empty to skip
+    std::string resultsPath;
+
+    //! Compare the run with the latest stored runs of the same setup, and fail on a significant regression
+    bool compare = false;
+    size_t compareRuns = 10; //0 compares with every stored run
+
+    //! Pass when every stream reaches this rate, negative means 99% of sampleRate, 0 only needs samples without errors
+    double targetRate = 0.0;
+};
+
+int SoapySDRRateTest(const SoapySDRRateTestArgs &args);
@@ -0,0 +1,28 @@
+// Copyright (c) 2026 SoapySDR contributors
+// SPDX-License-Identifier: BSL-1.0
+
+#include "SoapyRateThreads.hpp"
+#include <cstring>
+#include <pthread.h>
+#include <sched.h>
+
+std::string setThreadAffinity(std::thread &thread, const int cpu)
+{
+    if (cpu < 0 or cpu >= CPU_SETSIZE) return "cpu " + std::to_string(cpu) + " out of range";
+    cpu_set_t cpuSet;
+    CPU_ZERO(&cpuSet);
+    CPU_SET(cpu, &cpuSet);
+    const int ret = pthread_setaffinity_np(thread.native_handle(), sizeof(cpuSet), &cpuSet);
+    if (ret != 0) return "affinity cpu " + std::to_string(cpu) + " failed: " + strerror(ret);
+    return "";
+}
+
+std::string setThreadRealtime(std::thread &thread, const int priority)
+{
+    struct sched_param param;
+    std::memset(&param, 0, sizeof(param));
+    param.sched_priority = priority;
+    const int ret = pthread_setschedparam(thread.native_handle(), SCHED_FIFO, &param);
+    if (ret != 0) return "SCHED_FIFO " + std::to_string(priority) + " failed: " + strerror(ret);
+    return "";
+}
@@ -0,0 +1,18 @@
+// Copyright (c) 2026 SoapySDR contributors
+// SPDX-License-Identifier: BSL-1.0
+
+#pragma once
+#include <string>
+#include <thread>
+
+/*!
+ * Pin a thread to a single CPU core.
+ * \return an error message, empty on success
+ */
+std::string setThreadAffinity(std::thread &thread, const int cpu);
+
+/*!
+ * Switch a thread to SCHED_FIFO at the given priority.
+ * \return an error message, empty on success
+ */
+std::string setThreadRealtime(std::thread &thread, const int priority);
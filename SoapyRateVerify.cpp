@@ -0,0 +1,304 @@
+// Copyright (c) 2026 SoapySDR contributors
+// SPDX-License-Identifier: BSL-1.0
+
+#include "SoapyRateVerify.hpp"
+#include "SoapyRateAlloc.hpp"
+#include "SoapyRateProfile.hpp"
+#include <SoapySDR/Constants.h>
+#include <SoapySDR/Formats.hpp>
+#include <stdexcept>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+static const double MATCH_THRESHOLD = 0.8; //normalized correlation of a good block
+static const double SILENCE_LEVEL = 1e-6; //mean power relative to full scale below which nothing is received
+static const size_t PROBE_ELEMS = 256; //head of the block used to search the reference
+
+/***********************************************************************
+ * Block kernels, eight lanes in lock-step so the loops vectorize
+ **********************************************************************/
+static const size_t LANES = 8;
+
+struct SampleStats
+{
+    double power;
+    double sumRe;
+    double sumIm;
+    uint64_t clipped;
+};
+
+static SampleStats sampleStatsCF32(const float *x, const size_t numElems, const float clip)
+{
+    float pw[LANES] = {}, re[LANES] = {}, im[LANES] = {};
+    uint32_t cl[LANES] = {};
+    size_t i = 0;
+    for (; i + LANES <= numElems; i += LANES)
+    {
+        for (size_t k = 0; k < LANES; k++)
+        {
+            const float r = x[2*(i+k)+0];
+            const float q = x[2*(i+k)+1];
+            pw[k] += r*r + q*q;
+            re[k] += r;
+            im[k] += q;
+            cl[k] += (std::max(std::abs(r), std::abs(q)) >= clip)?1:0;
+        }
+    }
+
+    SampleStats s{0.0, 0.0, 0.0, 0};
+    for (size_t k = 0; k < LANES; k++)
+    {
+        s.power += pw[k];
+        s.sumRe += re[k];
+        s.sumIm += im[k];
+        s.clipped += cl[k];
+    }
+    for (; i < numElems; i++)
+    {
+        const float r = x[2*i+0];
+        const float q = x[2*i+1];
+        s.power += r*r + q*q;
+        s.sumRe += r;
+        s.sumIm += q;
+        s.clipped += (std::max(std::abs(r), std::abs(q)) >= clip)?1:0;
+    }
+    return s;
+}
+
+//sum of x*conj(ref), the magnitude does not depend on the loopback phase
+static void correlateCF32(const float *x, const float *ref, const size_t numElems, double &outRe, double &outIm)
+{
+    float cr[LANES] = {}, ci[LANES] = {};
+    size_t i = 0;
+    for (; i + LANES <= numElems; i += LANES)
+    {
+        for (size_t k = 0; k < LANES; k++)
+        {
+            const float xr = x[2*(i+k)+0], xi = x[2*(i+k)+1];
+            const float rr = ref[2*(i+k)+0], ri = ref[2*(i+k)+1];
+            cr[k] += xr*rr + xi*ri;
+            ci[k] += xi*rr - xr*ri;
+        }
+    }
+
+    outRe = outIm = 0.0;
+    for (size_t k = 0; k < LANES; k++)
+    {
+        outRe += cr[k];
+        outIm += ci[k];
+    }
+    for (; i < numElems; i++)
+    {
+        const float xr = x[2*i+0], xi = x[2*i+1];
+        const float rr = ref[2*i+0], ri = ref[2*i+1];
+        outRe += xr*rr + xi*ri;
+        outIm += xi*rr - xr*ri;
+    }
+}
+
+/***********************************************************************
+ * Verification stage
+ **********************************************************************/
+RxVerifier::RxVerifier(
+    BlockRing &ring,
+    const size_t consumer,
+    const size_t blockElems,
+    const std::string &rxFormat,
+    const double fullScale,
+    const double sampleRate,
+    const TxWaveform &reference,
+    const std::string &txFormat,
+    BufferPool &pool):
+    _ring(ring),
+    _consumer(consumer),
+    _format(rxFormat),
+    _fullScale(fullScale),
+    _sampleRate(sampleRate),
+    _patternElems(reference.numBuffers()*reference.numElems()),
+    _scratchMem(pool.acquire(1, 2*blockElems*sizeof(float))),
+    _scratch(static_cast<float *>(_scratchMem->slice(0))),
+    _scratchElems(blockElems),
+    _state(ring.numChans()),
+    _stats(ring.numChans()),
+    _havePrev(false),
+    _prevTimeNs(0),
+    _prevElems(0),
+    _done(false),
+    _checked(0),
+    _bad(0),
+    _skipped(0)
+{
+    if (not signalFormatSupported(rxFormat)) throw std::runtime_error("RX verification unsupported format " + rxFormat);
+
+    //the reference is unrolled by one block so every window is contiguous
+    const size_t refElems = _patternElems + blockElems;
+    _ref.resize(2*refElems);
+    for (size_t i = 0; i < refElems; i += reference.numElems())
+    {
+        const size_t n = std::min(reference.numElems(), refElems - i);
+        unpackToCF32(reference.buffer(i/reference.numElems()), _ref.data() + 2*i, n, txFormat);
+    }
+    _refEnergy.resize(refElems + 1, 0.0);
+    for (size_t i = 0; i < refElems; i++)
+    {
+        _refEnergy[i+1] = _refEnergy[i] + double(_ref[2*i])*_ref[2*i] + double(_ref[2*i+1])*_ref[2*i+1];
+    }
+
+    _thread = std::thread(&RxVerifier::verifyLoop, this);
+}
+
+RxVerifier::~RxVerifier(void)
+{
+    this->stop();
+}
+
+void RxVerifier::stop(void)
+{
+    _done = true;
+    if (not _thread.joinable()) return;
+    _thread.join();
+    for (size_t c = 0; c < _state.size(); c++) _stats[c].trailing = _state[c].pendingBad;
+}
+
+void RxVerifier::verifyLoop(void)
+{
+    SteadyStateAllocations allocs("verify");
+    ThreadProfile prof("verify");
+    while (true)
+    {
+        BlockRing::BlockInfo info;
+        void * const *slot = _ring.readSlot(_consumer, info);
+        if (slot == nullptr)
+        {
+            if (_done) break;
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+            prof.lap(PROFILE_IDLE);
+            continue;
+        }
+        prof.lap(PROFILE_HANDOFF);
+
+        //never hold up the ring, a stage which fell behind skips ahead and only tracks the position
+        const bool skip = _ring.pending(_consumer) > _ring.numSlots()/2;
+        if (skip) _skipped.fetch_add(1, std::memory_order_relaxed);
+        this->verifyBlock(skip?nullptr:slot, info);
+        prof.lap(PROFILE_PROCESSING);
+        _ring.release(_consumer);
+        prof.lap(PROFILE_HANDOFF);
+        allocs.begin();
+    }
+}
+
+void RxVerifier::verifyBlock(void * const *slot, const BlockRing::BlockInfo &info)
+{
+    //the timestamps say how far the reference moved since the last block, else the block length does
+    const bool hasTime = (info.flags & SOAPY_SDR_HAS_TIME) != 0;
+    size_t advance = _prevElems;
+    if (_havePrev and hasTime)
+    {
+        const long long period = (long long)_patternElems;
+        const long long ticks = std::llround((info.timeNs - _prevTimeNs)*_sampleRate/1e9);
+        advance = size_t(ticks%period + period);
+    }
+    for (auto &st : _state) st.pos = (st.pos + advance)%_patternElems;
+    _havePrev = hasTime;
+    _prevTimeNs = info.timeNs;
+    _prevElems = info.numElems;
+    if (slot == nullptr) return;
+
+    const size_t numElems = std::min(info.numElems, _scratchElems);
+    for (size_t c = 0; c < _state.size(); c++)
+    {
+        unpackToCF32(slot[c], _scratch, numElems, _format);
+        this->verifyChannel(c, numElems);
+    }
+    _checked.fetch_add(1, std::memory_order_relaxed);
+}
+
+void RxVerifier::verifyChannel(const size_t chan, const size_t numElems)
+{
+    auto &st = _state[chan];
+    auto &stats = _stats[chan];
+    const float *x = _scratch;
+    const auto s = sampleStatsCF32(x, numElems, float(0.99*_fullScale));
+    const bool silent = s.power < SILENCE_LEVEL*_fullScale*_fullScale*numElems;
+
+    //nothing comes back until the TX stream starts
+    if (not stats.locked and silent) return;
+
+    double rho = silent?0.0:this->correlation(x, numElems, s.power, st.pos);
+    int64_t slip(0);
+    if (rho < MATCH_THRESHOLD and not silent)
+    {
+        const size_t found = this->acquire(x, numElems);
+        const double foundRho = this->correlation(x, numElems, s.power, found);
+        if (foundRho >= MATCH_THRESHOLD)
+        {
+            slip = int64_t((found + _patternElems - st.pos)%_patternElems);
+            if (slip > int64_t(_patternElems/2)) slip -= int64_t(_patternElems);
+            st.pos = found;
+            rho = foundRho;
+        }
+    }
+
+    if (not stats.locked)
+    {
+        if (rho < MATCH_THRESHOLD) return;
+        stats.locked = true;
+        slip = 0;
+    }
+
+    stats.blocks++;
+    stats.samples += numElems;
+    stats.power += s.power;
+    stats.sumRe += s.sumRe;
+    stats.sumIm += s.sumIm;
+    stats.clipped += s.clipped;
+    if (rho < MATCH_THRESHOLD)
+    {
+        st.pendingBad++;
+        return;
+    }
+
+    //failures only count once the stream is seen to recover after them
+    stats.corrupted += st.pendingBad;
+    uint64_t bad = st.pendingBad;
+    st.pendingBad = 0;
+    stats.minCorrelation = std::min(stats.minCorrelation, rho);
+    if (slip != 0)
+    {
+        stats.slips++;
+        stats.slipSamples += slip;
+        bad++;
+    }
+    if (bad != 0) _bad.fetch_add(bad, std::memory_order_relaxed);
+}
+
+double RxVerifier::correlation(const float *x, const size_t numElems, const double power, const size_t pos) const
+{
+    double re, im;
+    correlateCF32(x, _ref.data() + 2*pos, numElems, re, im);
+    const double refPower = _refEnergy[pos + numElems] - _refEnergy[pos];
+    if (power <= 0.0 or refPower <= 0.0) return 0.0;
+    return std::sqrt((re*re + im*im)/(power*refPower));
+}
+
+//best matching reference position for the head of a block
+size_t RxVerifier::acquire(const float *x, const size_t numElems) const
+{
+    const size_t n = std::min(PROBE_ELEMS, numElems);
+    size_t best(0);
+    double bestScore(-1.0);
+    for (size_t pos = 0; pos < _patternElems; pos++)
+    {
+        double re, im;
+        correlateCF32(x, _ref.data() + 2*pos, n, re, im);
+        const double refPower = _refEnergy[pos + n] - _refEnergy[pos];
+        if (refPower <= 0.0) continue;
+        const double score = (re*re + im*im)/refPower;
+        if (score <= bestScore) continue;
+        bestScore = score;
+        best = pos;
+    }
+    return best;
+}
@@ -0,0 +1,146 @@
+// Copyright (c) 2026 SoapySDR contributors
+// SPDX-License-Identifier: BSL-1.0
+
+#pragma once
+#include "SoapyRateBuffers.hpp"
+#include "SoapyRateSignal.hpp"
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+//! Results of the RX verification for one channel
+struct VerifyChannelStats
+{
+    uint64_t blocks = 0; //blocks checked once the pattern was found
+    uint64_t corrupted = 0; //blocks which match no position of the pattern
+    uint64_t trailing = 0; //failed blocks at the end of the run, usually TX stopping first
+    uint64_t slips = 0; //blocks found somewhere other than their timestamps predict
+    int64_t slipSamples = 0; //net samples missing in slips, negative when repeated
+    uint64_t samples = 0;
+    uint64_t clipped = 0; //samples with a component at full scale
+    double power = 0.0; //sum of |x|^2 in format units
+    double sumRe = 0.0;
+    double sumIm = 0.0;
+    double minCorrelation = 1.0; //worst normalized correlation of a good block
+    bool locked = false; //the pattern was found at least once
+};
+
+/*!
+ * Verification stage which checks RX blocks against the TX pattern of a loopback setup.
+ *
+ * It is a BlockRing consumer on its own thread. Each block is unpacked to
+ * CF32, power, DC and clipping are accumulated, and the block is correlated
+ * against the reference ring at the position predicted from the previous
+ * block and the timestamps. A block which does not match there is searched
+ * for over the whole reference: found elsewhere it is a slip, samples went
+ * missing without the timestamps showing it, not found at all it is corrupt.
+ *
+ * A tone matches at any position, so only a PRBS pattern detects slips.
+ * When the stage falls behind it skips blocks rather than hold up the ring.
+ */
+class RxVerifier
+{
+public:
+    /*!
+     * \param ring the source ring
+     * \param consumer this stage's consumer index in the ring
+     * \param blockElems largest number of elements in a ring slot
+     * \param rxFormat the RX stream format
+     * \param fullScale RX full scale in format units, for clipping and dBFS
+     * \param sampleRate converts timestamp differences into samples
+     * \param reference the transmitted waveform ring
+     * \param txFormat the format the reference is stored in
+     * \param pool where the unpacked block scratch comes from
+     * \throws std::runtime_error for a format which cannot be unpacked
+     */
+    RxVerifier(
+        BlockRing &ring,
+        const size_t consumer,
+        const size_t blockElems,
+        const std::string &rxFormat,
+        const double fullScale,
+        const double sampleRate,
+        const TxWaveform &reference,
+        const std::string &txFormat,
+        BufferPool &pool);
+
+    ~RxVerifier(void);
+
+    RxVerifier(const RxVerifier &) = delete;
+    RxVerifier &operator=(const RxVerifier &) = delete;
+
+    //! Check what is left in the ring, then stop the thread
+    void stop(void);
+
+    //! Elements in one period of the reference pattern
+    size_t patternElems(void) const
+    {
+        return _patternElems;
+    }
+
+    double fullScale(void) const
+    {
+        return _fullScale;
+    }
+
+    uint64_t checkedBlocks(void) const
+    {
+        return _checked.load(std::memory_order_relaxed);
+    }
+
+    //! Corrupted blocks and slips so far
+    uint64_t badBlocks(void) const
+    {
+        return _bad.load(std::memory_order_relaxed);
+    }
+
+    //! Blocks passed over because the stage fell behind
+    uint64_t skippedBlocks(void) const
+    {
+        return _skipped.load(std::memory_order_relaxed);
+    }
+
+    //! Per channel results, only valid after stop()
+    const std::vector<VerifyChannelStats> &channels(void) const
+    {
+        return _stats;
+    }
+
+private:
+    struct ChannelState
+    {
+        size_t pos = 0; //reference position of the next block
+        uint64_t pendingBad = 0; //failed blocks not yet followed by a good one
+    };
+
+    void verifyLoop(void);
+    void verifyBlock(void * const *slot, const BlockRing::BlockInfo &info);
+    void verifyChannel(const size_t chan, const size_t numElems);
+    double correlation(const float *x, const size_t numElems, const double power, const size_t pos) const;
+    size_t acquire(const float *x, const size_t numElems) const;
+
+    BlockRing &_ring;
+    const size_t _consumer;
+    const std::string _format;
+    const double _fullScale;
+    const double _sampleRate;
+    size_t _patternElems;
+    std::vector<float> _ref; //one pattern period plus a block, so no window wraps
+    std::vector<double> _refEnergy; //prefix sums of |ref|^2
+    BufferPool::Lease _scratchMem;
+    float *_scratch; //one block of interleaved CF32
+    size_t _scratchElems;
+    std::vector<ChannelState> _state;
+    std::vector<VerifyChannelStats> _stats;
+    bool _havePrev;
+    long long _prevTimeNs;
+    size_t _prevElems;
+    std::atomic<bool> _done;
+    std::atomic<uint64_t> _checked;
+    std::atomic<uint64_t> _bad;
+    std::atomic<uint64_t> _skipped;
+    std::thread _thread;
+};
@@ -0,0 +1,191 @@
+// Copyright (c) 2026 SoapySDR contributors
+// SPDX-License-Identifier: BSL-1.0
+
+#include <SoapySDR/ConverterRegistry.hpp>
+#include <SoapySDR/Modules.hpp>
+#include <SoapySDR/Formats.hpp>
+#include "SoapyRateBuffers.hpp"
+#include "SoapyRateThreads.hpp"
+#include "SoapyRateStats.hpp"
+#include <string>
+#include <vector>
+#include <memory>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+static const size_t MIN_BUFF_BYTES = 4*1024; //source bytes per call, from L1 resident...
+static const size_t MAX_BUFF_BYTES = 64*1024*1024; //...to well beyond the last level cache
+static const size_t MAX_TOTAL_BYTES = size_t(1) << 30; //buffers of all threads together
+static const double TRIAL_SECONDS = 0.05;
+static const double FALLOFF_FRACTION = 0.7; //a size runs slower than this fraction of the peak
+
+//cycle counter ticks per second, 0 when there is no usable counter
+static double cycleCounterRate(void)
+{
+    #if defined(__x86_64__) || defined(__i386__)
+    const double t0 = steadyNs()/1e9;
+    const unsigned long long c0 = __rdtsc();
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    const unsigned long long c1 = __rdtsc();
+    const double t1 = steadyNs()/1e9;
+    return (c1 - c0)/(t1 - t0);
+    #else
+    return 0.0;
+    #endif
+}
+
+static std::string priorityName(const SoapySDR::ConverterRegistry::FunctionPriority priority)
+{
+    switch (priority)
+    {
+    case SoapySDR::ConverterRegistry::GENERIC: return "generic";
+    case SoapySDR::ConverterRegistry::VECTORIZED: return "vectorized";
+    case SoapySDR::ConverterRegistry::CUSTOM: return "custom";
+    }
+    return "priority " + std::to_string(int(priority));
+}
+
+static std::string sizeName(const size_t bytes)
+{
+    if (bytes >= 1024*1024) return std::to_string(bytes/(1024*1024)) + " MiB";
+    return std::to_string(bytes/1024) + " KiB";
+}
+
+/***********************************************************************
+ * One trial: every thread converts its own buffers for the trial time
+ **********************************************************************/
+static double runBenchTrial(
+    const SoapySDR::ConverterRegistry::ConverterFunction fn,
+    const size_t inSize,
+    const size_t outSize,
+    const size_t numElems,
+    const size_t numThreads)
+{
+    //populated page aligned buffers, one arena per thread so none share pages
+    std::vector<std::unique_ptr<BufferArena>> arenas;
+    for (size_t t = 0; t < numThreads; t++)
+    {
+        arenas.emplace_back(new BufferArena(2, numElems*std::max(inSize, outSize)));
+        std::memset(arenas.back()->slice(0), 0x11, numElems*inSize);
+    }
+
+    std::atomic<size_t> ready(0);
+    std::atomic<bool> go(false);
+    std::vector<double> rates(numThreads, 0.0);
+    std::vector<std::thread> threads;
+    const unsigned numCpus = std::max(1u, std::thread::hardware_concurrency());
+    for (size_t t = 0; t < numThreads; t++)
+    {
+        threads.emplace_back([&, t]() {
+            const void *in = arenas[t]->slice(0);
+            void *out = arenas[t]->slice(1);
+            ready++;
+            while (not go) std::this_thread::yield();
+
+            //one call first so cache resident sizes start out hot
+            fn(in, out, numElems, 1.0);
+            unsigned long long calls(0);
+            const double t0 = steadyNs()/1e9;
+            double t1(t0);
+            do
+            {
+                fn(in, out, numElems, 1.0);
+                calls++;
+                t1 = steadyNs()/1e9;
+            } while (t1 - t0 < TRIAL_SECONDS);
+            rates[t] = calls*numElems/(t1 - t0);
+        });
+        if (numThreads > 1) setThreadAffinity(threads.back(), int(t%numCpus));
+    }
+    while (ready != numThreads) std::this_thread::yield();
+    go = true;
+    for (auto &thread : threads) thread.join();
+
+    double total(0.0);
+    for (const auto rate : rates) total += rate;
+    return total;
+}
+
+/***********************************************************************
+ * Every registered source to target pair at every priority
+ **********************************************************************/
+int SoapySDRConverterBench(const size_t threadsArg)
+{
+    typedef SoapySDR::ConverterRegistry Registry;
+    const size_t numThreads = (threadsArg != 0)?threadsArg:std::max(1u, std::thread::hardware_concurrency());
+    const double cycleRate = cycleCounterRate();
+    const bool multi = numThreads > 1;
+
+    //driver modules register their own converters when they load
+    SoapySDR::loadModules();
+
+    printf("Converter benchmark: 1%s thread%s, %g ms per trial, buffers %s to %s per thread",
+        multi?(" and " + std::to_string(numThreads)).c_str():"", multi?"s":"",
+        TRIAL_SECONDS*1e3, sizeName(MIN_BUFF_BYTES).c_str(), sizeName(MAX_BUFF_BYTES).c_str());
+    if (cycleRate > 0.0) printf(", cycle counter %.2f GHz", cycleRate/1e9);
+    printf("\n");
+
+    for (const auto &source : Registry::listAvailableSourceFormats())
+    {
+        for (const auto &target : Registry::listTargetFormats(source))
+        {
+            for (const auto priority : Registry::listPriorities(source, target))
+            {
+                const auto fn = Registry::getFunction(source, target, priority);
+                const size_t inSize = SoapySDR::formatToSize(source);
+                const size_t outSize = SoapySDR::formatToSize(target);
+
+                printf("\n%s -> %s, %s\n", source.c_str(), target.c_str(), priorityName(priority).c_str());
+                printf("  %10s %10s %10s", "buffer", "GS/s", "B/cycle");
+                if (multi) printf(" %10s %10s %8s", ("GS/s x" + std::to_string(numThreads)).c_str(), "B/cycle", "scaling");
+                printf("\n");
+
+                double peak(0.0);
+                size_t peakBytes(0), falloffBytes(0);
+                for (size_t bytes = MIN_BUFF_BYTES; bytes <= MAX_BUFF_BYTES; bytes *= 4)
+                {
+                    const size_t numElems = bytes/inSize;
+                    const double one = runBenchTrial(fn, inSize, outSize, numElems, 1);
+                    const double oneBytes = one*(inSize + outSize);
+                    printf("  %10s %10.3f", sizeName(bytes).c_str(), one/1e9);
+                    if (cycleRate > 0.0) printf(" %10.2f", oneBytes/cycleRate);
+                    else printf(" %10s", "-");
+
+                    //bytes per cycle of the wall clock, summed over all threads
+                    const size_t footprint = numThreads*numElems*(inSize + outSize);
+                    if (multi and footprint <= MAX_TOTAL_BYTES)
+                    {
+                        const double many = runBenchTrial(fn, inSize, outSize, numElems, numThreads);
+                        printf(" %10.3f", many/1e9);
+                        if (cycleRate > 0.0) printf(" %10.2f", many*(inSize + outSize)/cycleRate);
+                        else printf(" %10s", "-");
+                        printf(" %7.2fx", many/one);
+                    }
+                    else if (multi) printf(" %10s %10s %8s", "-", "-", "-");
+                    printf("\n");
+                    fflush(stdout);
+
+                    if (one > peak)
+                    {
+                        peak = one;
+                        peakBytes = bytes;
+                    }
+                    if (falloffBytes == 0 and one < FALLOFF_FRACTION*peak) falloffBytes = bytes;
+                }
+
+                printf("  peak %.3f GS/s at %s", peak/1e9, sizeName(peakBytes).c_str());
+                if (falloffBytes != 0) printf(", below %.0f%% of peak from %s\n", 100*FALLOFF_FRACTION, sizeName(falloffBytes).c_str());
+                else printf(", no fall off up to %s\n", sizeName(MAX_BUFF_BYTES).c_str());
+            }
+        }
+    }
+    return EXIT_SUCCESS;
+}
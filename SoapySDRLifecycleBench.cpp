@@ -0,0 +1,222 @@
+// Copyright (c) 2026 SoapySDR contributors
+// SPDX-License-Identifier: BSL-1.0
+
+#include <SoapySDR/Device.hpp>
+#include <SoapySDR/Formats.hpp>
+#include <SoapySDR/Errors.hpp>
+#include "SoapyRateTest.hpp"
+#include "SoapyRateStats.hpp"
+#include <string>
+#include <vector>
+#include <chrono>
+#include <stdexcept>
+#include <iostream>
+#include <cstdio>
+#include <cstdlib>
+
+static const long FIRST_SAMPLE_TIMEOUT_US = 100000; //per readStream call
+static const double FIRST_SAMPLE_GIVE_UP = 5.0; //seconds after activateStream without a sample
+
+/***********************************************************************
+ * Steps of one open, stream, close cycle
+ **********************************************************************/
+enum LifecycleStep
+{
+    STEP_MAKE,
+    STEP_FREQUENCY,
+    STEP_SAMPLE_RATE,
+    STEP_BANDWIDTH,
+    STEP_GAIN,
+    STEP_SETUP_STREAM,
+    STEP_ACTIVATE,
+    STEP_FIRST_SAMPLE,
+    STEP_DEACTIVATE,
+    STEP_CLOSE_STREAM,
+    STEP_UNMAKE,
+    STEP_COLD_START, //make through the first sample
+    STEP_CYCLE, //the whole iteration
+    NUM_STEPS
+};
+
+static const char *stepName(const int step)
+{
+    switch (step)
+    {
+    case STEP_MAKE: return "make";
+    case STEP_FREQUENCY: return "setFrequency";
+    case STEP_SAMPLE_RATE: return "setSampleRate";
+    case STEP_BANDWIDTH: return "setBandwidth";
+    case STEP_GAIN: return "setGain";
+    case STEP_SETUP_STREAM: return "setupStream";
+    case STEP_ACTIVATE: return "activateStream";
+    case STEP_FIRST_SAMPLE: return "activate to 1st sample";
+    case STEP_DEACTIVATE: return "deactivateStream";
+    case STEP_CLOSE_STREAM: return "closeStream";
+    case STEP_UNMAKE: return "unmake";
+    case STEP_COLD_START: return "make to 1st sample";
+    case STEP_CYCLE: return "full cycle";
+    }
+    return "";
+}
+
+//elapsed ns of every step in one iteration, steps which were skipped stay negative
+typedef std::vector<int64_t> LifecycleTimes;
+
+/***********************************************************************
+ * One iteration, the stream is closed and the device unmade before returning
+ **********************************************************************/
+static LifecycleTimes runLifecycle(const SoapySDRRateTestArgs &args, const std::vector<size_t> &channels)
+{
+    LifecycleTimes times(NUM_STEPS, -1);
+    const int64_t cycleStart = steadyNs();
+    int64_t allocTime(0);
+    int64_t t0 = cycleStart;
+    auto lap = [&times, &t0](const int step)
+    {
+        const int64_t t1 = steadyNs();
+        times[step] = t1 - t0;
+        t0 = t1;
+    };
+
+    auto device = SoapySDR::Device::make(args.deviceArgs.empty()?"":args.deviceArgs.front());
+    lap(STEP_MAKE);
+    SoapySDR::Stream *stream(nullptr);
+    bool active(false);
+    try
+    {
+        if (args.frequency != 0.0)
+        {
+            for (const auto chan : channels) device->setFrequency(SOAPY_SDR_RX, chan, args.frequency);
+            lap(STEP_FREQUENCY);
+        }
+        if (args.sampleRate != 0.0)
+        {
+            for (const auto chan : channels) device->setSampleRate(SOAPY_SDR_RX, chan, args.sampleRate);
+            lap(STEP_SAMPLE_RATE);
+        }
+        if (args.bandwidth != 0.0)
+        {
+            for (const auto chan : channels) device->setBandwidth(SOAPY_SDR_RX, chan, args.bandwidth);
+            lap(STEP_BANDWIDTH);
+        }
+        if (args.rxGainGiven)
+        {
+            for (const auto chan : channels) device->setGain(SOAPY_SDR_RX, chan, args.rxGain);
+            lap(STEP_GAIN);
+        }
+
+        double fullScale(0.0);
+        const auto format = args.formatStr.empty()?device->getNativeStreamFormat(SOAPY_SDR_RX, channels.front(), fullScale):args.formatStr;
+        stream = device->setupStream(SOAPY_SDR_RX, format, channels, SoapySDR::KwargsFromString(args.streamArgs));
+        lap(STEP_SETUP_STREAM);
+
+        //buffers are not part of any step, nor of the totals
+        const int64_t allocStart = steadyNs();
+        const size_t numElems = (args.numElems != 0)?args.numElems:device->getStreamMTU(stream);
+        std::vector<std::vector<char>> buffMem(channels.size(), std::vector<char>(numElems*SoapySDR::formatToSize(format)));
+        std::vector<void *> buffs;
+        for (auto &mem : buffMem) buffs.push_back(mem.data());
+        t0 = steadyNs();
+        allocTime = t0 - allocStart;
+
+        int ret = device->activateStream(stream);
+        if (ret != 0) throw std::runtime_error(std::string("activateStream failed: ") + SoapySDR::errToStr(ret));
+        active = true;
+        lap(STEP_ACTIVATE);
+        const int64_t giveUpNs = t0 + int64_t(FIRST_SAMPLE_GIVE_UP*1e9);
+        while (true)
+        {
+            int flags(0);
+            long long timeNs(0);
+            ret = device->readStream(stream, buffs.data(), numElems, flags, timeNs, FIRST_SAMPLE_TIMEOUT_US);
+            if (ret > 0) break;
+            if (ret != SOAPY_SDR_TIMEOUT and ret != SOAPY_SDR_OVERFLOW) throw std::runtime_error(std::string("readStream failed: ") + SoapySDR::errToStr(ret));
+            if (steadyNs() > giveUpNs) throw std::runtime_error("no samples within " + std::to_string(FIRST_SAMPLE_GIVE_UP) + " s of activateStream");
+        }
+        times[STEP_FIRST_SAMPLE] = steadyNs() - t0 + times[STEP_ACTIVATE];
+        times[STEP_COLD_START] = steadyNs() - cycleStart - allocTime;
+        t0 = steadyNs();
+
+        active = false;
+        device->deactivateStream(stream);
+        lap(STEP_DEACTIVATE);
+        auto closing = stream;
+        stream = nullptr;
+        device->closeStream(closing);
+        lap(STEP_CLOSE_STREAM);
+    }
+    catch (...)
+    {
+        //a failed cycle still leaves the device clean for the next one
+        try
+        {
+            if (active) device->deactivateStream(stream);
+            if (stream != nullptr) device->closeStream(stream);
+        }
+        catch (const std::exception &) {}
+        SoapySDR::Device::unmake(device);
+        throw;
+    }
+    SoapySDR::Device::unmake(device);
+    lap(STEP_UNMAKE);
+    times[STEP_CYCLE] = steadyNs() - cycleStart - allocTime;
+    return times;
+}
+
+/***********************************************************************
+ * Repeat the cycle and print the distribution of every step
+ **********************************************************************/
+int SoapySDRLifecycleBench(const SoapySDRRateTestArgs &args, const size_t iterations)
+{
+    std::vector<size_t> channels;
+    for (const auto &pair : SoapySDR::KwargsFromString(args.channelStr))
+    {
+        channels.push_back(std::stoi(pair.first));
+    }
+    if (channels.empty()) channels.push_back(0);
+
+    std::cout << "Lifecycle benchmark: " << iterations << " iterations of make, configure, stream RX until the first sample, close" << std::endl;
+    LifecycleTimes first(NUM_STEPS, -1);
+    std::vector<LatencyHistogram> hists(NUM_STEPS);
+    size_t failed(0);
+    std::string firstError;
+    for (size_t i = 0; i < iterations; i++)
+    {
+        //a failed cycle is counted and the benchmark goes on, the cycles so far still count
+        LifecycleTimes times;
+        try
+        {
+            times = runLifecycle(args, channels);
+        }
+        catch (const std::exception &ex)
+        {
+            if (failed++ == 0) firstError = "iteration " + std::to_string(i) + ": " + ex.what();
+            std::cout << "x" << std::flush;
+            continue;
+        }
+        if (i == 0) first = times;
+        for (size_t step = 0; step < NUM_STEPS; step++)
+        {
+            //the first iteration pays for module and driver initialization, it is reported apart
+            if (i != 0 and times[step] >= 0) hists[step].record(uint64_t(times[step]));
+        }
+        std::cout << "." << std::flush;
+    }
+    std::cout << std::endl;
+
+    printf("  %-22s %10s %10s %10s %10s %10s %10s %10s\n", "step ms", "first", "min", "p50", "p90", "p99", "max", "mean");
+    for (size_t step = 0; step < NUM_STEPS; step++)
+    {
+        const auto &h = hists[step];
+        if (first[step] < 0 and h.count() == 0) continue;
+        printf("  %-22s", stepName(step));
+        if (first[step] < 0) printf(" %10s", "-");
+        else printf(" %10.3f", first[step]/1e6);
+        if (h.count() == 0) printf(" %10s %10s %10s %10s %10s %10s\n", "-", "-", "-", "-", "-", "-");
+        else printf(" %10.3f %10.3f %10.3f %10.3f %10.3f %10.3f\n", h.percentile(0)/1e6, h.percentile(50)/1e6,
+            h.percentile(90)/1e6, h.percentile(99)/1e6, h.max()/1e6, h.mean()/1e6);
+    }
+    if (failed != 0) printf("  %zu of %zu cycles failed, the first in %s\n", failed, iterations, firstError.c_str());
+    fflush(stdout);
+    return (failed == 0)?EXIT_SUCCESS:EXIT_FAILURE;
+}
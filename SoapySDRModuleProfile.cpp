@@ -0,0 +1,182 @@
+// Copyright (c) 2026 SoapySDR contributors
+// SPDX-License-Identifier: BSL-1.0
+
+#include <SoapySDR/Modules.hpp>
+#include <SoapySDR/Registry.hpp>
+#include <SoapySDR/ConverterRegistry.hpp>
+#include "SoapyRateStats.hpp"
+#include <string>
+#include <vector>
+#include <set>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <dlfcn.h>
+#include <link.h>
+
+//paths of every shared object mapped into the process
+static std::set<std::string> loadedObjects(void)
+{
+    std::set<std::string> result;
+    dl_iterate_phdr([](struct dl_phdr_info *info, size_t, void *data) -> int
+    {
+        if (info->dlpi_name != nullptr and info->dlpi_name[0] != '\0')
+        {
+            static_cast<std::set<std::string> *>(data)->insert(info->dlpi_name);
+        }
+        return 0;
+    }, &result);
+    return result;
+}
+
+static size_t numConverters(void)
+{
+    typedef SoapySDR::ConverterRegistry Registry;
+    size_t count(0);
+    for (const auto &source : Registry::listAvailableSourceFormats())
+    {
+        for (const auto &target : Registry::listTargetFormats(source))
+        {
+            count += Registry::listPriorities(source, target).size();
+        }
+    }
+    return count;
+}
+
+struct ModuleProfile
+{
+    std::string path;
+    std::string error;
+    double coldTime = 0.0; //first load in this process, seconds
+    double warmTime = 0.0; //reload with the files in the page cache
+    double preloadedTime = 0.0; //load once the dependencies were mapped in parallel
+    std::vector<std::string> dependencies; //objects the load mapped besides the module
+    std::vector<std::string> factories;
+    size_t converters = 0;
+};
+
+/***********************************************************************
+ * Load passes over every module
+ **********************************************************************/
+//load each module in turn, recording what the first pass brought in with it
+static double loadSequential(std::vector<ModuleProfile> &profiles, double ModuleProfile::*time, const bool first)
+{
+    const double t0 = steadyNs()/1e9;
+    for (auto &profile : profiles)
+    {
+        const auto objectsBefore = first?loadedObjects():std::set<std::string>();
+        const auto factoriesBefore = first?SoapySDR::Registry::listFindFunctions():SoapySDR::FindFunctions();
+        const size_t convertersBefore = first?numConverters():0;
+
+        const double start = steadyNs()/1e9;
+        const auto error = SoapySDR::loadModule(profile.path);
+        profile.*time = steadyNs()/1e9 - start;
+        if (not first) continue;
+        profile.error = error;
+
+        for (const auto &object : loadedObjects())
+        {
+            if (objectsBefore.count(object) == 0 and object != profile.path) profile.dependencies.push_back(object);
+        }
+        for (const auto &it : SoapySDR::Registry::listFindFunctions())
+        {
+            if (factoriesBefore.count(it.first) == 0) profile.factories.push_back(it.first);
+        }
+        profile.converters = numConverters() - convertersBefore;
+    }
+    return steadyNs()/1e9 - t0;
+}
+
+static void unloadAll(const std::vector<ModuleProfile> &profiles)
+{
+    for (auto it = profiles.rbegin(); it != profiles.rend(); ++it) SoapySDR::unloadModule(it->path);
+}
+
+//map every dependency from a pool of threads, then register the modules in order
+static double loadPreloaded(std::vector<ModuleProfile> &profiles, const size_t numThreads)
+{
+    std::vector<std::string> dependencies;
+    for (const auto &profile : profiles)
+    {
+        for (const auto &dep : profile.dependencies)
+        {
+            if (std::find(dependencies.begin(), dependencies.end(), dep) == dependencies.end()) dependencies.push_back(dep);
+        }
+    }
+
+    const double t0 = steadyNs()/1e9;
+    std::vector<void *> handles(dependencies.size(), nullptr);
+    std::atomic<size_t> next(0);
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < numThreads; t++)
+    {
+        threads.emplace_back([&]()
+        {
+            for (size_t i = next++; i < dependencies.size(); i = next++)
+            {
+                handles[i] = dlopen(dependencies[i].c_str(), RTLD_NOW | RTLD_LOCAL);
+            }
+        });
+    }
+    for (auto &thread : threads) thread.join();
+    loadSequential(profiles, &ModuleProfile::preloadedTime, false);
+    const double total = steadyNs()/1e9 - t0;
+
+    //the modules hold their own references now
+    for (auto handle : handles) if (handle != nullptr) dlclose(handle);
+    return total;
+}
+
+/***********************************************************************
+ * Time every module load and compare the preload strategies
+ **********************************************************************/
+int SoapySDRModuleProfile(void)
+{
+    std::vector<ModuleProfile> profiles;
+    for (const auto &path : SoapySDR::listModules())
+    {
+        profiles.emplace_back();
+        profiles.back().path = path;
+    }
+    if (profiles.empty())
+    {
+        printf("No modules found!\n");
+        return EXIT_FAILURE;
+    }
+    const size_t numThreads = std::min<size_t>(profiles.size(), std::max(1u, std::thread::hardware_concurrency()));
+
+    //modules already loaded by this process would hide their cost
+    unloadAll(profiles);
+    const double cold = loadSequential(profiles, &ModuleProfile::coldTime, true);
+    unloadAll(profiles);
+    const double warm = loadSequential(profiles, &ModuleProfile::warmTime, false);
+    unloadAll(profiles);
+    const double preloaded = loadPreloaded(profiles, numThreads);
+
+    std::vector<const ModuleProfile *> sorted;
+    for (const auto &profile : profiles) sorted.push_back(&profile);
+    std::sort(sorted.begin(), sorted.end(), [](const ModuleProfile *a, const ModuleProfile *b)
+    {
+        return a->coldTime > b->coldTime;
+    });
+
+    printf("Module load profile, %zu modules, slowest first load first:\n", profiles.size());
+    printf("  %10s %10s %10s %6s %5s %5s %6s  %s\n", "first ms", "warm ms", "preload ms", "share", "deps", "facts", "convs", "module");
+    for (const auto *profile : sorted)
+    {
+        printf("  %10.2f %10.2f %10.2f %5.1f%% %5zu %5zu %6zu  %s\n", profile->coldTime*1e3, profile->warmTime*1e3,
+            profile->preloadedTime*1e3, 100.0*profile->coldTime/cold, profile->dependencies.size(),
+            profile->factories.size(), profile->converters, profile->path.c_str());
+        if (not profile->error.empty()) printf("  %10s error: %s\n", "", profile->error.c_str());
+        std::string factories;
+        for (const auto &name : profile->factories) factories += (factories.empty()?"":", ") + name;
+        if (not factories.empty()) printf("  %10s factories: %s\n", "", factories.c_str());
+    }
+
+    printf("Sequential first load %.2f ms, sequential warm %.2f ms, parallel dependency preload on %zu thread%s %.2f ms (%.2fx warm)\n",
+        cold*1e3, warm*1e3, numThreads, (numThreads == 1)?"":"s", preloaded*1e3, (preloaded > 0.0)?(warm/preloaded):0.0);
+    return EXIT_SUCCESS;
+}
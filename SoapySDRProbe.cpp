@@ -3,75 +3,272 @@
 // SPDX-License-Identifier: BSL-1.0
 
 #include <SoapySDR/Device.hpp>
-#include <sstream>
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <exception>
+#include <algorithm>
 #include <limits>
+#include <cstdio>
 
-template <typename Type>
-std::string toString(const std::vector<Type> &options)
+static const size_t PROBE_RESERVE = 64*1024; //output bytes reserved up front, most probes fit
+
+/***********************************************************************
+ * Everything the probe queries, collected before anything is printed
+ **********************************************************************/
+struct SensorProbe
 {
-    std::stringstream ss;
-    if (options.empty()) return "";
-    for (size_t i = 0; i < options.size(); i++)
+    std::string key;
+    SoapySDR::ArgInfo info;
+    std::string reading;
+};
+
+struct NamedRange
+{
+    std::string name;
+    SoapySDR::Range range;
+};
+
+struct NamedRangeList
+{
+    std::string name;
+    SoapySDR::RangeList ranges;
+};
+
+struct ChannelProbe
+{
+    int dir = SOAPY_SDR_RX;
+    size_t chan = 0;
+    SoapySDR::Kwargs info;
+    bool fullDuplex = false;
+    bool agc = false;
+    std::vector<std::string> formats;
+    std::string native;
+    double fullScale = 0.0;
+    SoapySDR::ArgInfoList streamArgs;
+    std::vector<std::string> antennas;
+    std::vector<std::string> corrections;
+    SoapySDR::Range gainRange;
+    std::vector<NamedRange> gains;
+    SoapySDR::RangeList freqRange;
+    std::vector<NamedRangeList> freqs;
+    SoapySDR::ArgInfoList freqArgs;
+    SoapySDR::RangeList rates;
+    SoapySDR::RangeList bandwidths;
+    std::vector<std::string> sensorKeys;
+    std::vector<SensorProbe> sensors;
+    SoapySDR::ArgInfoList settings;
+};
+
+struct DeviceProbe
+{
+    std::string driver;
+    std::string hardware;
+    SoapySDR::Kwargs hardwareInfo;
+    size_t numRxChans = 0;
+    size_t numTxChans = 0;
+    bool hardwareTime = false;
+    std::vector<std::string> clockSources;
+    std::vector<std::string> timeSources;
+    std::vector<std::string> sensorKeys;
+    std::vector<SensorProbe> sensors;
+    std::vector<std::string> registers;
+    SoapySDR::ArgInfoList settings;
+    std::vector<std::string> gpios;
+    std::vector<std::string> uarts;
+    std::vector<ChannelProbe> channels;
+};
+
+/***********************************************************************
+ * Collection pass, only driver calls
+ **********************************************************************/
+static std::vector<SensorProbe> collectSensors(SoapySDR::Device *device, const std::vector<std::string> &keys)
+{
+    std::vector<SensorProbe> sensors(keys.size());
+    for (size_t i = 0; i < keys.size(); i++)
     {
-        if (not ss.str().empty()) ss << ", ";
-        ss << options[i];
+        sensors[i].key = keys[i];
+        sensors[i].info = device->getSensorInfo(keys[i]);
+        sensors[i].reading = device->readSensor(keys[i]);
     }
-    return ss.str();
+    return sensors;
 }
 
-std::string toString(const SoapySDR::Range &range)
+static std::vector<SensorProbe> collectSensors(SoapySDR::Device *device, const int dir, const size_t chan, const std::vector<std::string> &keys)
 {
-    std::stringstream ss;
-    ss << "[" << range.minimum() << ", " << range.maximum();
-    if (range.step() != 0.0) ss << ", " << range.step();
-    ss << "]";
-    return ss.str();
+    std::vector<SensorProbe> sensors(keys.size());
+    for (size_t i = 0; i < keys.size(); i++)
+    {
+        sensors[i].key = keys[i];
+        sensors[i].info = device->getSensorInfo(dir, chan, keys[i]);
+        sensors[i].reading = device->readSensor(dir, chan, keys[i]);
+    }
+    return sensors;
 }
 
-std::string toString(const SoapySDR::RangeList &range, const double scale)
+static void collectChannel(SoapySDR::Device *device, ChannelProbe &p)
 {
-    const size_t MAXRLEN = 10; //for abbreviating long lists
-    std::stringstream ss;
-    for (size_t i = 0; i < range.size(); i++)
+    const int dir = p.dir;
+    const size_t chan = p.chan;
+    p.info = device->getChannelInfo(dir, chan);
+    p.fullDuplex = device->getFullDuplex(dir, chan);
+    p.agc = device->hasGainMode(dir, chan);
+    p.formats = device->getStreamFormats(dir, chan);
+    p.native = device->getNativeStreamFormat(dir, chan, p.fullScale);
+    p.streamArgs = device->getStreamArgsInfo(dir, chan);
+    p.antennas = device->listAntennas(dir, chan);
+
+    if (device->hasDCOffsetMode(dir, chan)) p.corrections.push_back("DC removal");
+    if (device->hasDCOffset(dir, chan)) p.corrections.push_back("DC offset");
+    if (device->hasIQBalance(dir, chan)) p.corrections.push_back("IQ balance");
+
+    p.gainRange = device->getGainRange(dir, chan);
+    for (const auto &name : device->listGains(dir, chan))
     {
-        if (range.size() >= MAXRLEN and i >= MAXRLEN/2 and i < (range.size()-MAXRLEN/2))
+        p.gains.push_back(NamedRange{name, device->getGainRange(dir, chan, name)});
+    }
+    p.freqRange = device->getFrequencyRange(dir, chan);
+    for (const auto &name : device->listFrequencies(dir, chan))
+    {
+        p.freqs.push_back(NamedRangeList{name, device->getFrequencyRange(dir, chan, name)});
+    }
+    p.freqArgs = device->getFrequencyArgsInfo(dir, chan);
+    p.rates = device->getSampleRateRange(dir, chan);
+    p.bandwidths = device->getBandwidthRange(dir, chan);
+    p.sensorKeys = device->listSensors(dir, chan);
+    p.sensors = collectSensors(device, dir, chan, p.sensorKeys);
+    p.settings = device->getSettingInfo(dir, chan);
+}
+
+//channels are independent, several threads query them at once when asked to
+static void collectChannels(SoapySDR::Device *device, std::vector<ChannelProbe> &channels, const size_t threadsArg)
+{
+    const size_t numThreads = std::min(channels.size(), (threadsArg == 0)?channels.size():threadsArg);
+    std::vector<std::exception_ptr> errors(channels.size());
+    std::atomic<size_t> next(0);
+    auto worker = [&]()
+    {
+        for (size_t i = next++; i < channels.size(); i = next++)
         {
-            if (i == MAXRLEN) ss << ", ...";
-            continue;
+            try
+            {
+                collectChannel(device, channels[i]);
+            }
+            catch (...)
+            {
+                errors[i] = std::current_exception();
+            }
+        }
+    };
+
+    if (numThreads <= 1) worker();
+    else
+    {
+        std::vector<std::thread> threads;
+        for (size_t t = 0; t < numThreads; t++) threads.emplace_back(worker);
+        for (auto &thread : threads) thread.join();
+    }
+
+    //the first failing channel fails the probe, as a sequential probe would
+    for (const auto &error : errors)
+    {
+        if (error) std::rethrow_exception(error);
+    }
+}
+
+static void collectDevice(SoapySDR::Device *device, DeviceProbe &p, const size_t numThreads)
+{
+    p.driver = device->getDriverKey();
+    p.hardware = device->getHardwareKey();
+    p.hardwareInfo = device->getHardwareInfo();
+    p.numRxChans = device->getNumChannels(SOAPY_SDR_RX);
+    p.numTxChans = device->getNumChannels(SOAPY_SDR_TX);
+    p.hardwareTime = device->hasHardwareTime();
+    p.clockSources = device->listClockSources();
+    p.timeSources = device->listTimeSources();
+    p.sensorKeys = device->listSensors();
+    p.sensors = collectSensors(device, p.sensorKeys);
+    p.registers = device->listRegisterInterfaces();
+    p.settings = device->getSettingInfo();
+    p.gpios = device->listGPIOBanks();
+    p.uarts = device->listUARTs();
+
+    for (const int dir : {SOAPY_SDR_RX, SOAPY_SDR_TX})
+    {
+        const size_t numChans = (dir == SOAPY_SDR_RX)?p.numRxChans:p.numTxChans;
+        for (size_t chan = 0; chan < numChans; chan++)
+        {
+            p.channels.emplace_back();
+            p.channels.back().dir = dir;
+            p.channels.back().chan = chan;
         }
-        if (not ss.str().empty()) ss << ", ";
-        if (range[i].minimum() == range[i].maximum()) ss << (range[i].minimum()/scale);
-        else ss << "[" << (range[i].minimum()/scale) << ", " << (range[i].maximum()/scale) << "]";
     }
-    return ss.str();
+    collectChannels(device, p.channels, numThreads);
 }
 
-std::string toString(const std::vector<double> &nums, const double scale)
+/***********************************************************************
+ * Render pass, everything appends to one output string
+ **********************************************************************/
+static void appendNum(std::string &out, const double num)
 {
-    std::stringstream ss;
+    char buff[32];
+    const int len = std::snprintf(buff, sizeof(buff), "%g", num);
+    if (len > 0) out.append(buff, std::min(size_t(len), sizeof(buff) - 1));
+}
 
-    if (nums.size() > 3)
+static void appendList(std::string &out, const std::vector<std::string> &options)
+{
+    for (size_t i = 0; i < options.size(); i++)
     {
-        ss << "[" << (nums.front()/scale) << ", " << (nums.back()/scale) << "]";
-        return ss.str();
+        if (i != 0) out += ", ";
+        out += options[i];
     }
+}
 
-    for (size_t i = 0; i < nums.size(); i++)
+static void appendRange(std::string &out, const SoapySDR::Range &range)
+{
+    out += "[";
+    appendNum(out, range.minimum());
+    out += ", ";
+    appendNum(out, range.maximum());
+    if (range.step() != 0.0)
     {
-        if (not ss.str().empty()) ss << ", ";
-        ss << (nums[i]/scale);
+        out += ", ";
+        appendNum(out, range.step());
     }
-    return "[" + ss.str() + "]";
+    out += "]";
 }
 
-std::string toString(const SoapySDR::ArgInfo &argInfo, const std::string indent = "    ")
+static void appendRangeList(std::string &out, const SoapySDR::RangeList &range, const double scale)
 {
-    std::stringstream ss;
+    const size_t MAXRLEN = 10; //for abbreviating long lists
+    for (size_t i = 0; i < range.size(); i++)
+    {
+        if (range.size() >= MAXRLEN and i >= MAXRLEN/2 and i < (range.size()-MAXRLEN/2))
+        {
+            if (i == MAXRLEN/2) out += ", ...";
+            continue;
+        }
+        if (i != 0) out += ", ";
+        if (range[i].minimum() == range[i].maximum()) appendNum(out, range[i].minimum()/scale);
+        else
+        {
+            out += "[";
+            appendNum(out, range[i].minimum()/scale);
+            out += ", ";
+            appendNum(out, range[i].maximum()/scale);
+            out += "]";
+        }
+    }
+}
 
+static void appendArgInfo(std::string &out, const SoapySDR::ArgInfo &argInfo, const std::string &indent = "    ")
+{
     //name, or use key if missing
-    std::string name = argInfo.name;
-    if (argInfo.name.empty()) name = argInfo.key;
-    ss << indent << " * " << name;
+    out += indent;
+    out += " * ";
+    out += argInfo.name.empty()?argInfo.key:argInfo.name;
 
     //optional description
     std::string desc = argInfo.description;
@@ -80,257 +277,223 @@ std::string toString(const SoapySDR::ArgInfo &argInfo, const std::string indent
     {
         desc.replace(pos, 1, replace);
     }
-    if (not desc.empty()) ss << " - " << desc << std::endl << indent << "  ";
+    if (not desc.empty())
+    {
+        out += " - ";
+        out += desc;
+        out += "\n";
+        out += indent;
+        out += "  ";
+    }
 
     //other fields
-    ss << " [key=" << argInfo.key;
-    if (not argInfo.units.empty()) ss << ", units=" << argInfo.units;
-    if (not argInfo.value.empty()) ss << ", default=" << argInfo.value;
+    out += " [key=";
+    out += argInfo.key;
+    if (not argInfo.units.empty()) out += ", units=" + argInfo.units;
+    if (not argInfo.value.empty()) out += ", default=" + argInfo.value;
 
     //type
     switch (argInfo.type)
     {
-    case SoapySDR::ArgInfo::BOOL: ss << ", type=bool"; break;
-    case SoapySDR::ArgInfo::INT: ss << ", type=int"; break;
-    case SoapySDR::ArgInfo::FLOAT: ss << ", type=float"; break;
-    case SoapySDR::ArgInfo::STRING: ss << ", type=string"; break;
+    case SoapySDR::ArgInfo::BOOL: out += ", type=bool"; break;
+    case SoapySDR::ArgInfo::INT: out += ", type=int"; break;
+    case SoapySDR::ArgInfo::FLOAT: out += ", type=float"; break;
+    case SoapySDR::ArgInfo::STRING: out += ", type=string"; break;
     }
 
     //optional range/enumeration
-    if (argInfo.range.minimum() < argInfo.range.maximum()) ss << ", range=" << toString(argInfo.range);
-    if (not argInfo.options.empty()) ss << ", options=(" << toString(argInfo.options) << ")";
-
-    ss << "]";
-
-    return ss.str();
-}
-
-std::string toString(const SoapySDR::ArgInfoList &argInfos)
-{
-    std::stringstream ss;
-
-    for (size_t i = 0; i < argInfos.size(); i++)
+    if (argInfo.range.minimum() < argInfo.range.maximum())
     {
-        ss << toString(argInfos[i]) << std::endl;
+        out += ", range=";
+        appendRange(out, argInfo.range);
     }
-
-    return ss.str();
+    if (not argInfo.options.empty())
+    {
+        out += ", options=(";
+        appendList(out, argInfo.options);
+        out += ")";
+    }
+    out += "]";
 }
 
-std::string sensorReadings(SoapySDR::Device *device)
+static void appendArgInfoList(std::string &out, const SoapySDR::ArgInfoList &argInfos)
 {
-    std::stringstream ss;
-
-    /*******************************************************************
-     * Sensor readings
-     ******************************************************************/
-    std::vector<std::string> sensors = device->listSensors();
-
-    for (size_t i = 0; i < sensors.size(); i++)
+    for (const auto &argInfo : argInfos)
     {
-        std::string key = sensors[i];
-        SoapySDR::ArgInfo info = device->getSensorInfo(key);
-        std::string reading = device->readSensor(key);
-
-        ss << "     * " << sensors[i];
-        if (not info.name.empty()) ss << " (" << info.name << ")";
-        ss << ":";
-        if (info.range.maximum() > std::numeric_limits<double>::min()) ss << toString(info.range);
-        ss << toString(info.options);
-        ss << " " << reading;
-        if (not info.units.empty()) ss << " " << info.units;
-        ss << std::endl;
-        if (not info.description.empty()) ss << "        " << info.description << std::endl;
+        appendArgInfo(out, argInfo);
+        out += "\n";
     }
-
-    return ss.str();
 }
 
-std::string channelSensorReadings(SoapySDR::Device *device, const int dir, const size_t chan)
+//a labelled line of the list, nothing when the list is empty
+static void appendListLine(std::string &out, const char *label, const std::vector<std::string> &list)
 {
-    std::stringstream ss;
+    if (list.empty()) return;
+    out += label;
+    appendList(out, list);
+    out += "\n";
+}
 
-    /*******************************************************************
-     * Channel sensor readings
-     ******************************************************************/
-    std::vector<std::string> sensors = device->listSensors(dir, chan);
+static void appendArgInfoSection(std::string &out, const char *label, const SoapySDR::ArgInfoList &argInfos)
+{
+    if (argInfos.empty()) return;
+    out += label;
+    appendArgInfoList(out, argInfos);
+}
 
-    for (size_t i = 0; i < sensors.size(); i++)
+static void appendSensors(std::string &out, const std::vector<SensorProbe> &sensors)
+{
+    for (const auto &sensor : sensors)
     {
-        std::string key = sensors[i];
-        SoapySDR::ArgInfo info = device->getSensorInfo(dir, chan, key);
-        std::string reading = device->readSensor(dir, chan, key);
-
-        ss << "     * " << sensors[i];
-        if (not info.name.empty()) ss << " (" << info.name << ")";
-        ss << ":";
-        if (info.range.maximum() > std::numeric_limits<double>::min()) ss << toString(info.range);
-        ss << toString(info.options);
-        ss << " " << reading;
-        if (not info.units.empty()) ss << " " << info.units;
-        ss << std::endl;
-        if (not info.description.empty()) ss << "        " << info.description << std::endl;
+        const auto &info = sensor.info;
+        out += "     * " + sensor.key;
+        if (not info.name.empty()) out += " (" + info.name + ")";
+        out += ":";
+        if (info.range.maximum() > std::numeric_limits<double>::min()) appendRange(out, info.range);
+        appendList(out, info.options);
+        out += " " + sensor.reading;
+        if (not info.units.empty()) out += " " + info.units;
+        out += "\n";
+        if (not info.description.empty()) out += "        " + info.description + "\n";
     }
-
-    return ss.str();
 }
 
-static std::string probeChannel(SoapySDR::Device *device, const int dir, const size_t chan)
+static void appendBanner(std::string &out, const std::string &title)
 {
-    std::stringstream ss;
+    out += "\n";
+    out += "----------------------------------------------------\n";
+    out += "-- " + title + "\n";
+    out += "----------------------------------------------------\n";
+}
 
-    std::string dirName = (dir==SOAPY_SDR_TX)?"TX":"RX";
-    ss << std::endl;
-    ss << "----------------------------------------------------" << std::endl;
-    ss << "-- " << dirName << " Channel " << chan << std::endl;
-    ss << "----------------------------------------------------" << std::endl;
+static void renderChannel(std::string &out, const ChannelProbe &p)
+{
+    appendBanner(out, std::string((p.dir == SOAPY_SDR_TX)?"TX":"RX") + " Channel " + std::to_string(p.chan));
 
     // info
-    const auto info = device->getChannelInfo(dir, chan);
-    if (info.size() > 0)
+    if (not p.info.empty())
     {
-        ss << "  Channel Information:" << std::endl;
-        for (const auto &it : info)
-        {
-            ss << "    " << it.first << "=" << it.second << std::endl;
-        }
+        out += "  Channel Information:\n";
+        for (const auto &it : p.info) out += "    " + it.first + "=" + it.second + "\n";
     }
 
-    ss << "  Full-duplex: " << (device->getFullDuplex(dir, chan)?"YES":"NO") << std::endl;
-    ss << "  Supports AGC: " << (device->hasGainMode(dir, chan)?"YES":"NO") << std::endl;
+    out += "  Full-duplex: ";
+    out += p.fullDuplex?"YES\n":"NO\n";
+    out += "  Supports AGC: ";
+    out += p.agc?"YES\n":"NO\n";
 
     //formats
-    std::string formats = toString(device->getStreamFormats(dir, chan));
-    if (not formats.empty()) ss << "  Stream formats: " << formats << std::endl;
+    appendListLine(out, "  Stream formats: ", p.formats);
 
     //native
-    double fullScale = 0.0;
-    std::string native = device->getNativeStreamFormat(dir, chan, fullScale);
-    ss << "  Native format: " << native << " [full-scale=" << fullScale << "]" << std::endl;    
+    out += "  Native format: " + p.native + " [full-scale=";
+    appendNum(out, p.fullScale);
+    out += "]\n";
 
     //stream args
-    std::string streamArgs = toString(device->getStreamArgsInfo(dir, chan));
-    if (not streamArgs.empty()) ss << "  Stream args:" << std::endl << streamArgs;
+    appendArgInfoSection(out, "  Stream args:\n", p.streamArgs);
 
     //antennas
-    std::string antennas = toString(device->listAntennas(dir, chan));
-    if (not antennas.empty()) ss << "  Antennas: " << antennas << std::endl;
+    appendListLine(out, "  Antennas: ", p.antennas);
 
     //corrections
-    std::vector<std::string> correctionsList;
-    if (device->hasDCOffsetMode(dir, chan)) correctionsList.push_back("DC removal");
-    if (device->hasDCOffset(dir, chan)) correctionsList.push_back("DC offset");
-    if (device->hasIQBalance(dir, chan)) correctionsList.push_back("IQ balance");
-    std::string corrections = toString(correctionsList);
-    if (not corrections.empty()) ss << "  Corrections: " << corrections << std::endl;
+    appendListLine(out, "  Corrections: ", p.corrections);
 
     //gains
-    ss << "  Full gain range: " << toString(device->getGainRange(dir, chan)) << " dB" << std::endl;
-    std::vector<std::string> gainsList = device->listGains(dir, chan);
-    for (size_t i = 0; i < gainsList.size(); i++)
+    out += "  Full gain range: ";
+    appendRange(out, p.gainRange);
+    out += " dB\n";
+    for (const auto &gain : p.gains)
     {
-        const std::string name = gainsList[i];
-        ss << "    " << name << " gain range: " << toString(device->getGainRange(dir, chan, name)) << " dB" << std::endl;
+        out += "    " + gain.name + " gain range: ";
+        appendRange(out, gain.range);
+        out += " dB\n";
     }
 
     //frequencies
-    ss << "  Full freq range: " << toString(device->getFrequencyRange(dir, chan), 1e6) << " MHz" << std::endl;
-    std::vector<std::string> freqsList = device->listFrequencies(dir, chan);
-    for (size_t i = 0; i < freqsList.size(); i++)
+    out += "  Full freq range: ";
+    appendRangeList(out, p.freqRange, 1e6);
+    out += " MHz\n";
+    for (const auto &freq : p.freqs)
     {
-        const std::string name = freqsList[i];
-        ss << "    " << name << " freq range: " << toString(device->getFrequencyRange(dir, chan, name), 1e6) << " MHz" << std::endl;
+        out += "    " + freq.name + " freq range: ";
+        appendRangeList(out, freq.ranges, 1e6);
+        out += " MHz\n";
     }
 
     //freq args
-    std::string freqArgs = toString(device->getFrequencyArgsInfo(dir, chan));
-    if (not freqArgs.empty()) ss << "  Tune args:" << std::endl << freqArgs;
+    appendArgInfoSection(out, "  Tune args:\n", p.freqArgs);
 
     //rates
-    ss << "  Sample rates: " << toString(device->getSampleRateRange(dir, chan), 1e6) << " MSps" << std::endl;
+    out += "  Sample rates: ";
+    appendRangeList(out, p.rates, 1e6);
+    out += " MSps\n";
 
     //bandwidths
-    const auto bws = device->getBandwidthRange(dir, chan);
-    if (not bws.empty()) ss << "  Filter bandwidths: " << toString(bws, 1e6) << " MHz" << std::endl;
+    if (not p.bandwidths.empty())
+    {
+        out += "  Filter bandwidths: ";
+        appendRangeList(out, p.bandwidths, 1e6);
+        out += " MHz\n";
+    }
 
     //sensors
-    std::string sensors = toString(device->listSensors(dir, chan));
-    if (not sensors.empty()) ss << "  Sensors: " << sensors << std::endl;
-    ss << channelSensorReadings(device, dir, chan);
+    appendListLine(out, "  Sensors: ", p.sensorKeys);
+    appendSensors(out, p.sensors);
 
     //settings
-    std::string settings = toString(device->getSettingInfo(dir, chan));
-    if (not settings.empty()) ss << "  Other Settings:" << std::endl << settings;
-
-    return ss.str();
+    appendArgInfoSection(out, "  Other Settings:\n", p.settings);
 }
 
-std::string SoapySDRDeviceProbe(SoapySDR::Device *device)
+static void renderDevice(std::string &out, const DeviceProbe &p)
 {
-    std::stringstream ss;
-
     /*******************************************************************
      * Identification info
      ******************************************************************/
-    ss << std::endl;
-    ss << "----------------------------------------------------" << std::endl;
-    ss << "-- Device identification" << std::endl;
-    ss << "----------------------------------------------------" << std::endl;
-
-    ss << "  driver=" << device->getDriverKey() << std::endl;
-    ss << "  hardware=" << device->getHardwareKey() << std::endl;
-    for (const auto &it : device->getHardwareInfo())
-    {
-        ss << "  " << it.first << "=" << it.second << std::endl;
-    }
+    appendBanner(out, "Device identification");
+    out += "  driver=" + p.driver + "\n";
+    out += "  hardware=" + p.hardware + "\n";
+    for (const auto &it : p.hardwareInfo) out += "  " + it.first + "=" + it.second + "\n";
 
     /*******************************************************************
      * Available peripherals
      ******************************************************************/
-    ss << std::endl;
-    ss << "----------------------------------------------------" << std::endl;
-    ss << "-- Peripheral summary" << std::endl;
-    ss << "----------------------------------------------------" << std::endl;
-
-    size_t numRxChans = device->getNumChannels(SOAPY_SDR_RX);
-    size_t numTxChans = device->getNumChannels(SOAPY_SDR_TX);
-    ss << "  Channels: " << numRxChans << " Rx, " << numTxChans << " Tx" << std::endl;
-
-    ss << "  Timestamps: " << (device->hasHardwareTime()?"YES":"NO") << std::endl;
-
-    std::string clockSources = toString(device->listClockSources());
-    if (not clockSources.empty()) ss << "  Clock sources: " << clockSources << std::endl;
-
-    std::string timeSources = toString(device->listTimeSources());
-    if (not timeSources.empty()) ss << "  Time sources: " << timeSources << std::endl;
-
-    std::string sensors = toString(device->listSensors());
-    if (not sensors.empty()) ss << "  Sensors: " << sensors << std::endl;
-    ss << sensorReadings(device);
-
-    std::string registers = toString(device->listRegisterInterfaces());
-    if (not registers.empty()) ss << "  Registers: " << registers << std::endl;
-
-    std::string settings = toString(device->getSettingInfo());
-    if (not settings.empty()) ss << "  Other Settings:" << std::endl << settings;
-
-    std::string gpios = toString(device->listGPIOBanks());
-    if (not gpios.empty()) ss << "  GPIOs: " << gpios << std::endl;
-
-    std::string uarts = toString(device->listUARTs());
-    if (not uarts.empty()) ss << "  UARTs: " << uarts << std::endl;
+    appendBanner(out, "Peripheral summary");
+    out += "  Channels: " + std::to_string(p.numRxChans) + " Rx, " + std::to_string(p.numTxChans) + " Tx\n";
+    out += "  Timestamps: ";
+    out += p.hardwareTime?"YES\n":"NO\n";
+    appendListLine(out, "  Clock sources: ", p.clockSources);
+    appendListLine(out, "  Time sources: ", p.timeSources);
+    appendListLine(out, "  Sensors: ", p.sensorKeys);
+    appendSensors(out, p.sensors);
+    appendListLine(out, "  Registers: ", p.registers);
+    appendArgInfoSection(out, "  Other Settings:\n", p.settings);
+    appendListLine(out, "  GPIOs: ", p.gpios);
+    appendListLine(out, "  UARTs: ", p.uarts);
 
     /*******************************************************************
      * Per-channel info
      ******************************************************************/
-    for (size_t chan = 0; chan < numRxChans; chan++)
-    {
-        ss << probeChannel(device, SOAPY_SDR_RX, chan);
-    }
-    for (size_t chan = 0; chan < numTxChans; chan++)
-    {
-        ss << probeChannel(device, SOAPY_SDR_TX, chan);
-    }
+    for (const auto &chan : p.channels) renderChannel(out, chan);
+}
+
+/***********************************************************************
+ * Entry points
+ **********************************************************************/
+std::string sensorReadings(SoapySDR::Device *device)
+{
+    std::string out;
+    appendSensors(out, collectSensors(device, device->listSensors()));
+    return out;
+}
+
+std::string SoapySDRDeviceProbe(SoapySDR::Device *device, const size_t numThreads)
+{
+    DeviceProbe probe;
+    collectDevice(device, probe, numThreads);
 
-    return ss.str();
+    std::string out;
+    out.reserve(PROBE_RESERVE);
+    renderDevice(out, probe);
+    return out;
 }
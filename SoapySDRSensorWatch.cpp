@@ -0,0 +1,319 @@
+// Copyright (c) 2026 SoapySDR contributors
+// SPDX-License-Identifier: BSL-1.0
+
+#include <SoapySDR/Device.hpp>
+#include "SoapyRateStats.hpp"
+#include <string>
+#include <vector>
+#include <memory>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <algorithm>
+#include <stdexcept>
+#include <iostream>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+static std::atomic<bool> watchDone(false);
+static void sigIntHandler(const int)
+{
+    watchDone = true;
+}
+
+static const double RING_SECONDS = 10.0; //readings held for a slow output
+static const size_t MIN_RING_ROWS = 64;
+static const size_t MAX_RING_ROWS = 1 << 16;
+static const size_t VALUE_CHARS = 32; //longer readings are truncated
+
+/***********************************************************************
+ * Sensors and their readings
+ **********************************************************************/
+struct WatchedSensor
+{
+    int dir; //-1 for a global sensor
+    size_t chan;
+    std::string key;
+    std::string column; //key, prefixed with the channel for channel sensors
+    std::string units;
+};
+
+//one ring cell, fixed size so the ring is allocated once up front
+struct SensorReading
+{
+    uint64_t tick; //the poll tick which wrote the cell
+    char value[VALUE_CHARS];
+};
+
+//a group of sensors read one after another by one thread, the groups run concurrently
+struct SensorPoller
+{
+    std::vector<size_t> sensors;
+    std::thread thread;
+    uint64_t missedTicks = 0; //ticks passed while the previous reads were still running
+    uint64_t droppedRows = 0; //ticks read while the output was a full ring behind
+    uint64_t failedReads = 0; //readSensor threw, the cell holds "error"
+    LatencyHistogram readTime; //one pass over the group
+    alignas(64) std::atomic<uint64_t> progress{0}; //every tick before this one is done
+};
+
+static std::vector<WatchedSensor> listWatchedSensors(SoapySDR::Device *device)
+{
+    std::vector<WatchedSensor> sensors;
+    for (const auto &key : device->listSensors())
+    {
+        sensors.push_back(WatchedSensor{-1, 0, key, key, device->getSensorInfo(key).units});
+    }
+    for (const int dir : {SOAPY_SDR_RX, SOAPY_SDR_TX})
+    {
+        for (size_t chan = 0; chan < device->getNumChannels(dir); chan++)
+        {
+            const std::string prefix = std::string((dir == SOAPY_SDR_TX)?"TX":"RX") + std::to_string(chan) + ":";
+            for (const auto &key : device->listSensors(dir, chan))
+            {
+                sensors.push_back(WatchedSensor{dir, chan, key, prefix + key, device->getSensorInfo(dir, chan, key).units});
+            }
+        }
+    }
+    return sensors;
+}
+
+/***********************************************************************
+ * Poll every sensor group on its own thread into the ring
+ **********************************************************************/
+class SensorWatch
+{
+public:
+    SensorWatch(SoapySDR::Device *device, const double rate):
+        _device(device),
+        _sensors(listWatchedSensors(device)),
+        _periodNs(int64_t(1e9/rate)),
+        _numRows(std::min(MAX_RING_ROWS, std::max(MIN_RING_ROWS, size_t(rate*RING_SECONDS)))),
+        _ring(_numRows*_sensors.size()),
+        _printed(0),
+        _stop(false)
+    {
+        for (auto &cell : _ring) cell.tick = ~uint64_t(0);
+
+        //global sensors form one group, every channel another
+        for (size_t i = 0; i < _sensors.size(); i++)
+        {
+            if (i == 0 or _sensors[i].dir != _sensors[i-1].dir or _sensors[i].chan != _sensors[i-1].chan)
+            {
+                _pollers.emplace_back(new SensorPoller());
+            }
+            _pollers.back()->sensors.push_back(i);
+        }
+        _startNs = steadyNs();
+        for (auto &poller : _pollers)
+        {
+            poller->thread = std::thread(&SensorWatch::pollLoop, this, std::ref(*poller));
+        }
+    }
+
+    ~SensorWatch(void)
+    {
+        this->stop();
+    }
+
+    void stop(void)
+    {
+        _stop = true;
+        for (auto &poller : _pollers)
+        {
+            if (poller->thread.joinable()) poller->thread.join();
+        }
+    }
+
+    const std::vector<WatchedSensor> &sensors(void) const
+    {
+        return _sensors;
+    }
+
+    const std::vector<std::unique_ptr<SensorPoller>> &pollers(void) const
+    {
+        return _pollers;
+    }
+
+    //! Ticks every group has finished, rows before this can be printed
+    uint64_t completed(void) const
+    {
+        uint64_t result = ~uint64_t(0);
+        for (const auto &poller : _pollers) result = std::min(result, poller->progress.load(std::memory_order_acquire));
+        return _pollers.empty()?0:result;
+    }
+
+    //! A reading of a completed tick, nullptr when its group skipped or dropped the tick
+    const char *value(const uint64_t tick, const size_t sensor) const
+    {
+        const auto &cell = _ring[(tick%_numRows)*_sensors.size() + sensor];
+        return (cell.tick == tick)?cell.value:nullptr;
+    }
+
+    //! Hand every row before tick back to the pollers
+    void release(const uint64_t tick)
+    {
+        _printed.store(tick, std::memory_order_release);
+    }
+
+    double tickTime(const uint64_t tick) const
+    {
+        return tick*_periodNs/1e9;
+    }
+
+    size_t numRows(void) const
+    {
+        return _numRows;
+    }
+
+private:
+    void pollLoop(SensorPoller &poller)
+    {
+        uint64_t tick(0);
+        while (not _stop)
+        {
+            const int64_t dueNs = _startNs + int64_t(tick)*_periodNs;
+            std::this_thread::sleep_until(std::chrono::steady_clock::time_point(std::chrono::nanoseconds(dueNs)));
+
+            //the output fell a full ring behind, keep the timing and drop the row instead of overwriting
+            const bool store = tick < _printed.load(std::memory_order_acquire) + _numRows;
+            if (not store) poller.droppedRows++;
+            const int64_t t0 = steadyNs();
+            for (const auto i : poller.sensors)
+            {
+                const auto &sensor = _sensors[i];
+                //a driver error on one sensor must not end the thread, it shows up in the cell
+                std::string reading;
+                try
+                {
+                    reading = (sensor.dir < 0)?_device->readSensor(sensor.key):_device->readSensor(sensor.dir, sensor.chan, sensor.key);
+                }
+                catch (const std::exception &)
+                {
+                    poller.failedReads++;
+                    reading = "error";
+                }
+                if (not store) continue;
+                auto &cell = _ring[(tick%_numRows)*_sensors.size() + i];
+                const size_t len = std::min(reading.size(), VALUE_CHARS - 1);
+                std::memcpy(cell.value, reading.data(), len);
+                cell.value[len] = '\0';
+                cell.tick = tick;
+            }
+            const int64_t t1 = steadyNs();
+            poller.readTime.record(uint64_t(t1 - t0));
+
+            //a group slower than the rate skips to the current tick
+            uint64_t next = tick + 1;
+            const uint64_t now = uint64_t((t1 - _startNs)/_periodNs);
+            if (now > next)
+            {
+                poller.missedTicks += now - next;
+                next = now;
+            }
+            tick = next;
+            poller.progress.store(tick, std::memory_order_release);
+        }
+    }
+
+    SoapySDR::Device *_device;
+    const std::vector<WatchedSensor> _sensors;
+    const int64_t _periodNs;
+    const size_t _numRows;
+    std::vector<SensorReading> _ring;
+    std::vector<std::unique_ptr<SensorPoller>> _pollers;
+    int64_t _startNs;
+    alignas(64) std::atomic<uint64_t> _printed;
+    std::atomic<bool> _stop;
+};
+
+/***********************************************************************
+ * Output: one CSV row per tick, or only the readings which changed
+ **********************************************************************/
+static void printWatchRows(SensorWatch &watch, const bool csv, uint64_t &printed, std::vector<std::string> &last)
+{
+    const auto &sensors = watch.sensors();
+    const uint64_t completed = watch.completed();
+    std::string line;
+    for (; printed < completed; printed++)
+    {
+        line.clear();
+        char stamp[32];
+        std::snprintf(stamp, sizeof(stamp), csv?"%.3f":"%10.3f s", watch.tickTime(printed));
+        line += stamp;
+        bool changed(false);
+        for (size_t i = 0; i < sensors.size(); i++)
+        {
+            const char *value = watch.value(printed, i);
+            if (csv)
+            {
+                line += ",";
+                if (value != nullptr) line += value;
+                continue;
+            }
+            if (value == nullptr or last[i] == value) continue;
+            last[i] = value;
+            line += "  " + sensors[i].column + "=" + value;
+            changed = true;
+        }
+        if (csv or changed) std::cout << line << "\n";
+    }
+    watch.release(printed);
+    std::cout << std::flush;
+}
+
+int SoapySDRSensorWatch(SoapySDR::Device *device, const double rate, const std::string &outputFormat)
+{
+    if (not outputFormat.empty() and outputFormat != "csv") throw std::runtime_error("sensor watch output is csv or the default deltas, not " + outputFormat);
+    const bool csv = not outputFormat.empty();
+
+    watchDone = false;
+    signal(SIGINT, sigIntHandler);
+    SensorWatch watch(device, rate);
+    const auto &sensors = watch.sensors();
+    if (sensors.empty())
+    {
+        std::cerr << "No sensors to watch" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    if (csv)
+    {
+        std::cout << "time";
+        for (const auto &sensor : sensors) std::cout << "," << sensor.column;
+        std::cout << std::endl;
+    }
+    else
+    {
+        std::cerr << "Watching " << sensors.size() << " sensors on " << watch.pollers().size() << " threads at "
+            << rate << " Hz, changes only, press Ctrl+C to exit..." << std::endl;
+    }
+
+    uint64_t printed(0);
+    std::vector<std::string> last(sensors.size());
+    const auto outputPeriod = std::chrono::milliseconds(std::max(10, int(1e3/rate)));
+    while (not watchDone)
+    {
+        std::this_thread::sleep_for(outputPeriod);
+        printWatchRows(watch, csv, printed, last);
+    }
+    watch.stop();
+    printWatchRows(watch, csv, printed, last);
+
+    //statistics go to stderr so the CSV stays clean
+    std::cerr << std::endl << "Sensor groups:" << std::endl;
+    for (const auto &poller : watch.pollers())
+    {
+        const auto &first = sensors[poller->sensors.front()];
+        const auto &h = poller->readTime;
+        char line[256];
+        std::snprintf(line, sizeof(line), "  %-8s %3zu sensors, %llu polls, read ms mean %.3f p99 %.3f max %.3f, missed %llu ticks, dropped %llu rows, failed reads %llu",
+            (first.dir < 0)?"global":first.column.substr(0, first.column.find(':')).c_str(), poller->sensors.size(),
+            (unsigned long long)h.count(), h.mean()/1e6, h.percentile(99)/1e6, h.max()/1e6,
+            (unsigned long long)poller->missedTicks, (unsigned long long)poller->droppedRows, (unsigned long long)poller->failedReads);
+        std::cerr << line << std::endl;
+    }
+    return EXIT_SUCCESS;
+}
@@ -6,15 +6,22 @@
 #include <SoapySDR/Registry.hpp>
 #include <SoapySDR/Device.hpp>
 #include <SoapySDR/ConverterRegistry.hpp>
+#include <SoapySDR/Logger.hpp>
+#include "SoapyRateTest.hpp"
 #include <algorithm> //sort, min, max
 #include <cstdlib>
 #include <cstddef>
+#include <cstdio>
 #include <iostream>
 #include <iomanip>
 #include <csignal>
 #include <chrono>
 #include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <memory>
 #include <getopt.h>
+#include <unistd.h>
 #include <sys/types.h>
 #include <sys/stat.h>
 
@@ -24,17 +31,13 @@ static void sigIntHandler(const int)
     loopDone = true;
 }
 
-std::string SoapySDRDeviceProbe(SoapySDR::Device *);
+std::string SoapySDRDeviceProbe(SoapySDR::Device *, const size_t numThreads);
 std::string sensorReadings(SoapySDR::Device *);
-int SoapySDRRateTest(
-    const std::string &argStr,
-    const double frequency,
-    const double bandwidth,
-    const double sampleRate,
-    const double rxGain,
-    const double txGain,
-    const std::string &formatStr,
-    const std::string &channelStr);
+int SoapySDRConverterBench(const size_t numThreads);
+int SoapySDRModuleProfile(void);
+int SoapySDRLifecycleBench(const SoapySDRRateTestArgs &args, const size_t iterations);
+int SoapySDRNetReceive(const std::string &bind, const double duration);
+int SoapySDRSensorWatch(SoapySDR::Device *device, const double rate, const std::string &outputFormat);
 
 /***********************************************************************
  * Print the banner
@@ -59,22 +62,66 @@ static int printHelp(void)
     std::cout << "    --find[=\"driver=foo,type=bar\"] \t Discover available devices" << std::endl;
     std::cout << "    --make[=\"driver=foo,type=bar\"] \t Create a device instance" << std::endl;
     std::cout << "    --probe[=\"driver=foo,type=bar\"] \t Print detailed information" << std::endl;
+    std::cout << "    --probeThreads[=N]   \t\t Query --probe channels on N threads, one per channel without N" << std::endl;
     std::cout << "    --watch[=\"driver=foo,type=bar\"] \t Watch device sensor information" << std::endl;
+    std::cout << "    --watchRate[=Hz]     \t\t Poll all sensors for --watch at this rate, --output=csv for CSV" << std::endl;
     std::cout << std::endl;
 
     std::cout << "  Advanced options:" << std::endl;
     std::cout << "    --check[=driverName] \t\t Check if driver is present" << std::endl;
     std::cout << "    --sparse             \t\t Simplified output for --find" << std::endl;
+    std::cout << "    --findTimeout[=seconds] \t\t Query drivers for --find in parallel, default 5 s each" << std::endl;
+    std::cout << "    --benchConverters[=threads] \t Benchmark every registered converter" << std::endl;
+    std::cout << "    --profileModules     \t\t Time each module load and a parallel preload" << std::endl;
     std::cout << "    --serial=ABCD123456  \t\t Specify device serial number" << std::endl;
     std::cout << std::endl;
 
     std::cout << "  Rate testing options:" << std::endl;
-    std::cout << "    --args[=\"driver=foo\"] \t\t Arguments for testing" << std::endl;
+    std::cout << "    --args[=\"driver=foo\"] \t\t Arguments for testing, repeat for several devices" << std::endl;
+    std::cout << "    --all                \t\t Test every device matching each --args" << std::endl;
     std::cout << "    --frequency[=frequency] \t\t Frequency in Hz" << std::endl;
     std::cout << "    --bandwidth[=bandwidth] \t\t Bandwidth in Hz" << std::endl;
     std::cout << "    --rate[=stream rate Sps] \t\t Rate in samples per second" << std::endl;
     std::cout << "    --format[=CS16|CS8|...] \t\t Sample format, default native" << std::endl;
     std::cout << "    --channels[=\"0, 1, 2\"] \t\t List of channels, default 0" << std::endl;
+    std::cout << "    --tone[=frequency] \t\t TX tone offset in Hz, default rate/16" << std::endl;
+    std::cout << "    --direct             \t\t Compare copy and direct buffer access" << std::endl;
+    std::cout << "    --hugepages          \t\t Back stream buffers with huge pages" << std::endl;
+    std::cout << "    --rxCpus[=\"2, 3\"]   \t\t Pin RX stream threads to these cores" << std::endl;
+    std::cout << "    --txCpus[=\"4, 5\"]   \t\t Pin TX stream threads to these cores" << std::endl;
+    std::cout << "    --priority[=1-99]    \t\t SCHED_FIFO priority for stream threads" << std::endl;
+    std::cout << "    --coroutines[=N]     \t\t Multiplex all streams on N polling threads, default 1" << std::endl;
+    std::cout << "    --allocCheck         \t\t Fail on heap allocations in the steady state loops" << std::endl;
+    std::cout << "    --profile            \t\t Cycles per phase of the stream and stage loops, with perf counters" << std::endl;
+    std::cout << "    --numaNode[=node]    \t\t Bind stream buffers to a NUMA node" << std::endl;
+    std::cout << "    --capture[=file]     \t\t Record RX samples to a file" << std::endl;
+    std::cout << "    --verify[=tone|prbs] \t\t Check RX against TX in a loopback setup" << std::endl;
+    std::cout << "    --convertThreads[=N] \t\t Convert RX from the native format on host threads" << std::endl;
+    std::cout << "    --dsp[=fft,fir,power]\t\t Run DSP kernels on RX and find the highest sustained load" << std::endl;
+    std::cout << "    --dspThreads[=N]     \t\t Work-stealing threads for the DSP kernels, default all cores" << std::endl;
+    std::cout << "    --replay[=file]      \t\t Transmit a recorded sample file" << std::endl;
+    std::cout << "    --replayLoops[=count]\t\t Stop after replaying the file this many times" << std::endl;
+    std::cout << "    --timedBurst[=leadUs]\t\t Send timed TX bursts and search for the minimum lead" << std::endl;
+    std::cout << "    --relay[=leadUs]     \t\t Transmit the received samples, one lead after their RX time" << std::endl;
+    std::cout << "    --netSink=host:port  \t\t Forward RX over UDP to a peer in net source mode" << std::endl;
+    std::cout << "    --netPayload[=bytes] \t\t Sample bytes per datagram of the net sink, default 1400" << std::endl;
+    std::cout << "    --netSource[=[host:]port]\t Receive a net sink and report loss and latency, default port 5700" << std::endl;
+    std::cout << "    --elems[=count]      \t\t Elements per stream call, default MTU" << std::endl;
+    std::cout << "    --streamArgs[=args]  \t\t Stream arguments for setupStream" << std::endl;
+    std::cout << "    --sweep[=elems list] \t\t Sweep transfer sizes in short trials" << std::endl;
+    std::cout << "    --sweepArgs[=a; b]   \t\t Stream argument sets for the sweep" << std::endl;
+    std::cout << "    --results[=file]     \t\t Append the run with host and device details to a results store" << std::endl;
+    std::cout << "    --compare[=runs]     \t\t Test the run against the latest stored runs, default 10" << std::endl;
+    std::cout << "    --sweepTime[=seconds]\t\t Length of each sweep and matrix trial" << std::endl;
+    std::cout << "    --search[=rx|tx|duplex]\t\t Bisect for the highest clean sample rate, default duplex" << std::endl;
+    std::cout << "    --soak[=seconds]     \t\t Clean time each search trial needs, default 5" << std::endl;
+    std::cout << "    --matrix[=events/s]  \t\t Map the sustained rate over the probed rates, formats and channels" << std::endl;
+    std::cout << "    --duration[=seconds] \t\t Stop the rate test after this long" << std::endl;
+    std::cout << "    --samples[=count]    \t\t Stop each stream after this many samples" << std::endl;
+    std::cout << "    --warmup[=seconds]   \t\t Exclude the start of each stream from results" << std::endl;
+    std::cout << "    --output[=json|csv]  \t\t Print structured records on stdout" << std::endl;
+    std::cout << "    --target[=Msps]      \t\t Fail below this rate, 99% of the rate without a value" << std::endl;
+    std::cout << "    --benchLifecycle[=N] \t\t Time make, configure, stream start and close N times" << std::endl;
     std::cout << std::endl;
     return EXIT_SUCCESS;
 }
@@ -181,6 +228,167 @@ static int findDevices(const std::string &argStr, const bool sparse)
     return results.empty()?EXIT_FAILURE:EXIT_SUCCESS;
 }
 
+/***********************************************************************
+ * Find devices with every driver queried concurrently
+ **********************************************************************/
+struct DriverFindResult
+{
+    std::string driver;
+    SoapySDR::KwargsList results;
+    std::string error;
+    double elapsed; //seconds
+};
+
+//shared with the finder threads, which outlive the call when a driver hangs
+struct DriverFindState
+{
+    std::mutex mutex;
+    std::condition_variable cond;
+    std::vector<DriverFindResult> done;
+};
+
+static double secondsSince(const std::chrono::steady_clock::time_point &start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+static std::string formatMs(const double seconds)
+{
+    char buff[32];
+    std::snprintf(buff, sizeof(buff), "%.1f ms", seconds*1e3);
+    return buff;
+}
+
+static void printFindResult(const DriverFindResult &r, const bool sparse, size_t &numDevices)
+{
+    if (not sparse)
+    {
+        std::cout << "[" << std::setw(10) << formatMs(r.elapsed) << "] " << r.driver << ": ";
+        if (not r.error.empty()) std::cout << "error: " << r.error << std::endl;
+        else std::cout << r.results.size() << " device" << ((r.results.size() == 1)?"":"s") << std::endl;
+    }
+    for (const auto &result : r.results)
+    {
+        const auto it = result.find("label");
+        if (sparse)
+        {
+            std::cout << numDevices++ << ": " << ((it != result.end())?it->second:SoapySDR::KwargsToString(result)) << std::endl;
+            continue;
+        }
+        std::cout << "Found device " << numDevices++ << std::endl;
+        for (const auto &pair : result)
+        {
+            std::cout << "  " << pair.first << " = " << pair.second << std::endl;
+        }
+        std::cout << std::endl;
+    }
+}
+
+static int findDevicesParallel(const std::string &argStr, const bool sparse, const double timeout)
+{
+    const auto loadStart = std::chrono::steady_clock::now();
+    SoapySDR::loadModules();
+    if (not sparse) std::cout << "Loaded modules in " << formatMs(secondsSince(loadStart)) << ", each driver has "
+        << timeout << " s to respond" << std::endl;
+
+    //device enumeration looks the same as through Device::enumerate, driver filter and key included
+    const auto args = SoapySDR::KwargsFromString(argStr);
+    const auto start = std::chrono::steady_clock::now();
+    auto state = std::make_shared<DriverFindState>();
+    std::vector<std::string> drivers;
+    std::vector<std::thread> threads;
+    for (const auto &it : SoapySDR::Registry::listFindFunctions())
+    {
+        if (args.count("driver") != 0 and args.at("driver") != it.first) continue;
+        drivers.push_back(it.first);
+        threads.emplace_back([state, args, start](const std::string driver, const SoapySDR::FindFunction find)
+        {
+            DriverFindResult r;
+            r.driver = driver;
+            try
+            {
+                r.results = find(args);
+            }
+            catch (const std::exception &ex)
+            {
+                r.error = ex.what();
+            }
+            catch (...)
+            {
+                r.error = "unknown exception";
+            }
+            r.elapsed = secondsSince(start);
+            for (auto &result : r.results)
+            {
+                if (result.count("driver") == 0) result["driver"] = driver;
+            }
+            std::lock_guard<std::mutex> lock(state->mutex);
+            state->done.push_back(r);
+            state->cond.notify_one();
+        }, it.first, it.second);
+    }
+
+    //print each driver as it answers
+    const auto deadline = start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(timeout));
+    std::vector<DriverFindResult> finished;
+    size_t numDevices(0);
+    std::unique_lock<std::mutex> lock(state->mutex);
+    while (finished.size() < threads.size())
+    {
+        if (state->done.size() == finished.size())
+        {
+            state->cond.wait_until(lock, deadline);
+            if (state->done.size() == finished.size() and std::chrono::steady_clock::now() >= deadline) break;
+            continue;
+        }
+        finished.push_back(state->done[finished.size()]);
+        lock.unlock();
+        printFindResult(finished.back(), sparse, numDevices);
+        lock.lock();
+    }
+    lock.unlock();
+
+    std::vector<std::string> timedOut;
+    for (const auto &driver : drivers)
+    {
+        bool found(false);
+        for (const auto &r : finished) found = found or (r.driver == driver);
+        if (not found) timedOut.push_back(driver);
+    }
+    for (const auto &driver : timedOut)
+    {
+        std::cerr << "Driver " << driver << " did not respond within " << timeout << " s" << std::endl;
+    }
+
+    if (not sparse)
+    {
+        std::sort(finished.begin(), finished.end(), [](const DriverFindResult &a, const DriverFindResult &b)
+        {
+            return a.elapsed > b.elapsed;
+        });
+        std::cout << "Discovery time per driver, slowest first:" << std::endl;
+        for (const auto &driver : timedOut) std::cout << "  " << std::setw(20) << std::left << driver << std::right << " timed out" << std::endl;
+        for (const auto &r : finished)
+        {
+            std::cout << "  " << std::setw(20) << std::left << r.driver << std::right << " " << formatMs(r.elapsed) << std::endl;
+        }
+        std::cout << "Total " << formatMs(secondsSince(start)) << ", " << numDevices << " device"
+            << ((numDevices == 1)?"":"s") << " from " << drivers.size() << " driver" << ((drivers.size() == 1)?"":"s") << std::endl;
+    }
+    if (numDevices == 0) std::cerr << "No devices found! " << argStr << std::endl;
+    const int status = (numDevices == 0)?EXIT_FAILURE:EXIT_SUCCESS;
+
+    //a hung find call cannot be cancelled, and unloading its module under it would crash
+    if (not timedOut.empty())
+    {
+        std::cout << std::flush;
+        std::cerr << std::flush;
+        _exit(status);
+    }
+    for (auto &thread : threads) thread.join();
+    return status;
+}
+
 /***********************************************************************
  * Make device and print hardware info
  **********************************************************************/
@@ -210,13 +418,13 @@ static int makeDevice(const std::string &argStr)
 /***********************************************************************
  * Make device and print detailed info
  **********************************************************************/
-static int probeDevice(const std::string &argStr)
+static int probeDevice(const std::string &argStr, const size_t numThreads)
 {
     std::cout << "Probe device " << argStr << std::endl;
     try
     {
         auto device = SoapySDR::Device::make(argStr);
-        std::cout << SoapySDRDeviceProbe(device) << std::endl;
+        std::cout << SoapySDRDeviceProbe(device, numThreads) << std::endl;
         SoapySDR::Device::unmake(device);
     }
     catch (const std::exception &ex)
@@ -231,13 +439,31 @@ static int probeDevice(const std::string &argStr)
 /***********************************************************************
  * Make device and watch sensor info
  **********************************************************************/
-static int watchDevice(const std::string &argStr)
+static int watchDevice(const std::string &argStr, const double rate, const std::string &outputFormat)
 {
     signal(SIGINT, sigIntHandler);
 
-    std::cout << "Watch device " << argStr << ", press Ctrl+C to exit..." << std::endl;
     try
     {
+        //a rate polls every sensor into a time series instead of printing the full readings
+        if (rate > 0.0)
+        {
+            auto device = SoapySDR::Device::make(argStr);
+            int status(EXIT_FAILURE);
+            try
+            {
+                status = SoapySDRSensorWatch(device, rate, outputFormat);
+            }
+            catch (...)
+            {
+                SoapySDR::Device::unmake(device);
+                throw;
+            }
+            SoapySDR::Device::unmake(device);
+            return status;
+        }
+
+        std::cout << "Watch device " << argStr << ", press Ctrl+C to exit..." << std::endl;
         auto device = SoapySDR::Device::make(argStr);
         while (not loopDone)
         {
@@ -279,9 +505,51 @@ static int checkDriver(const std::string &driverName)
     }
 }
 
+/***********************************************************************
+ * Parse lists of command line values
+ **********************************************************************/
+//items split on delim in order, each one tidied through KwargsFromString, empty items dropped
+static std::vector<std::string> splitList(const std::string &listStr, const char delim)
+{
+    std::vector<std::string> result;
+    size_t pos(0);
+    while (pos <= listStr.size())
+    {
+        const size_t end = std::min(listStr.find(delim, pos), listStr.size());
+        const auto item = SoapySDR::KwargsToString(SoapySDR::KwargsFromString(listStr.substr(pos, end - pos)));
+        if (not item.empty()) result.push_back(item);
+        pos = end + 1;
+    }
+    return result;
+}
+
+//a list like "2, 10, 3" in the given order, duplicates are kept since cores repeat on purpose
+static std::vector<int> parseIntList(const std::string &listStr)
+{
+    std::vector<int> result;
+    size_t pos(0);
+    while (pos < listStr.size())
+    {
+        const size_t end = std::min(listStr.find(',', pos), listStr.size());
+        const auto item = listStr.substr(pos, end - pos);
+        if (item.find_first_not_of(" \t") != std::string::npos) result.push_back(std::stoi(item));
+        pos = end + 1;
+    }
+    return result;
+}
+
 /***********************************************************************
  * main utility entry point
  **********************************************************************/
+
+//codes of the long options past the letters, every letter already names an option
+enum
+{
+    OPT_BENCH_CONVERTERS = 256,
+    OPT_PROFILE_MODULES,
+    OPT_BENCH_LIFECYCLE,
+};
+
 int main(int argc, char *argv[])
 {
     //unload any loaded modules when main() scope unwinds
@@ -289,19 +557,21 @@ int main(int argc, char *argv[])
 
     std::string serial;
     std::string argStr;
-    std::string formatStr;
-    std::string chanStr;
-    double frequency(0.0);
-    double bandwidth(0.0);
-    double sampleRate(0.0);
-    double txGain(-30.0);
-    double rxGain(40.0);
+    SoapySDRRateTestArgs rateArgs;
     std::string driverName;
     bool findDevicesFlag(false);
     bool sparsePrintFlag(false);
+    double findTimeout(0.0); //0 finds through Device::enumerate
     bool makeDeviceFlag(false);
     bool probeDeviceFlag(false);
+    size_t probeThreads(1);
     bool watchDeviceFlag(false);
+    double watchRate(0.0);
+    bool benchConvertersFlag(false);
+    size_t benchThreads(0);
+    bool profileModulesFlag(false);
+    size_t lifecycleIterations(0);
+    std::string netSource;
 
     /*******************************************************************
      * parse command line options
@@ -312,10 +582,15 @@ int main(int argc, char *argv[])
         {"make", optional_argument, nullptr, 'm'},
         {"info", optional_argument, nullptr, 'i'},
         {"probe", optional_argument, nullptr, 'p'},
+        {"probeThreads", optional_argument, nullptr, 'e'},
         {"watch", optional_argument, nullptr, 'w'},
+        {"watchRate", optional_argument, nullptr, 'u'},
 
         {"check", optional_argument, nullptr, 'c'},
+        {"benchConverters", optional_argument, nullptr, OPT_BENCH_CONVERTERS},
+        {"profileModules", no_argument, nullptr, OPT_PROFILE_MODULES},
         {"sparse", no_argument, nullptr, 's'},
+        {"findTimeout", optional_argument, nullptr, 'F'},
         {"serial", required_argument, nullptr, 'S'},
 
         {"args", optional_argument, nullptr, 'a'},
@@ -326,6 +601,45 @@ int main(int argc, char *argv[])
         {"channels", optional_argument, nullptr, 'n'},
         {"txGain", optional_argument, nullptr, 'y'},
         {"rxGain", optional_argument, nullptr, 'z'},
+        {"direct", no_argument, nullptr, 'd'},
+        {"tone", optional_argument, nullptr, 'o'},
+        {"hugepages", no_argument, nullptr, 'H'},
+        {"all", no_argument, nullptr, 'A'},
+        {"rxCpus", optional_argument, nullptr, 'R'},
+        {"txCpus", optional_argument, nullptr, 'T'},
+        {"priority", optional_argument, nullptr, 'P'},
+        {"coroutines", optional_argument, nullptr, 'g'},
+        {"allocCheck", no_argument, nullptr, 'Z'},
+        {"profile", no_argument, nullptr, '0'},
+        {"numaNode", optional_argument, nullptr, 'N'},
+        {"capture", optional_argument, nullptr, 'C'},
+        {"verify", optional_argument, nullptr, 'V'},
+        {"convertThreads", optional_argument, nullptr, 'k'},
+        {"dsp", optional_argument, nullptr, 'v'},
+        {"dspThreads", optional_argument, nullptr, 'J'},
+        {"replay", optional_argument, nullptr, 'X'},
+        {"replayLoops", optional_argument, nullptr, 'L'},
+        {"timedBurst", optional_argument, nullptr, 'B'},
+        {"relay", optional_argument, nullptr, 'x'},
+        {"netSink", required_argument, nullptr, '4'},
+        {"netPayload", optional_argument, nullptr, '5'},
+        {"netSource", optional_argument, nullptr, '6'},
+        {"elems", optional_argument, nullptr, 'E'},
+        {"streamArgs", optional_argument, nullptr, 'K'},
+        {"sweep", optional_argument, nullptr, 'W'},
+        {"sweepArgs", optional_argument, nullptr, 'G'},
+        {"sweepTime", optional_argument, nullptr, 'I'},
+        {"matrix", optional_argument, nullptr, '1'},
+        {"results", optional_argument, nullptr, '2'},
+        {"compare", optional_argument, nullptr, '3'},
+        {"search", optional_argument, nullptr, '7'},
+        {"soak", optional_argument, nullptr, '8'},
+        {"duration", optional_argument, nullptr, 'D'},
+        {"samples", optional_argument, nullptr, 'M'},
+        {"warmup", optional_argument, nullptr, 'U'},
+        {"output", optional_argument, nullptr, 'O'},
+        {"target", optional_argument, nullptr, 'Q'},
+        {"benchLifecycle", optional_argument, nullptr, OPT_BENCH_LIFECYCLE},
         {nullptr, no_argument, nullptr, '\0'}
     };
     int long_index = 0;
@@ -352,6 +666,17 @@ int main(int argc, char *argv[])
             probeDeviceFlag = true;
             if (optarg != nullptr) argStr = optarg;
             break;
+        case 'u':
+            watchRate = (optarg != nullptr)?std::stod(optarg):10.0;
+            if (watchRate <= 0.0)
+            {
+                std::cerr << "--watchRate must be positive, got " << watchRate << std::endl;
+                return EXIT_FAILURE;
+            }
+            break;
+        case 'e':
+            probeThreads = (optarg != nullptr)?std::stoul(optarg):0;
+            break;
         case 'w':
             watchDeviceFlag = true;
             if (optarg != nullptr) argStr = optarg;
@@ -359,35 +684,178 @@ int main(int argc, char *argv[])
         case 'c':
             if (optarg != nullptr) driverName = optarg;
             break;
+        case OPT_BENCH_CONVERTERS:
+            benchConvertersFlag = true;
+            if (optarg != nullptr) benchThreads = std::stoul(optarg);
+            break;
+        case OPT_BENCH_LIFECYCLE:
+            lifecycleIterations = (optarg != nullptr)?std::stoul(optarg):20;
+            break;
+        case OPT_PROFILE_MODULES:
+            profileModulesFlag = true;
+            break;
         case 's':
             sparsePrintFlag = true;
             break;
+        case 'F':
+            findTimeout = (optarg != nullptr)?std::stod(optarg):5.0;
+            break;
         case 'S':
             serial = optarg;
             break;
         case 'a':
             if (optarg != nullptr) argStr = optarg;
+            rateArgs.deviceArgs.push_back(argStr);
+            break;
+        case 'A':
+            rateArgs.enumerateAll = true;
             break;
         case 'q':
-            if (optarg != nullptr) frequency = std::stod(optarg);
+            if (optarg != nullptr) rateArgs.frequency = std::stod(optarg);
             break;
         case 'b':
-            if (optarg != nullptr) bandwidth = std::stod(optarg);
+            if (optarg != nullptr) rateArgs.bandwidth = std::stod(optarg);
             break;
         case 'r':
-            if (optarg != nullptr) sampleRate = std::stod(optarg);
+            if (optarg != nullptr) rateArgs.sampleRate = std::stod(optarg);
             break;
         case 'y':
-            if (optarg != nullptr) txGain = std::stod(optarg);
+            if (optarg != nullptr) rateArgs.txGain = std::stod(optarg);
             break;
         case 'z':
-            if (optarg != nullptr) rxGain = std::stod(optarg);
+            if (optarg == nullptr) break;
+            rateArgs.rxGain = std::stod(optarg);
+            rateArgs.rxGainGiven = true;
             break;
         case 't':
-            if (optarg != nullptr) formatStr = optarg;
+            if (optarg != nullptr) rateArgs.formatStr = optarg;
             break;
         case 'n':
-            if (optarg != nullptr) chanStr = optarg;
+            if (optarg != nullptr) rateArgs.channelStr = optarg;
+            break;
+        case 'd':
+            rateArgs.directAccess = true;
+            break;
+        case 'o':
+            if (optarg != nullptr) rateArgs.toneFreq = std::stod(optarg);
+            break;
+        case 'H':
+            rateArgs.hugePages = true;
+            break;
+        case 'R':
+            if (optarg != nullptr) rateArgs.rxCpus = parseIntList(optarg);
+            break;
+        case 'T':
+            if (optarg != nullptr) rateArgs.txCpus = parseIntList(optarg);
+            break;
+        case 'P':
+            if (optarg != nullptr) rateArgs.priority = std::stoi(optarg);
+            break;
+        case 'N':
+            if (optarg != nullptr) rateArgs.numaNode = std::stoi(optarg);
+            break;
+        case 'C':
+            if (optarg != nullptr) rateArgs.capturePath = optarg;
+            break;
+        case 'V':
+            rateArgs.verifyPattern = (optarg != nullptr)?optarg:"tone";
+            break;
+        case 'Z':
+            rateArgs.allocCheck = true;
+            break;
+        case '0':
+            rateArgs.profile = true;
+            break;
+        case 'g':
+            rateArgs.engineThreads = (optarg != nullptr)?std::stoul(optarg):1;
+            break;
+        case 'k':
+            rateArgs.convertThreads = (optarg != nullptr)?std::stoul(optarg):std::max(1u, std::thread::hardware_concurrency());
+            break;
+        case 'v':
+            rateArgs.dspKernels = (optarg != nullptr)?optarg:"fft,fir,power";
+            break;
+        case 'J':
+            if (optarg != nullptr) rateArgs.dspThreads = std::stoul(optarg);
+            break;
+        case 'X':
+            if (optarg != nullptr) rateArgs.replayPath = optarg;
+            break;
+        case 'L':
+            if (optarg != nullptr) rateArgs.replayLoops = std::stoull(optarg);
+            break;
+        case 'x':
+            rateArgs.relay = true;
+            if (optarg != nullptr) rateArgs.relayLead = std::stod(optarg)/1e6;
+            break;
+        case 'B':
+            rateArgs.timedBurst = true;
+            if (optarg != nullptr) rateArgs.burstLead = std::stod(optarg)/1e6;
+            break;
+        case 'E':
+            if (optarg != nullptr) rateArgs.numElems = std::stoul(optarg);
+            break;
+        case 'K':
+            if (optarg != nullptr) rateArgs.streamArgs = optarg;
+            break;
+        case 'W':
+            rateArgs.sweep = true;
+            if (optarg != nullptr) for (const auto elems : parseIntList(optarg))
+            {
+                if (elems <= 0)
+                {
+                    std::cerr << "--sweep transfer sizes must be positive, got " << elems << std::endl;
+                    return EXIT_FAILURE;
+                }
+                rateArgs.sweepElems.push_back(size_t(elems));
+            }
+            break;
+        case 'G':
+            if (optarg != nullptr) rateArgs.sweepStreamArgs = splitList(optarg, ';');
+            break;
+        case 'I':
+            if (optarg != nullptr) rateArgs.sweepTime = std::stod(optarg);
+            break;
+        case '4':
+            rateArgs.netSink = optarg;
+            break;
+        case '5':
+            if (optarg != nullptr) rateArgs.netPayload = std::stoul(optarg);
+            break;
+        case '6':
+            netSource = (optarg != nullptr)?optarg:"5700";
+            break;
+        case '2':
+            if (optarg != nullptr) rateArgs.resultsPath = optarg;
+            break;
+        case '3':
+            rateArgs.compare = true;
+            if (optarg != nullptr) rateArgs.compareRuns = std::stoul(optarg);
+            break;
+        case '7':
+            rateArgs.search = (optarg != nullptr)?optarg:"duplex";
+            break;
+        case '8':
+            if (optarg != nullptr) rateArgs.soakTime = std::stod(optarg);
+            break;
+        case '1':
+            rateArgs.matrix = true;
+            if (optarg != nullptr) rateArgs.matrixThreshold = std::stod(optarg);
+            break;
+        case 'D':
+            if (optarg != nullptr) rateArgs.duration = std::stod(optarg);
+            break;
+        case 'M':
+            if (optarg != nullptr) rateArgs.numSamples = std::stoull(optarg);
+            break;
+        case 'U':
+            if (optarg != nullptr) rateArgs.warmup = std::stod(optarg);
+            break;
+        case 'O':
+            if (optarg != nullptr) rateArgs.outputFormat = optarg;
+            break;
+        case 'Q':
+            rateArgs.targetRate = (optarg != nullptr)?(std::stod(optarg)*1e6):-1.0;
             break;
         }
     }
@@ -402,19 +870,30 @@ int main(int argc, char *argv[])
 
     SoapySDR::setLogLevel(SoapySDR::LogLevel::SOAPY_SDR_DEBUG);
 
-    if (not sparsePrintFlag) printBanner();
+    if (not sparsePrintFlag and rateArgs.outputFormat.empty()) printBanner();
     if (not driverName.empty()) return checkDriver(driverName);
+    if (findDevicesFlag and findTimeout > 0.0) return findDevicesParallel(argStr, sparsePrintFlag, findTimeout);
     if (findDevicesFlag) return findDevices(argStr, sparsePrintFlag);
     if (makeDeviceFlag)  return makeDevice(argStr);
-    if (probeDeviceFlag) return probeDevice(argStr);
-    if (watchDeviceFlag) return watchDevice(argStr);
+    if (probeDeviceFlag) return probeDevice(argStr, probeThreads);
+    if (watchDeviceFlag) return watchDevice(argStr, watchRate, rateArgs.outputFormat);
+    if (benchConvertersFlag) return SoapySDRConverterBench(benchThreads);
+    if (profileModulesFlag) return SoapySDRModuleProfile();
+    if (not netSource.empty()) return SoapySDRNetReceive(netSource, rateArgs.duration);
 
     SoapySDR::setLogLevel(SoapySDR::LogLevel::SOAPY_SDR_DEBUG);
 
     //invoke utilities that rely on multiple arguments
-    if (sampleRate != 0.0)
+    if (lifecycleIterations != 0)
+    {
+        if (rateArgs.deviceArgs.size() <= 1) rateArgs.deviceArgs.assign(1, argStr);
+        return SoapySDRLifecycleBench(rateArgs, lifecycleIterations);
+    }
+    if (rateArgs.sampleRate != 0.0 or rateArgs.matrix or not rateArgs.search.empty())
     {
-        return SoapySDRRateTest(argStr, frequency, bandwidth, sampleRate, rxGain, txGain, formatStr, chanStr);
+        //a single device picks up the serial, several devices are listed explicitly
+        if (rateArgs.deviceArgs.size() <= 1) rateArgs.deviceArgs.assign(1, argStr);
+        return SoapySDRRateTest(rateArgs);
     }
 
     //unknown or unspecified options, do help...